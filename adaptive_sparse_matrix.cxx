@@ -0,0 +1,167 @@
+#include "adaptive_sparse_matrix.h"
+
+#include <chrono>
+#include <cstring>
+
+namespace {
+
+// SELL-C-σ 形式の並べ替えの窓の行数
+const int kAdaptiveSigma = 256;
+
+// この割合以上が非ゼロ要素であれば、埋めたゼロの分の計算を払っても SELL-C-σ / BCSR の方が速いとみなす
+const double kAdaptiveMinimumFill = 0.75;
+
+// BCSR の候補のブロックの大きさ（行数, 列数）
+const int kBcsrCandidates[][2] = {{4, 4}, {2, 4}, {4, 2}, {2, 2}, {1, 4}, {4, 1}};
+
+// 時間を測る SpMV の回数
+const int kTuneRepeats = 3;
+
+// 充填率が最も高い BCSR のブロックの大きさを返す（同じなら大きいブロックを選ぶ）
+template <class T>
+double best_bcsr_block(const BasicSparseMatrix<T>& arg, int& block_rows, int& block_cols) {
+    double best_fill = -1.0;
+    for (size_t c = 0; c < sizeof(kBcsrCandidates) / sizeof(kBcsrCandidates[0]); c++) {
+        int r = kBcsrCandidates[c][0];
+        int k = kBcsrCandidates[c][1];
+        long long blocks = BasicBcsrMatrix<T>::count_blocks(arg, r, k);
+        double fill = blocks > 0 ? (double)arg.nnz() / ((double)blocks * r * k) : 0.0;
+        if (fill > best_fill) {
+            best_fill = fill;
+            block_rows = r;
+            block_cols = k;
+        }
+    }
+    return best_fill;
+}
+
+// y = A * x を repeats 回計算する時間（秒）を測る
+template <class M, class T>
+double time_spmv(const M& matrix, const BasicVector<T>& x, BasicVector<T>& y) {
+    matrix.multiply(1.0, x, 0.0, y);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int r = 0; r < kTuneRepeats; r++) {
+        matrix.multiply(1.0, x, 0.0, y);
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+}  // namespace
+
+// CSR 形式の疎行列から形式を選んで変換するコンストラクタ
+template <class T>
+BasicAdaptiveSparseMatrix<T>::BasicAdaptiveSparseMatrix(const BasicSparseMatrix<T>& arg, const char* mode) : rows_(arg.rows()), cols_(arg.cols()) {
+    bool heuristic = strcmp(mode, "heuristic") == 0;
+    bool tune = strcmp(mode, "tune") == 0;
+    if (!heuristic && !tune && strcmp(mode, "csr") != 0 && strcmp(mode, "sell") != 0 && strcmp(mode, "bcsr") != 0) {
+        std::cerr << "AdaptiveSparseMatrix::AdaptiveSparseMatrix(const SparseMatrix &, const char *): Unknown mode " << mode << std::endl;
+        exit(1);
+    }
+    // BCSR のブロックの大きさは BCSR を作る可能性がある場合だけ求める
+    int block_rows = 1;
+    int block_cols = 1;
+    double bcsr_fill = 0.0;
+    if ((heuristic || tune || strcmp(mode, "bcsr") == 0) && arg.nnz() > 0) {
+        bcsr_fill = best_bcsr_block(arg, block_rows, block_cols);
+    }
+
+    format_ = "csr";
+    if (heuristic) {
+        // BCSR のブロックが十分に埋まるなら BCSR、そうでなく行の長さが揃っていれば SELL-C-σ
+        long long sell_stored = BasicSellMatrix<T>::stored_size(arg, kAdaptiveSigma);
+        double sell_fill = sell_stored > 0 ? (double)arg.nnz() / sell_stored : 0.0;
+        if (bcsr_fill >= kAdaptiveMinimumFill) {
+            format_ = "bcsr";
+        } else if (sell_fill >= kAdaptiveMinimumFill) {
+            format_ = "sell";
+        }
+    } else if (tune) {
+        // 候補をすべて作って SpMV の時間を比べる
+        BasicVector<T> x(cols_, 1.0, "all");
+        BasicVector<T> y(rows_);
+        BasicSellMatrix<T> sell(arg, kAdaptiveSigma);
+        BasicBcsrMatrix<T> bcsr(arg, block_rows, block_cols);
+        double csr_time = time_spmv(arg, x, y);
+        double sell_time = time_spmv(sell, x, y);
+        double bcsr_time = time_spmv(bcsr, x, y);
+        if (sell_time < csr_time && sell_time <= bcsr_time) {
+            format_ = "sell";
+        } else if (bcsr_time < csr_time && bcsr_time < sell_time) {
+            format_ = "bcsr";
+        }
+    } else {
+        format_ = mode[0] == 's' ? "sell" : mode[0] == 'b' ? "bcsr" : "csr";
+    }
+
+    if (strcmp(format_, "sell") == 0) {
+        sell_.reset(new BasicSellMatrix<T>(arg, kAdaptiveSigma));
+    } else if (strcmp(format_, "bcsr") == 0) {
+        bcsr_.reset(new BasicBcsrMatrix<T>(arg, block_rows, block_cols));
+    } else {
+        csr_ = arg;
+    }
+}
+
+// 選んだ形式を返す
+template <class T>
+const char* BasicAdaptiveSparseMatrix<T>::format(void) const { return format_; }
+
+// 行数を返す
+template <class T>
+int BasicAdaptiveSparseMatrix<T>::rows(void) const { return rows_; }
+
+// 列数を返す
+template <class T>
+int BasicAdaptiveSparseMatrix<T>::cols(void) const { return cols_; }
+
+// ベクトル（ビューを含む）との乗算演算子
+template <class T>
+BasicVector<T> BasicAdaptiveSparseMatrix<T>::operator*(const BasicVectorView<T>& arg) const {
+    BasicVector<T> result(rows_);
+    multiply(1.0, arg, 0.0, BasicVectorView<T>(result));
+    return result;
+}
+
+// 行列（ビュー、転置行列を含む）との乗算演算子
+template <class T>
+BasicMatrix<T> BasicAdaptiveSparseMatrix<T>::operator*(const BasicMatrixView<T>& arg) const {
+    BasicMatrix<T> result(rows_, arg.cols());
+    multiply(1.0, arg, 0.0, BasicMatrixView<T>(result));
+    return result;
+}
+
+// y = alpha * A * x + beta * y
+template <class T>
+void BasicAdaptiveSparseMatrix<T>::multiply(double alpha, const BasicVectorView<T>& x, double beta, const BasicVectorView<T>& y) const {
+    if (sell_) {
+        sell_->multiply(alpha, x, beta, y);
+    } else if (bcsr_) {
+        bcsr_->multiply(alpha, x, beta, y);
+    } else {
+        csr_.multiply(alpha, x, beta, y);
+    }
+}
+
+// C = alpha * A * B + beta * C
+template <class T>
+void BasicAdaptiveSparseMatrix<T>::multiply(double alpha, const BasicMatrixView<T>& B, double beta, const BasicMatrixView<T>& C) const {
+    if (sell_) {
+        sell_->multiply(alpha, B, beta, C);
+    } else if (bcsr_) {
+        bcsr_->multiply(alpha, B, beta, C);
+    } else {
+        csr_.multiply(alpha, B, beta, C);
+    }
+}
+
+// y = alpha * A * x + beta * y を計算する関数
+void spmv(double alpha, const AdaptiveSparseMatrix& A, const VectorView& x, double beta, const VectorView& y) { A.multiply(alpha, x, beta, y); }
+void spmv(double alpha, const FloatAdaptiveSparseMatrix& A, const FloatVectorView& x, double beta, const FloatVectorView& y) { A.multiply(alpha, x, beta, y); }
+
+// C = alpha * A * B + beta * C を計算する関数
+void spmm(double alpha, const AdaptiveSparseMatrix& A, const MatrixView& B, double beta, const MatrixView& C) { A.multiply(alpha, B, beta, C); }
+void spmm(double alpha, const FloatAdaptiveSparseMatrix& A, const FloatMatrixView& B, double beta, const FloatMatrixView& C) { A.multiply(alpha, B, beta, C); }
+
+// 倍精度と単精度で実体化する
+template class BasicAdaptiveSparseMatrix<double>;
+template class BasicAdaptiveSparseMatrix<float>;
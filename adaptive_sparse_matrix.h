@@ -0,0 +1,46 @@
+#include <memory>  // スマートポインタの標準ライブラリ
+
+#include "bcsr_matrix.h"
+#include "sell_matrix.h"
+#include "sparse_matrix.h"
+
+#ifndef __ADAPTIVE_SPARSE_MATRIX__
+#define __ADAPTIVE_SPARSE_MATRIX__
+
+// CSR、SELL-C-σ、BCSR のうち行列に合った形式を選んで保持する疎行列
+// mode が "heuristic" の場合は行の長さの揃い方（SELL の埋めたゼロの割合）とブロックの埋まり方（BCSR の充填率）から選び、
+// "tune" の場合は候補の形式をすべて作って SpMV の時間を測り、最も速い形式を残す
+// "csr", "sell", "bcsr" を指定するとその形式に固定する（"bcsr" は最も充填率の高いブロックの大きさを使う）
+template <class T>
+class BasicAdaptiveSparseMatrix {
+   private:
+    const char* format_;                           // 選んだ形式（"csr", "sell", "bcsr"）
+    BasicSparseMatrix<T> csr_;                     // CSR 形式を選んだ場合の行列
+    std::unique_ptr<BasicSellMatrix<T> > sell_;    // SELL-C-σ 形式を選んだ場合の行列
+    std::unique_ptr<BasicBcsrMatrix<T> > bcsr_;    // BCSR 形式を選んだ場合の行列
+    int rows_;                                     // 行数
+    int cols_;                                     // 列数
+
+   public:
+    explicit BasicAdaptiveSparseMatrix(const BasicSparseMatrix<T>& arg, const char* mode = "heuristic"); // CSR 形式の疎行列から形式を選んで変換するコンストラクタ
+    const char* format(void) const;                // 選んだ形式を返す
+    int rows(void) const;                          // 行数を返す
+    int cols(void) const;                          // 列数を返す
+    BasicVector<T> operator*(const BasicVectorView<T>& arg) const; // ベクトル（ビューを含む）との乗算演算子
+    BasicMatrix<T> operator*(const BasicMatrixView<T>& arg) const; // 行列（ビュー、転置行列を含む）との乗算演算子
+    void multiply(double alpha, const BasicVectorView<T>& x, double beta, const BasicVectorView<T>& y) const; // y = alpha * A * x + beta * y
+    void multiply(double alpha, const BasicMatrixView<T>& B, double beta, const BasicMatrixView<T>& C) const; // C = alpha * A * B + beta * C
+};
+
+typedef BasicAdaptiveSparseMatrix<double> AdaptiveSparseMatrix;
+typedef BasicAdaptiveSparseMatrix<float> FloatAdaptiveSparseMatrix;
+
+// y = alpha * A * x + beta * y を計算する関数（x と y は重ならないこと）
+void spmv(double alpha, const AdaptiveSparseMatrix& A, const VectorView& x, double beta, const VectorView& y);
+void spmv(double alpha, const FloatAdaptiveSparseMatrix& A, const FloatVectorView& x, double beta, const FloatVectorView& y);
+
+// C = alpha * A * B + beta * C を計算する関数
+void spmm(double alpha, const AdaptiveSparseMatrix& A, const MatrixView& B, double beta, const MatrixView& C);
+void spmm(double alpha, const FloatAdaptiveSparseMatrix& A, const FloatMatrixView& B, double beta, const FloatMatrixView& C);
+
+#endif // __ADAPTIVE_SPARSE_MATRIX__
@@ -0,0 +1,267 @@
+#include "bcsr_matrix.h"
+
+#include <algorithm>
+
+namespace {
+
+// ブロック行 block_row に含まれるブロックの列インデックス（ブロック単位、昇順、重複なし）を columns に返す
+void block_columns(const int* row_pointers, const int* col_indices, int rows, int block_rows, int block_cols, int block_row, std::vector<int>& columns) {
+    columns.clear();
+    int last_row = std::min(rows, (block_row + 1) * block_rows);
+    for (int i = block_row * block_rows; i < last_row; i++) {
+        for (int k = row_pointers[i]; k < row_pointers[i + 1]; k++) {
+            columns.push_back(col_indices[k] / block_cols);
+        }
+    }
+    std::sort(columns.begin(), columns.end());
+    columns.erase(std::unique(columns.begin(), columns.end()), columns.end());
+}
+
+// ブロックの大きさとして使えるかを返す
+bool supported_block(int size) { return size == 1 || size == 2 || size == 4; }
+
+// SpMV のカーネルに渡す配列
+template <class T>
+struct BcsrArrays {
+    int rows;                       // 行数
+    int block_row_count;            // ブロック行の数
+    const int* block_row_pointers;  // ブロック行ごとの先頭のブロックの位置
+    const int* block_col_indices;   // ブロックの列インデックス
+    const T* values;                // ブロックの値
+};
+
+// y = alpha * A * x + beta * y（ブロックの大きさ R x C をコンパイル時に固定する）
+// x はブロックの列数の倍数まで倍精度でゼロ埋めしたもの
+template <int R, int C, class T>
+void bcsr_spmv_kernel(const BcsrArrays<T>& A, const double* x, double alpha, double beta, const BasicVectorView<T>& y) {
+    int blocks = A.block_row_pointers[A.block_row_count];
+    int grain = std::max(1, (int)((long long)kParallelGrain * A.block_row_count / std::max(1LL, (long long)blocks * R * C)));
+    parallel_for(0, A.block_row_count, grain, [&](int begin, int end) {
+        for (int block_row = begin; block_row < end; block_row++) {
+            double sums[R] = {0.0};
+            for (int b = A.block_row_pointers[block_row]; b < A.block_row_pointers[block_row + 1]; b++) {
+                const T* block = A.values + (long long)b * R * C;
+                const double* x_block = x + (long long)A.block_col_indices[b] * C;
+                for (int r = 0; r < R; r++) {
+                    for (int c = 0; c < C; c++) {
+                        sums[r] += block[r * C + c] * x_block[c];
+                    }
+                }
+            }
+            for (int r = 0; r < R; r++) {
+                int row = block_row * R + r;
+                if (row >= A.rows) break;
+                y[row] = beta == 0.0 ? alpha * sums[r] : alpha * sums[r] + beta * y[row];
+            }
+        }
+    });
+}
+
+// ブロックの列数で展開したカーネルを選ぶ
+template <int R, class T>
+void bcsr_spmv_dispatch(int block_cols, const BcsrArrays<T>& A, const double* x, double alpha, double beta, const BasicVectorView<T>& y) {
+    switch (block_cols) {
+        case 1:
+            bcsr_spmv_kernel<R, 1>(A, x, alpha, beta, y);
+            break;
+        case 2:
+            bcsr_spmv_kernel<R, 2>(A, x, alpha, beta, y);
+            break;
+        case 4:
+            bcsr_spmv_kernel<R, 4>(A, x, alpha, beta, y);
+            break;
+    }
+}
+
+}  // namespace
+
+// CSR 形式の疎行列から変換するコンストラクタ
+// ブロック行ごとにブロックの列を数えて先頭の位置を累積し、各非ゼロ要素をブロック内の位置に書き込む（どちらもブロック行ごとに並列）
+template <class T>
+BasicBcsrMatrix<T>::BasicBcsrMatrix(const BasicSparseMatrix<T>& arg, int block_rows, int block_cols)
+    : rows_(arg.rows()), cols_(arg.cols()), nnz_(arg.nnz()), block_rows_(block_rows), block_cols_(block_cols) {
+    if (!supported_block(block_rows) || !supported_block(block_cols)) {
+        std::cerr << "BcsrMatrix::BcsrMatrix(const SparseMatrix &, int, int): Unsupported block size" << std::endl;
+        exit(1);
+    }
+    const int* row_pointers = arg.get_row_pointers();
+    const int* col_indices = arg.get_col_indices();
+    const T* values = arg.get_values();
+    block_row_count_ = (rows_ + block_rows - 1) / block_rows;
+    int grain = std::max(1, (int)((long long)kParallelGrain * block_row_count_ / std::max(1, nnz_)));
+
+    block_row_pointers_.assign(block_row_count_ + 1, 0);
+    parallel_for(0, block_row_count_, grain, [&](int begin, int end) {
+        std::vector<int> columns;
+        for (int block_row = begin; block_row < end; block_row++) {
+            block_columns(row_pointers, col_indices, rows_, block_rows, block_cols, block_row, columns);
+            block_row_pointers_[block_row + 1] = (int)columns.size();
+        }
+    });
+    parallel_prefix_sum(block_row_pointers_.data() + 1, block_row_count_);
+
+    int blocks = block_row_pointers_[block_row_count_];
+    int block_size = block_rows * block_cols;
+    block_col_indices_.assign(blocks, 0);
+    values_.assign((size_t)blocks * block_size, T(0));
+    parallel_for(0, block_row_count_, grain, [&](int begin, int end) {
+        std::vector<int> columns;
+        for (int block_row = begin; block_row < end; block_row++) {
+            block_columns(row_pointers, col_indices, rows_, block_rows, block_cols, block_row, columns);
+            int first = block_row_pointers_[block_row];
+            std::copy(columns.begin(), columns.end(), block_col_indices_.begin() + first);
+            int last_row = std::min(rows_, (block_row + 1) * block_rows);
+            for (int i = block_row * block_rows; i < last_row; i++) {
+                for (int k = row_pointers[i]; k < row_pointers[i + 1]; k++) {
+                    int col = col_indices[k];
+                    int position = (int)(std::lower_bound(columns.begin(), columns.end(), col / block_cols) - columns.begin());
+                    values_[(size_t)(first + position) * block_size + (i - block_row * block_rows) * block_cols + col % block_cols] += values[k];
+                }
+            }
+        }
+    });
+}
+
+// 行数を返す
+template <class T>
+int BasicBcsrMatrix<T>::rows(void) const { return rows_; }
+
+// 列数を返す
+template <class T>
+int BasicBcsrMatrix<T>::cols(void) const { return cols_; }
+
+// 非ゼロ要素数を返す
+template <class T>
+int BasicBcsrMatrix<T>::nnz(void) const { return nnz_; }
+
+// ブロックの行数を返す
+template <class T>
+int BasicBcsrMatrix<T>::block_rows(void) const { return block_rows_; }
+
+// ブロックの列数を返す
+template <class T>
+int BasicBcsrMatrix<T>::block_cols(void) const { return block_cols_; }
+
+// ブロック数を返す
+template <class T>
+int BasicBcsrMatrix<T>::blocks(void) const { return block_row_pointers_[block_row_count_]; }
+
+// ベクトル（ビューを含む）との乗算演算子
+template <class T>
+BasicVector<T> BasicBcsrMatrix<T>::operator*(const BasicVectorView<T>& arg) const {
+    BasicVector<T> result(rows_);
+    multiply(1.0, arg, 0.0, BasicVectorView<T>(result));
+    return result;
+}
+
+// 行列（ビュー、転置行列を含む）との乗算演算子
+template <class T>
+BasicMatrix<T> BasicBcsrMatrix<T>::operator*(const BasicMatrixView<T>& arg) const {
+    BasicMatrix<T> result(rows_, arg.cols());
+    multiply(1.0, arg, 0.0, BasicMatrixView<T>(result));
+    return result;
+}
+
+// y = alpha * A * x + beta * y
+// x をブロックの列数の倍数まで倍精度でゼロ埋めした配列に写してから、ブロックの大きさで展開したカーネルを呼ぶ
+template <class T>
+void BasicBcsrMatrix<T>::multiply(double alpha, const BasicVectorView<T>& x, double beta, const BasicVectorView<T>& y) const {
+    if (x.size() != cols_ || y.size() != rows_) {
+        std::cerr << "BcsrMatrix::multiply(double, const VectorView &, double, const VectorView &): Size unmatched" << std::endl;
+        exit(1);
+    }
+    std::vector<double> padded((size_t)(cols_ + block_cols_ - 1) / block_cols_ * block_cols_, 0.0);
+    for (int j = 0; j < cols_; j++) {
+        padded[j] = x[j];
+    }
+    BcsrArrays<T> arrays;
+    arrays.rows = rows_;
+    arrays.block_row_count = block_row_count_;
+    arrays.block_row_pointers = block_row_pointers_.data();
+    arrays.block_col_indices = block_col_indices_.data();
+    arrays.values = values_.data();
+    switch (block_rows_) {
+        case 1:
+            bcsr_spmv_dispatch<1>(block_cols_, arrays, padded.data(), alpha, beta, y);
+            break;
+        case 2:
+            bcsr_spmv_dispatch<2>(block_cols_, arrays, padded.data(), alpha, beta, y);
+            break;
+        case 4:
+            bcsr_spmv_dispatch<4>(block_cols_, arrays, padded.data(), alpha, beta, y);
+            break;
+    }
+}
+
+// C = alpha * A * B + beta * C
+// ブロック行ごとに、ブロック内の非ゼロの値について C の行に B の行を axpy で足し込む（ブロック行は C の別々の行に書き込む）
+template <class T>
+void BasicBcsrMatrix<T>::multiply(double alpha, const BasicMatrixView<T>& B, double beta, const BasicMatrixView<T>& C) const {
+    if (B.rows() != cols_ || C.rows() != rows_ || C.cols() != B.cols()) {
+        std::cerr << "BcsrMatrix::multiply(double, const MatrixView &, double, const MatrixView &): Size unmatched" << std::endl;
+        exit(1);
+    }
+    int cols = C.cols();
+    parallel_for(0, rows_, cols > 0 ? (kParallelGrain + cols - 1) / cols : kParallelGrain, [&](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            BasicVectorView<T> c_row = C.row(i);
+            if (beta == 0.0) {
+                for (int j = 0; j < cols; j++) {
+                    c_row[j] = 0.0;
+                }
+            } else if (beta != 1.0) {
+                scal(beta, c_row);
+            }
+        }
+    });
+    if (alpha == 0.0 || cols == 0) return;
+    int block_size = block_rows_ * block_cols_;
+    long long work = (long long)blocks() * block_size * cols;
+    int grain = std::max(1, (int)((long long)kParallelGrain * block_row_count_ / std::max(1LL, work)));
+    parallel_for(0, block_row_count_, grain, [&](int begin, int end) {
+        for (int block_row = begin; block_row < end; block_row++) {
+            int rows = std::min(block_rows_, rows_ - block_row * block_rows_);
+            for (int b = block_row_pointers_[block_row]; b < block_row_pointers_[block_row + 1]; b++) {
+                const T* block = values_.data() + (size_t)b * block_size;
+                int first_col = block_col_indices_[b] * block_cols_;
+                int block_width = std::min(block_cols_, cols_ - first_col);
+                for (int r = 0; r < rows; r++) {
+                    BasicVectorView<T> c_row = C.row(block_row * block_rows_ + r);
+                    for (int c = 0; c < block_width; c++) {
+                        T value = block[r * block_cols_ + c];
+                        if (value != T(0)) axpy(alpha * value, B.row(first_col + c), c_row);
+                    }
+                }
+            }
+        }
+    });
+}
+
+// 変換した場合のブロック数を返す（変換はしない）
+template <class T>
+long long BasicBcsrMatrix<T>::count_blocks(const BasicSparseMatrix<T>& arg, int block_rows, int block_cols) {
+    int rows = arg.rows();
+    int block_row_count = (rows + block_rows - 1) / block_rows;
+    int grain = std::max(1, (int)((long long)kParallelGrain * block_row_count / std::max(1, arg.nnz())));
+    return (long long)parallel_sum(0, block_row_count, grain, [&](int begin, int end) {
+        std::vector<int> columns;
+        double count = 0.0;
+        for (int block_row = begin; block_row < end; block_row++) {
+            block_columns(arg.get_row_pointers(), arg.get_col_indices(), rows, block_rows, block_cols, block_row, columns);
+            count += (double)columns.size();
+        }
+        return count;
+    });
+}
+
+// y = alpha * A * x + beta * y を計算する関数
+void spmv(double alpha, const BcsrMatrix& A, const VectorView& x, double beta, const VectorView& y) { A.multiply(alpha, x, beta, y); }
+void spmv(double alpha, const FloatBcsrMatrix& A, const FloatVectorView& x, double beta, const FloatVectorView& y) { A.multiply(alpha, x, beta, y); }
+
+// C = alpha * A * B + beta * C を計算する関数
+void spmm(double alpha, const BcsrMatrix& A, const MatrixView& B, double beta, const MatrixView& C) { A.multiply(alpha, B, beta, C); }
+void spmm(double alpha, const FloatBcsrMatrix& A, const FloatMatrixView& B, double beta, const FloatMatrixView& C) { A.multiply(alpha, B, beta, C); }
+
+// 倍精度と単精度で実体化する
+template class BasicBcsrMatrix<double>;
+template class BasicBcsrMatrix<float>;
@@ -0,0 +1,51 @@
+#include <vector>  // 可変長配列の標準ライブラリ
+
+#include "sparse_matrix.h"
+
+#ifndef __BCSR_MATRIX__
+#define __BCSR_MATRIX__
+
+// ブロック CSR（BCSR）形式の疎行列
+// 行列を block_rows x block_cols の小さな密ブロックに分け、非ゼロ要素を含むブロックだけを CSR 形式で並べる
+// ブロックの中は行優先の密な配列なので、x の連続した block_cols 要素をレジスタに載せたまま block_rows 行分を計算できる
+// ブロックの大きさは 1, 2, 4 の組み合わせのみで、大きさごとに展開したカーネルを使う
+template <class T>
+class BasicBcsrMatrix {
+   private:
+    int rows_;                               // 行数
+    int cols_;                               // 列数
+    int nnz_;                                // 非ゼロ要素数（ブロック内のゼロを含まない）
+    int block_rows_;                         // ブロックの行数
+    int block_cols_;                         // ブロックの列数
+    int block_row_count_;                    // ブロック行の数
+    std::vector<int> block_row_pointers_;    // ブロック行ごとの先頭のブロックの位置
+    std::vector<int> block_col_indices_;     // ブロックの列インデックス（ブロック単位）
+    std::vector<T> values_;                  // ブロックの値（ブロックごとに行優先）
+
+   public:
+    BasicBcsrMatrix(const BasicSparseMatrix<T>& arg, int block_rows = 2, int block_cols = 2); // CSR 形式の疎行列から変換するコンストラクタ
+    int rows(void) const;                    // 行数を返す
+    int cols(void) const;                    // 列数を返す
+    int nnz(void) const;                     // 非ゼロ要素数を返す
+    int block_rows(void) const;              // ブロックの行数を返す
+    int block_cols(void) const;              // ブロックの列数を返す
+    int blocks(void) const;                  // ブロック数を返す
+    BasicVector<T> operator*(const BasicVectorView<T>& arg) const; // ベクトル（ビューを含む）との乗算演算子
+    BasicMatrix<T> operator*(const BasicMatrixView<T>& arg) const; // 行列（ビュー、転置行列を含む）との乗算演算子
+    void multiply(double alpha, const BasicVectorView<T>& x, double beta, const BasicVectorView<T>& y) const; // y = alpha * A * x + beta * y
+    void multiply(double alpha, const BasicMatrixView<T>& B, double beta, const BasicMatrixView<T>& C) const; // C = alpha * A * B + beta * C
+    static long long count_blocks(const BasicSparseMatrix<T>& arg, int block_rows, int block_cols); // 変換した場合のブロック数を返す（変換はしない）
+};
+
+typedef BasicBcsrMatrix<double> BcsrMatrix;
+typedef BasicBcsrMatrix<float> FloatBcsrMatrix;
+
+// y = alpha * A * x + beta * y を計算する関数（x と y は重ならないこと）
+void spmv(double alpha, const BcsrMatrix& A, const VectorView& x, double beta, const VectorView& y);
+void spmv(double alpha, const FloatBcsrMatrix& A, const FloatVectorView& x, double beta, const FloatVectorView& y);
+
+// C = alpha * A * B + beta * C を計算する関数
+void spmm(double alpha, const BcsrMatrix& A, const MatrixView& B, double beta, const MatrixView& C);
+void spmm(double alpha, const FloatBcsrMatrix& A, const FloatMatrixView& B, double beta, const FloatMatrixView& C);
+
+#endif // __BCSR_MATRIX__
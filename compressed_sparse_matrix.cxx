@@ -0,0 +1,298 @@
+#include "compressed_sparse_matrix.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// 列インデックスの先頭のバイト位置を持つブロックの行数
+const int kIndexBlockRows = 64;
+
+// 差 delta を7ビットずつの可変長で持つバイト数を返す
+int varint_bytes(uint32_t delta) {
+    int bytes = 1;
+    while (delta >= 0x80) {
+        delta >>= 7;
+        bytes++;
+    }
+    return bytes;
+}
+
+// 行の列インデックスを直前の列との差で圧縮したバイト数を返す
+long long encoded_bytes(const int* col_indices, int length) {
+    long long bytes = 0;
+    uint32_t previous = 0;
+    for (int k = 0; k < length; k++) {
+        bytes += varint_bytes((uint32_t)col_indices[k] - previous);
+        previous = (uint32_t)col_indices[k];
+    }
+    return bytes;
+}
+
+// 行の列インデックスを直前の列との差で圧縮して out に書き込み、次の行の先頭を返す
+uint8_t* encode_row(uint8_t* out, const int* col_indices, int length) {
+    uint32_t previous = 0;
+    for (int k = 0; k < length; k++) {
+        uint32_t delta = (uint32_t)col_indices[k] - previous;
+        while (delta >= 0x80) {
+            *out++ = (uint8_t)(delta | 0x80);
+            delta >>= 7;
+        }
+        *out++ = (uint8_t)delta;
+        previous = (uint32_t)col_indices[k];
+    }
+    return out;
+}
+
+// 行の列インデックスを復元しながら、行の中の番号と列インデックスで f(k, col) を呼び、次の行の先頭を返す
+// 圧縮した行は1バイトの差を先に判定し、長い差だけ続きのバイトを読む
+template <class F>
+inline const uint8_t* decode_row(const uint8_t* p, int length, bool compressed, F f) {
+    if (!compressed) {
+        for (int k = 0; k < length; k++) {
+            int col;
+            memcpy(&col, p + 4 * k, 4);
+            f(k, col);
+        }
+        return p + 4 * (size_t)length;
+    }
+    uint32_t col = 0;
+    for (int k = 0; k < length; k++) {
+        uint32_t byte = *p++;
+        uint32_t delta = byte & 0x7f;
+        for (int shift = 7; byte & 0x80; shift += 7) {
+            byte = *p++;
+            delta |= (byte & 0x7f) << shift;
+        }
+        col += delta;
+        f(k, (int)col);
+    }
+    return p;
+}
+
+}  // namespace
+
+// CSR 形式の疎行列から圧縮するコンストラクタ
+// ブロックごとに並列にバイト数を求めて先頭のバイト位置を累積し、CSR 形式より小さくなる場合だけブロックごとに並列に書き込む
+template <class T>
+BasicCompressedSparseMatrix<T>::BasicCompressedSparseMatrix(const BasicSparseMatrix<T>& arg)
+    : rows_(arg.rows()), cols_(arg.cols()), nnz_(arg.nnz()), compressed_(true) {
+    const int* row_pointers = arg.get_row_pointers();
+    const int* col_indices = arg.get_col_indices();
+    row_pointers_.assign(row_pointers, row_pointers + rows_ + 1);
+    values_.assign(arg.get_values(), arg.get_values() + nnz_);
+
+    int blocks = (rows_ + kIndexBlockRows - 1) / kIndexBlockRows;
+    int grain = std::max(1, (int)((long long)kParallelGrain * blocks / std::max(1, nnz_)));
+    block_offsets_.assign(blocks + 1, 0);
+    parallel_for(0, blocks, grain, [&](int begin, int end) {
+        for (int b = begin; b < end; b++) {
+            int last = std::min(rows_, (b + 1) * kIndexBlockRows);
+            long long bytes = 0;
+            for (int i = b * kIndexBlockRows; i < last; i++) {
+                bytes += encoded_bytes(col_indices + row_pointers[i], row_pointers[i + 1] - row_pointers[i]);
+            }
+            block_offsets_[b + 1] = bytes;
+        }
+    });
+    for (int b = 0; b < blocks; b++) {
+        block_offsets_[b + 1] += block_offsets_[b];
+    }
+    if (block_offsets_[blocks] >= (long long)nnz_ * (long long)sizeof(int)) {
+        // 圧縮しても小さくならないので、列インデックスをそのまま持つ
+        compressed_ = false;
+        block_offsets_.clear();
+        block_offsets_.shrink_to_fit();
+        indices_.resize((size_t)nnz_ * sizeof(int));
+        if (nnz_ > 0) memcpy(indices_.data(), col_indices, indices_.size());
+        return;
+    }
+    indices_.resize((size_t)block_offsets_[blocks]);
+    parallel_for(0, blocks, grain, [&](int begin, int end) {
+        for (int b = begin; b < end; b++) {
+            int last = std::min(rows_, (b + 1) * kIndexBlockRows);
+            uint8_t* p = indices_.data() + block_offsets_[b];
+            for (int i = b * kIndexBlockRows; i < last; i++) {
+                p = encode_row(p, col_indices + row_pointers[i], row_pointers[i + 1] - row_pointers[i]);
+            }
+        }
+    });
+}
+
+// ブロックの列インデックスの先頭を返す（圧縮していない場合は行ポインタから求める）
+template <class T>
+const uint8_t* BasicCompressedSparseMatrix<T>::block_indices(int block) const {
+    if (!compressed_) return indices_.data() + (size_t)row_pointers_[block * kIndexBlockRows] * sizeof(int);
+    return indices_.data() + block_offsets_[block];
+}
+
+// ブロックを並列に処理し、行ごとに body(i, 列インデックスの先頭) を呼んで次の行の先頭を受け取る
+// work は全体の計算量の目安で、並列化の粒度を決めるのに使う
+template <class T>
+template <class R>
+void BasicCompressedSparseMatrix<T>::for_each_row(long long work, R body) const {
+    int blocks = (rows_ + kIndexBlockRows - 1) / kIndexBlockRows;
+    int grain = std::max(1, (int)((long long)kParallelGrain * blocks / std::max(1LL, work)));
+    parallel_for(0, blocks, grain, [&](int begin, int end) {
+        for (int b = begin; b < end; b++) {
+            int last = std::min(rows_, (b + 1) * kIndexBlockRows);
+            const uint8_t* p = block_indices(b);
+            for (int i = b * kIndexBlockRows; i < last; i++) {
+                p = body(i, p);
+            }
+        }
+    });
+}
+
+// 行数を返す
+template <class T>
+int BasicCompressedSparseMatrix<T>::rows(void) const { return rows_; }
+
+// 列数を返す
+template <class T>
+int BasicCompressedSparseMatrix<T>::cols(void) const { return cols_; }
+
+// 非ゼロ要素数を返す
+template <class T>
+int BasicCompressedSparseMatrix<T>::nnz(void) const { return nnz_; }
+
+// 列インデックスを圧縮しているかを返す
+template <class T>
+bool BasicCompressedSparseMatrix<T>::compressed(void) const { return compressed_; }
+
+// 値のポインタを取得する
+template <class T>
+T* BasicCompressedSparseMatrix<T>::get_values(void) { return values_.data(); }
+
+// 値のポインタを取得する（const版）
+template <class T>
+const T* BasicCompressedSparseMatrix<T>::get_values(void) const { return values_.data(); }
+
+// CSR 形式の疎行列に戻す
+template <class T>
+BasicSparseMatrix<T> BasicCompressedSparseMatrix<T>::decompress(void) const {
+    BasicSparseMatrix<T> result(rows_, cols_, nnz_);
+    std::copy(row_pointers_.begin(), row_pointers_.end(), result.get_row_pointers());
+    std::copy(values_.begin(), values_.end(), result.get_values());
+    int* col_indices = result.get_col_indices();
+    for_each_row(nnz_, [&](int i, const uint8_t* p) {
+        int* row_cols = col_indices + row_pointers_[i];
+        return decode_row(p, row_pointers_[i + 1] - row_pointers_[i], compressed_, [row_cols](int k, int col) { row_cols[k] = col; });
+    });
+    return result;
+}
+
+// 列インデックスと行の情報に使っているバイト数を返す
+template <class T>
+size_t BasicCompressedSparseMatrix<T>::index_bytes(void) const {
+    return indices_.size() + block_offsets_.size() * sizeof(long long) + row_pointers_.size() * sizeof(int);
+}
+
+// 同じ行列を CSR 形式で持った場合の列インデックスと行ポインタのバイト数を返す
+template <class T>
+size_t BasicCompressedSparseMatrix<T>::csr_index_bytes(void) const { return ((size_t)nnz_ + rows_ + 1) * sizeof(int); }
+
+// 値に使っているバイト数を返す
+template <class T>
+size_t BasicCompressedSparseMatrix<T>::value_bytes(void) const { return values_.size() * sizeof(T); }
+
+// 圧縮前後の使用メモリを表示する
+template <class T>
+void BasicCompressedSparseMatrix<T>::print_memory_report(void) const {
+    size_t compressed = index_bytes();
+    size_t csr = csr_index_bytes();
+    size_t values = value_bytes();
+    if (!compressed_) {
+        std::cout << "indices: not compressed (delta encoding is not smaller than CSR)" << std::endl;
+    }
+    std::cout << "indices: " << compressed << " bytes (CSR " << csr << " bytes, " << 100.0 * compressed / std::max<size_t>(csr, 1) << "%)" << std::endl;
+    std::cout << "values: " << values << " bytes" << std::endl;
+    std::cout << "total: " << compressed + values << " bytes (CSR " << csr + values << " bytes, "
+              << 100.0 * (compressed + values) / std::max<size_t>(csr + values, 1) << "%)" << std::endl;
+}
+
+// ベクトル（ビューを含む）との乗算演算子
+template <class T>
+BasicVector<T> BasicCompressedSparseMatrix<T>::operator*(const BasicVectorView<T>& arg) const {
+    BasicVector<T> result(rows_);
+    multiply(1.0, arg, 0.0, BasicVectorView<T>(result));
+    return result;
+}
+
+// 行列（ビュー、転置行列を含む）との乗算演算子
+template <class T>
+BasicMatrix<T> BasicCompressedSparseMatrix<T>::operator*(const BasicMatrixView<T>& arg) const {
+    BasicMatrix<T> result(rows_, arg.cols());
+    multiply(1.0, arg, 0.0, BasicMatrixView<T>(result));
+    return result;
+}
+
+// y = alpha * A * x + beta * y
+// 行ごとに列インデックスを復元しながら x の要素を集めて、倍精度で内積を取る
+template <class T>
+void BasicCompressedSparseMatrix<T>::multiply(double alpha, const BasicVectorView<T>& x, double beta, const BasicVectorView<T>& y) const {
+    if (x.size() != cols_ || y.size() != rows_) {
+        std::cerr << "CompressedSparseMatrix::multiply(double, const VectorView &, double, const VectorView &): Size unmatched" << std::endl;
+        exit(1);
+    }
+    for_each_row(nnz_, [&](int i, const uint8_t* p) {
+        const T* row_values = values_.data() + row_pointers_[i];
+        double sum = 0.0;
+        p = decode_row(p, row_pointers_[i + 1] - row_pointers_[i], compressed_, [&](int k, int col) { sum += (double)row_values[k] * x[col]; });
+        y[i] = beta == 0.0 ? alpha * sum : alpha * sum + beta * y[i];
+        return p;
+    });
+}
+
+// C = alpha * A * B + beta * C
+// 行ごとに列インデックスを復元しながら、C の行に B の行を axpy で足し込む
+template <class T>
+void BasicCompressedSparseMatrix<T>::multiply(double alpha, const BasicMatrixView<T>& B, double beta, const BasicMatrixView<T>& C) const {
+    if (B.rows() != cols_ || C.rows() != rows_ || C.cols() != B.cols()) {
+        std::cerr << "CompressedSparseMatrix::multiply(double, const MatrixView &, double, const MatrixView &): Size unmatched" << std::endl;
+        exit(1);
+    }
+    int cols = C.cols();
+    for_each_row((long long)nnz_ * cols + rows_, [&](int i, const uint8_t* p) {
+        BasicVectorView<T> c_row = C.row(i);
+        if (beta == 0.0) {
+            for (int j = 0; j < cols; j++) {
+                c_row[j] = 0.0;
+            }
+        } else if (beta != 1.0) {
+            scal(beta, c_row);
+        }
+        const T* row_values = values_.data() + row_pointers_[i];
+        return decode_row(p, row_pointers_[i + 1] - row_pointers_[i], compressed_, [&](int k, int col) {
+            if (alpha != 0.0) axpy(alpha * row_values[k], B.row(col), c_row);
+        });
+    });
+}
+
+// 非ゼロ要素の位置について lhs * transpose_rhs^T を計算して値を上書きする（SDDMM）
+// 行ごとに列インデックスを復元しながら、lhs の行を使い回して transpose_rhs の行との内積を取る
+template <class T>
+void BasicCompressedSparseMatrix<T>::product(const BasicMatrixView<T>& lhs, const BasicMatrixView<T>& transpose_rhs) {
+    if (lhs.rows() != rows_ || lhs.cols() != transpose_rhs.cols() || transpose_rhs.rows() != cols_) {
+        std::cerr << "CompressedSparseMatrix::product(const MatrixView &, const MatrixView &): Size unmatched" << std::endl;
+        exit(1);
+    }
+    T* values = values_.data();
+    for_each_row((long long)nnz_ * lhs.cols() + rows_, [&](int i, const uint8_t* p) {
+        BasicVectorView<T> lhs_row = lhs.row(i);
+        T* row_values = values + row_pointers_[i];
+        return decode_row(p, row_pointers_[i + 1] - row_pointers_[i], compressed_, [&](int k, int col) { row_values[k] = dot(lhs_row, transpose_rhs.row(col)); });
+    });
+}
+
+// y = alpha * A * x + beta * y を計算する関数
+void spmv(double alpha, const CompressedSparseMatrix& A, const VectorView& x, double beta, const VectorView& y) { A.multiply(alpha, x, beta, y); }
+void spmv(double alpha, const FloatCompressedSparseMatrix& A, const FloatVectorView& x, double beta, const FloatVectorView& y) { A.multiply(alpha, x, beta, y); }
+
+// C = alpha * A * B + beta * C を計算する関数
+void spmm(double alpha, const CompressedSparseMatrix& A, const MatrixView& B, double beta, const MatrixView& C) { A.multiply(alpha, B, beta, C); }
+void spmm(double alpha, const FloatCompressedSparseMatrix& A, const FloatMatrixView& B, double beta, const FloatMatrixView& C) { A.multiply(alpha, B, beta, C); }
+
+// 倍精度と単精度で実体化する
+template class BasicCompressedSparseMatrix<double>;
+template class BasicCompressedSparseMatrix<float>;
@@ -0,0 +1,63 @@
+#include <cstddef>  // size_t の標準ライブラリ
+#include <cstdint>  // 固定幅の整数型の標準ライブラリ
+#include <vector>   // 可変長配列の標準ライブラリ
+
+#include "sparse_matrix.h"
+
+#ifndef __COMPRESSED_SPARSE_MATRIX__
+#define __COMPRESSED_SPARSE_MATRIX__
+
+// 列インデックスを行ごとに差分で圧縮した CSR 形式の疎行列
+// 各行の列インデックスは直前の列（行の先頭は 0）との差を 32 ビットの符号なし整数として、7ビットずつの可変長（1〜5バイト）で持つ
+// 差が 127 以下なら1バイト、16383 以下なら2バイトで、大きな差や昇順でない位置（負の差）だけがその要素の分だけ長くなる
+// 行ごとのバイト位置は持たず、64行ごとのブロックの先頭のバイト位置だけを持ち、ブロックの中は行ポインタの要素数で読み進める
+// 圧縮しても CSR 形式の列インデックスより小さくならない行列は、4バイトの列インデックスをそのまま持つ
+// SpMV / SpMM / SDDMM は行を読みながら列インデックスを復元するので、4バイトの列インデックスの配列を読む帯域を減らせる
+template <class T>
+class BasicCompressedSparseMatrix {
+   private:
+    int rows_;                           // 行数
+    int cols_;                           // 列数
+    int nnz_;                            // 非ゼロ要素数
+    std::vector<int> row_pointers_;      // 行ポインタ（値の位置）
+    bool compressed_;                    // 列インデックスを圧縮しているか（false なら4バイトの列インデックスをそのまま持つ）
+    std::vector<long long> block_offsets_; // 64行ごとのブロックの圧縮した列インデックスの先頭のバイト位置
+    std::vector<uint8_t> indices_;       // 圧縮した列インデックス
+    std::vector<T> values_;              // 非ゼロ要素の値
+
+    const uint8_t* block_indices(int block) const; // ブロックの列インデックスの先頭を返す
+    template <class R>
+    void for_each_row(long long work, R body) const; // ブロックを並列に処理し、行ごとに body(i, 列インデックスの先頭) を呼んで次の行の先頭を受け取る
+
+   public:
+    explicit BasicCompressedSparseMatrix(const BasicSparseMatrix<T>& arg); // CSR 形式の疎行列から圧縮するコンストラクタ
+    int rows(void) const;                // 行数を返す
+    int cols(void) const;                // 列数を返す
+    int nnz(void) const;                 // 非ゼロ要素数を返す
+    bool compressed(void) const;         // 列インデックスを圧縮しているかを返す
+    T* get_values(void);                 // 値のポインタを取得する
+    const T* get_values(void) const;     // 値のポインタを取得する（const版）
+    BasicSparseMatrix<T> decompress(void) const; // CSR 形式の疎行列に戻す
+    size_t index_bytes(void) const;      // 列インデックスと行の情報に使っているバイト数を返す
+    size_t csr_index_bytes(void) const;  // 同じ行列を CSR 形式で持った場合の列インデックスと行ポインタのバイト数を返す
+    size_t value_bytes(void) const;      // 値に使っているバイト数を返す
+    void print_memory_report(void) const; // 圧縮前後の使用メモリを表示する
+    BasicVector<T> operator*(const BasicVectorView<T>& arg) const; // ベクトル（ビューを含む）との乗算演算子
+    BasicMatrix<T> operator*(const BasicMatrixView<T>& arg) const; // 行列（ビュー、転置行列を含む）との乗算演算子
+    void multiply(double alpha, const BasicVectorView<T>& x, double beta, const BasicVectorView<T>& y) const; // y = alpha * A * x + beta * y
+    void multiply(double alpha, const BasicMatrixView<T>& B, double beta, const BasicMatrixView<T>& C) const; // C = alpha * A * B + beta * C
+    void product(const BasicMatrixView<T>& lhs, const BasicMatrixView<T>& transpose_rhs); // 非ゼロ要素の位置について lhs * transpose_rhs^T を計算して値を上書きする（SDDMM）
+};
+
+typedef BasicCompressedSparseMatrix<double> CompressedSparseMatrix;
+typedef BasicCompressedSparseMatrix<float> FloatCompressedSparseMatrix;
+
+// y = alpha * A * x + beta * y を計算する関数（x と y は重ならないこと）
+void spmv(double alpha, const CompressedSparseMatrix& A, const VectorView& x, double beta, const VectorView& y);
+void spmv(double alpha, const FloatCompressedSparseMatrix& A, const FloatVectorView& x, double beta, const FloatVectorView& y);
+
+// C = alpha * A * B + beta * C を計算する関数
+void spmm(double alpha, const CompressedSparseMatrix& A, const MatrixView& B, double beta, const MatrixView& C);
+void spmm(double alpha, const FloatCompressedSparseMatrix& A, const FloatMatrixView& B, double beta, const FloatMatrixView& C);
+
+#endif // __COMPRESSED_SPARSE_MATRIX__
@@ -0,0 +1,260 @@
+#include "coo_builder.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <utility>
+
+namespace {
+
+// 同じ位置の組をまとめる方法
+const int kReduceSum = 0;
+const int kReduceMax = 1;
+const int kReduceMin = 2;
+const int kReduceFirst = 3;
+const int kReduceLast = 4;
+
+// 文字列で指定されたまとめ方を番号に変換する
+int parse_reduction(const char* reduction) {
+    if (strcmp(reduction, "sum") == 0) return kReduceSum;
+    if (strcmp(reduction, "max") == 0) return kReduceMax;
+    if (strcmp(reduction, "min") == 0) return kReduceMin;
+    if (strcmp(reduction, "first") == 0) return kReduceFirst;
+    if (strcmp(reduction, "last") == 0) return kReduceLast;
+    std::cerr << "CooBuilder::build(const char *): Unknown reduction " << reduction << std::endl;
+    exit(1);
+}
+
+// 先に追加された値 accumulated に後から追加された値 value をまとめる
+template <class T>
+inline void reduce(int mode, T& accumulated, T value) {
+    switch (mode) {
+        case kReduceSum:
+            accumulated += value;
+            break;
+        case kReduceMax:
+            if (accumulated < value) accumulated = value;
+            break;
+        case kReduceMin:
+            if (value < accumulated) accumulated = value;
+            break;
+        case kReduceLast:
+            accumulated = value;
+            break;
+    }
+}
+
+// 1行分の非ゼロ要素 [first, last) を列インデックスの順に並べ替え（同じ列は追加された順を保つ）、同じ列をまとめる
+// まとめた後の要素数を返す（要素は first から詰めて置かれる）
+template <class T>
+int sort_and_merge_row(int* col_indices, T* values, int first, int last, int mode, std::vector<std::pair<int, T> >& scratch) {
+    bool sorted = true;
+    for (int k = first + 1; k < last; k++) {
+        if (col_indices[k - 1] > col_indices[k]) {
+            sorted = false;
+            break;
+        }
+    }
+    if (!sorted) {
+        scratch.clear();
+        for (int k = first; k < last; k++) {
+            scratch.push_back(std::make_pair(col_indices[k], values[k]));
+        }
+        std::stable_sort(scratch.begin(), scratch.end(), [](const std::pair<int, T>& lhs, const std::pair<int, T>& rhs) { return lhs.first < rhs.first; });
+        for (int k = first; k < last; k++) {
+            col_indices[k] = scratch[k - first].first;
+            values[k] = scratch[k - first].second;
+        }
+    }
+    int write = first;
+    for (int k = first; k < last; k++) {
+        if (write > first && col_indices[write - 1] == col_indices[k]) {
+            reduce(mode, values[write - 1], values[k]);
+        } else {
+            col_indices[write] = col_indices[k];
+            values[write] = values[k];
+            write++;
+        }
+    }
+    return write - first;
+}
+
+}  // namespace
+
+// 行数と列数を指定するコンストラクタ
+template <class T>
+BasicCooBuilder<T>::BasicCooBuilder(int rows, int cols) : rows_(rows), cols_(cols) {}
+
+// count 個の組を格納できるように領域を確保する
+template <class T>
+void BasicCooBuilder<T>::reserve(size_t count) {
+    row_indices_.reserve(count);
+    col_indices_.reserve(count);
+    values_.reserve(count);
+}
+
+// 行数と列数を少なくとも rows, cols に広げる
+template <class T>
+void BasicCooBuilder<T>::grow(int rows, int cols) {
+    rows_ = std::max(rows_, rows);
+    cols_ = std::max(cols_, cols);
+}
+
+// 組を1つ追加する
+template <class T>
+void BasicCooBuilder<T>::add(int row, int col, T value) {
+    if (row < 0 || row >= rows_ || col < 0 || col >= cols_) {
+        std::cerr << "CooBuilder::add(int, int, T): Index out of range" << std::endl;
+        exit(1);
+    }
+    row_indices_.push_back(row);
+    col_indices_.push_back(col);
+    values_.push_back(value);
+}
+
+// 組をまとめて追加する
+template <class T>
+void BasicCooBuilder<T>::add(const int* rows, const int* cols, const T* values, size_t count) {
+    for (size_t k = 0; k < count; k++) {
+        if (rows[k] < 0 || rows[k] >= rows_ || cols[k] < 0 || cols[k] >= cols_) {
+            std::cerr << "CooBuilder::add(const int *, const int *, const T *, size_t): Index out of range" << std::endl;
+            exit(1);
+        }
+    }
+    row_indices_.insert(row_indices_.end(), rows, rows + count);
+    col_indices_.insert(col_indices_.end(), cols, cols + count);
+    values_.insert(values_.end(), values, values + count);
+}
+
+// 追加された組の数を返す
+template <class T>
+size_t BasicCooBuilder<T>::size(void) const { return values_.size(); }
+
+// 追加された組を破棄する（確保した領域も解放する）
+template <class T>
+void BasicCooBuilder<T>::clear(void) {
+    std::vector<int>().swap(row_indices_);
+    std::vector<int>().swap(col_indices_);
+    std::vector<T>().swap(values_);
+}
+
+// 行数を返す
+template <class T>
+int BasicCooBuilder<T>::rows(void) const { return rows_; }
+
+// 列数を返す
+template <class T>
+int BasicCooBuilder<T>::cols(void) const { return cols_; }
+
+// 疎行列を組み立てる
+// 1. 組をスレッド数以下の区間に分け、区間ごとに各行の組の数を数える
+// 2. 行ごとに区間の順で累積して各区間の書き込み位置を求め、行の組の数の累積和で行ポインタを作る
+// 3. 区間ごとに組を行の位置に振り分ける（同じ行の中では追加された順に並ぶ）
+// 4. 行ごとに列インデックスの順に安定に並べ替え、同じ列を reduction でまとめる
+// 5. 重複があった場合のみ、まとめた後の要素数で配列を詰め直す
+template <class T>
+BasicSparseMatrix<T> BasicCooBuilder<T>::build(const char* reduction) {
+    int mode = parse_reduction(reduction);
+    if (values_.size() > (size_t)INT_MAX) {
+        std::cerr << "CooBuilder::build(const char *): Too many entries" << std::endl;
+        exit(1);
+    }
+    int rows = rows_;
+    int count = (int)values_.size();
+    const int* entry_rows = row_indices_.data();
+    const int* entry_cols = col_indices_.data();
+    const T* entry_values = values_.data();
+
+    BasicSparseMatrix<T> result(rows_, cols_);
+    int* row_pointers = result.get_row_pointers();
+    int* col_indices = new int[count];
+    T* values = new T[count];
+
+    // 区間ごとに各行の組の数を数える
+    int parts = std::max(1, std::min(get_num_threads(), count / kParallelGrain));
+    std::vector<std::vector<int> > positions(parts);
+    parallel_for(0, parts, 1, [&](int begin, int end) {
+        for (int p = begin; p < end; p++) {
+            std::vector<int>& position = positions[p];
+            position.assign(rows, 0);
+            int first = (int)((long long)count * p / parts);
+            int last = (int)((long long)count * (p + 1) / parts);
+            for (int k = first; k < last; k++) {
+                position[entry_rows[k]]++;
+            }
+        }
+    });
+
+    // 行ごとに区間の順で累積し、各区間が書き込む行内の位置と行の組の数を求める
+    parallel_for(0, rows, std::max(1, kParallelGrain / parts), [&](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            int sum = 0;
+            for (int p = 0; p < parts; p++) {
+                int n = positions[p][i];
+                positions[p][i] = sum;
+                sum += n;
+            }
+            row_pointers[i + 1] = sum;
+        }
+    });
+    row_pointers[0] = 0;
+    parallel_prefix_sum(row_pointers + 1, rows);
+
+    // 区間ごとに組を行の位置に振り分ける
+    parallel_for(0, parts, 1, [&](int begin, int end) {
+        for (int p = begin; p < end; p++) {
+            std::vector<int>& position = positions[p];
+            int first = (int)((long long)count * p / parts);
+            int last = (int)((long long)count * (p + 1) / parts);
+            for (int k = first; k < last; k++) {
+                int row = entry_rows[k];
+                int dest = row_pointers[row] + position[row]++;
+                col_indices[dest] = entry_cols[k];
+                values[dest] = entry_values[k];
+            }
+        }
+    });
+    std::vector<std::vector<int> >().swap(positions);
+    clear();
+
+    // 行ごとに並べ替えて同じ列をまとめる
+    std::vector<int> merged(rows + 1, 0);
+    int row_grain = std::max(1, (int)((long long)kParallelGrain * rows / std::max(count, 1)));
+    parallel_for(0, rows, row_grain, [&](int begin, int end) {
+        std::vector<std::pair<int, T> > scratch;
+        for (int i = begin; i < end; i++) {
+            merged[i + 1] = sort_and_merge_row(col_indices, values, row_pointers[i], row_pointers[i + 1], mode, scratch);
+        }
+    });
+    parallel_prefix_sum(merged.data() + 1, rows);
+
+    // 重複があった場合は、まとめた後の要素数で配列を詰め直す
+    int nnz = merged[rows];
+    if (nnz < count) {
+        int* merged_col_indices = new int[nnz];
+        T* merged_values = new T[nnz];
+        parallel_for(0, rows, row_grain, [&](int begin, int end) {
+            for (int i = begin; i < end; i++) {
+                int source = row_pointers[i];
+                for (int k = merged[i]; k < merged[i + 1]; k++, source++) {
+                    merged_col_indices[k] = col_indices[source];
+                    merged_values[k] = values[source];
+                }
+            }
+        });
+        delete[] col_indices;
+        delete[] values;
+        col_indices = merged_col_indices;
+        values = merged_values;
+        std::copy(merged.begin(), merged.end(), row_pointers);
+    }
+
+    result.set_col_indices(col_indices);
+    result.set_values(values);
+    result.set_nnz(nnz);
+    return result;
+}
+
+// 倍精度と単精度で実体化する
+template class BasicCooBuilder<double>;
+template class BasicCooBuilder<float>;
@@ -0,0 +1,37 @@
+#include <cstddef>  // size_t の標準ライブラリ
+#include <vector>   // 可変長配列の標準ライブラリ
+
+#include "sparse_matrix.h"
+
+#ifndef __COO_BUILDER__
+#define __COO_BUILDER__
+
+// 順不同の (行, 列, 値) の組を受け取り、CSR 形式の疎行列を組み立てるクラス
+// build() は組を行ごとに並列に振り分け、各行を列インデックスの順に並べ替え、同じ位置の組を reduction でまとめる
+// 振り分け先の配列をそのまま疎行列に渡すので、組の配列以外の中間的なコピーは作らない（重複があった場合のみ詰め直す）
+template <class T>
+class BasicCooBuilder {
+   private:
+    int rows_;                      // 行数
+    int cols_;                      // 列数
+    std::vector<int> row_indices_;  // 組の行インデックス
+    std::vector<int> col_indices_;  // 組の列インデックス
+    std::vector<T> values_;         // 組の値
+
+   public:
+    BasicCooBuilder(int rows, int cols);         // 行数と列数を指定するコンストラクタ
+    void reserve(size_t count);                  // count 個の組を格納できるように領域を確保する
+    void grow(int rows, int cols);               // 行数と列数を少なくとも rows, cols に広げる（大きさが分からないファイルを読み込む場合に使う）
+    void add(int row, int col, T value);         // 組を1つ追加する
+    void add(const int* rows, const int* cols, const T* values, size_t count); // 組をまとめて追加する
+    size_t size(void) const;                     // 追加された組の数を返す
+    void clear(void);                            // 追加された組を破棄する
+    int rows(void) const;                        // 行数を返す
+    int cols(void) const;                        // 列数を返す
+    BasicSparseMatrix<T> build(const char* reduction = "sum"); // 疎行列を組み立てる（"sum", "max", "min", "first", "last"、組は破棄される）
+};
+
+typedef BasicCooBuilder<double> CooBuilder;
+typedef BasicCooBuilder<float> FloatCooBuilder;
+
+#endif // __COO_BUILDER__
@@ -1,14 +1,15 @@
 #include "dss_tensor.h"
 
 // コンストラクタ
-DSSTensor::DSSTensor(SparseMatrix& arg, int depth) : depth_(depth) {
+template <class T>
+BasicDSSTensor<T>::BasicDSSTensor(BasicSparseMatrix<T>& arg, int depth) : depth_(depth) {
     rows_ = arg.rows();
     cols_ = arg.cols();
     nnz_ = arg.nnz();
 
     row_pointers_ = new int[rows_ + 1]();
     col_indices_ = new int[nnz_];
-    elements_ = new SparseVector[nnz_];
+    elements_ = new BasicSparseVector<T>[nnz_];
 
     int* arg_row_pointers = arg.get_row_pointers();
     int* arg_col_indices = arg.get_col_indices();
@@ -23,7 +24,8 @@ DSSTensor::DSSTensor(SparseMatrix& arg, int depth) : depth_(depth) {
 }
 
 // コンストラクタ（要素指定）
-DSSTensor::DSSTensor(SparseMatrix& arg, int depth, SparseVector* elements)
+template <class T>
+BasicDSSTensor<T>::BasicDSSTensor(BasicSparseMatrix<T>& arg, int depth, BasicSparseVector<T>* elements)
     : depth_(depth) {
     rows_ = arg.rows();
     cols_ = arg.cols();
@@ -31,7 +33,7 @@ DSSTensor::DSSTensor(SparseMatrix& arg, int depth, SparseVector* elements)
 
     row_pointers_ = new int[rows_ + 1]();
     col_indices_ = new int[nnz_];
-    elements_ = new SparseVector[nnz_];
+    elements_ = new BasicSparseVector<T>[nnz_];
 
     int* arg_row_pointers = arg.get_row_pointers();
     int* arg_col_indices = arg.get_col_indices();
@@ -47,31 +49,36 @@ DSSTensor::DSSTensor(SparseMatrix& arg, int depth, SparseVector* elements)
 }
 
 // デフォルトコンストラクタ
-DSSTensor::DSSTensor() : rows_(0), cols_(0), depth_(0), nnz_(0) {
+template <class T>
+BasicDSSTensor<T>::BasicDSSTensor() : rows_(0), cols_(0), depth_(0), nnz_(0) {
     row_pointers_ = nullptr;
     col_indices_ = nullptr;
     elements_ = nullptr;
 }
 
 // デストラクタ
-DSSTensor::~DSSTensor() {
+template <class T>
+BasicDSSTensor<T>::~BasicDSSTensor() {
     delete[] row_pointers_;
     delete[] col_indices_;
     delete[] elements_;
 }
 
 // 要素アクセス演算子（非const版）
-SparseVector& DSSTensor::operator()(int row, int index) {
+template <class T>
+BasicSparseVector<T>& BasicDSSTensor<T>::operator()(int row, int index) {
     return elements_[row_pointers_[row] + index];
 }
 
 // 要素アクセス演算子（const版）
-SparseVector DSSTensor::operator()(int row, int index) const {
+template <class T>
+BasicSparseVector<T> BasicDSSTensor<T>::operator()(int row, int index) const {
     return elements_[row_pointers_[row] + index];
 }
 
 // インデックスアクセス演算子（非const版）
-int& DSSTensor::operator()(int row, int index, const char* s) {
+template <class T>
+int& BasicDSSTensor<T>::operator()(int row, int index, const char* s) {
     if (strcmp(s, "index") != 0) {
         std::cerr << "Invalid string parameter" << std::endl;
         exit(1);
@@ -80,7 +87,8 @@ int& DSSTensor::operator()(int row, int index, const char* s) {
 }
 
 // インデックスアクセス演算子（const版）
-int DSSTensor::operator()(int row, int index, const char* s) const {
+template <class T>
+int BasicDSSTensor<T>::operator()(int row, int index, const char* s) const {
     if (strcmp(s, "index") != 0) {
         std::cerr << "Invalid string parameter" << std::endl;
         exit(1);
@@ -89,7 +97,8 @@ int DSSTensor::operator()(int row, int index, const char* s) const {
 }
 
 // 行の要素数を返す演算子
-int DSSTensor::operator()(int row, const char* s) const {
+template <class T>
+int BasicDSSTensor<T>::operator()(int row, const char* s) const {
     if (strcmp(s, "row") != 0) {
         std::cerr << "Invalid string parameter" << std::endl;
         exit(1);
@@ -99,10 +108,12 @@ int DSSTensor::operator()(int row, const char* s) const {
 }
 
 // 非ゼロ要素のインデックスを返す
-int& DSSTensor::dense_index(int row, int index) { return col_indices_[row_pointers_[row] + index]; }
+template <class T>
+int& BasicDSSTensor<T>::dense_index(int row, int index) { return col_indices_[row_pointers_[row] + index]; }
 
 // コピー代入演算子
-DSSTensor& DSSTensor::operator=(const DSSTensor& arg) {
+template <class T>
+BasicDSSTensor<T>& BasicDSSTensor<T>::operator=(const BasicDSSTensor<T>& arg) {
     if (this == &arg) {
         return *this;  // 自己代入の場合、何もしない
     }
@@ -121,7 +132,7 @@ DSSTensor& DSSTensor::operator=(const DSSTensor& arg) {
     // 新しいリソースを確保
     row_pointers_ = new int[rows_ + 1]();
     col_indices_ = new int[nnz_];
-    elements_ = new SparseVector[nnz_];
+    elements_ = new BasicSparseVector<T>[nnz_];
 
     // メンバー変数をコピー
     for (int i = 0; i <= rows_; i++) {
@@ -137,7 +148,8 @@ DSSTensor& DSSTensor::operator=(const DSSTensor& arg) {
 }
 
 // ムーブ代入演算子
-DSSTensor& DSSTensor::operator=(DSSTensor&& arg) {
+template <class T>
+BasicDSSTensor<T>& BasicDSSTensor<T>::operator=(BasicDSSTensor<T>&& arg) {
     if (this == &arg) {
         return *this;  // 自己代入の場合、何もしない
     }
@@ -169,28 +181,40 @@ DSSTensor& DSSTensor::operator=(DSSTensor&& arg) {
 }
 
 // 行数を返す
-int DSSTensor::rows(void) const { return rows_; }
+template <class T>
+int BasicDSSTensor<T>::rows(void) const { return rows_; }
 
 // 列数を返す
-int DSSTensor::cols(void) const { return cols_; }
+template <class T>
+int BasicDSSTensor<T>::cols(void) const { return cols_; }
 
 // 深さを返す
-int DSSTensor::depth(void) const { return depth_; }
+template <class T>
+int BasicDSSTensor<T>::depth(void) const { return depth_; }
 
 // 非ゼロ要素数を返す
-int DSSTensor::nnz(void) const { return nnz_; }
+template <class T>
+int BasicDSSTensor<T>::nnz(void) const { return nnz_; }
 
 // 特定の行の非ゼロ要素数を返す
-int DSSTensor::nnz(int row) const {
+template <class T>
+int BasicDSSTensor<T>::nnz(int row) const {
     int result = row_pointers_[row + 1] - row_pointers_[row];
     return result;
 }
 
 // 非ゼロ要素の配列を返す
-SparseVector* DSSTensor::get_elements() { return elements_; }
+template <class T>
+BasicSparseVector<T>* BasicDSSTensor<T>::get_elements() { return elements_; }
 
 // 行ポインタ配列を返す
-int* DSSTensor::get_row_pointers() { return row_pointers_; }
+template <class T>
+int* BasicDSSTensor<T>::get_row_pointers() { return row_pointers_; }
 
 // 列インデックス配列を返す
-int* DSSTensor::get_col_indices() { return col_indices_; }
\ No newline at end of file
+template <class T>
+int* BasicDSSTensor<T>::get_col_indices() { return col_indices_; }
+
+// 倍精度と単精度で実体化する
+template class BasicDSSTensor<double>;
+template class BasicDSSTensor<float>;
@@ -0,0 +1,306 @@
+#include "factorization_machine.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <mutex>
+#include <random>
+
+#include "simd.h"
+
+namespace {
+
+// 学習で行の順番を混ぜる単位（連続した行をまとめて処理してキャッシュの局所性を保つ）
+const int kFmBlockRows = 64;
+
+// Adagrad の学習率の分母に足す値
+const double kFmAdagradEpsilon = 1e-8;
+
+// sums += alpha * v（倍精度の作業配列に因子行列の行を足し込む）
+inline void accumulate_factors(double alpha, const double* v, double* sums, int n) { simd_axpy(alpha, v, sums, n); }
+inline void accumulate_factors(double alpha, const float* v, double* sums, int n) {
+    for (int f = 0; f < n; f++) {
+        sums[f] += alpha * v[f];
+    }
+}
+
+// CSR 形式の計画行列の行 [begin, end) について f(行, 列インデックス, 値, 要素数) を呼ぶ
+template <class T, class F>
+void visit_rows(const BasicSparseMatrix<T>& X, int begin, int end, std::vector<int>&, std::vector<T>&, F f) {
+    const int* row_pointers = X.get_row_pointers();
+    const int* col_indices = X.get_col_indices();
+    const T* values = X.get_values();
+    for (int r = begin; r < end; r++) {
+        f(r, col_indices + row_pointers[r], values + row_pointers[r], row_pointers[r + 1] - row_pointers[r]);
+    }
+}
+
+// FmDesignMatrix の行 [begin, end) について、行の要素を作業配列に集めてから f(行, 列インデックス, 値, 要素数) を呼ぶ
+// 作業配列は最も長い行の大きさまでしか伸びないので、行ごとの確保は起きない
+template <class T, class F>
+void visit_rows(const BasicFmDesignMatrix<T>& X, int begin, int end, std::vector<int>& cols, std::vector<T>& values, F f) {
+    if (begin >= end) return;
+    int current = begin;
+    cols.clear();
+    values.clear();
+    X.for_each(begin, end, [&](int r, int col, T value) {
+        if (r != current) {
+            f(current, cols.data(), values.data(), (int)cols.size());
+            cols.clear();
+            values.clear();
+            current = r;
+        }
+        cols.push_back(col);
+        values.push_back(value);
+    });
+    f(current, cols.data(), values.data(), (int)cols.size());
+}
+
+// CSR 形式の計画行列の目的変数（ベクトルの要素）
+template <class T>
+struct VectorTargets {
+    const BasicVectorView<T>& targets;
+    double operator()(int row) const { return targets[row]; }
+};
+
+// FmDesignMatrix の目的変数（評価値）
+template <class T>
+struct DesignTargets {
+    const BasicFmDesignMatrix<T>& design;
+    double operator()(int row) const { return design.target(row); }
+};
+
+}  // namespace
+
+// 特徴量と因子の数を指定するコンストラクタ（因子行列は正規乱数で初期化する）
+template <class T>
+BasicFactorizationMachine<T>::BasicFactorizationMachine(int features, int factors, double init_stddev, unsigned seed)
+    : features_(features),
+      factors_(factors),
+      bias_(0.0),
+      bias_accumulator_(0.0),
+      weights_(features, 0.0, "all"),
+      factor_matrix_(features, factors, 0.0),
+      weight_accumulators_(features, 0.0, "all"),
+      factor_accumulators_(features, factors, 0.0),
+      seed_(seed) {
+    if (features <= 0 || factors <= 0) {
+        std::cerr << "FactorizationMachine::FactorizationMachine(int, int, double, unsigned): Invalid size" << std::endl;
+        exit(1);
+    }
+    std::mt19937 generator(seed);
+    std::normal_distribution<double> distribution(0.0, init_stddev);
+    T* values = factor_matrix_.get_values();
+    for (long long i = 0; i < (long long)features * factors; i++) {
+        values[i] = distribution(generator);
+    }
+}
+
+// 特徴量の数を返す
+template <class T>
+int BasicFactorizationMachine<T>::features(void) const { return features_; }
+
+// 因子の数を返す
+template <class T>
+int BasicFactorizationMachine<T>::factors(void) const { return factors_; }
+
+// バイアスを返す
+template <class T>
+double BasicFactorizationMachine<T>::bias(void) const { return bias_; }
+
+// 1次の重みを返す
+template <class T>
+BasicVector<T>& BasicFactorizationMachine<T>::weights(void) { return weights_; }
+
+// 因子行列を返す
+template <class T>
+BasicMatrix<T>& BasicFactorizationMachine<T>::factor_matrix(void) { return factor_matrix_; }
+
+// 1行の予測値を計算し、因子ごとの Σ v_if x_i を sums に残す
+// Σ v_if x_i は因子行列の行の axpy、Σ v_if^2 x_i^2 は行の平方和で、どちらも SIMD カーネルで倍精度に集計する
+template <class T>
+double BasicFactorizationMachine<T>::predict_row(double bias, const int* cols, const T* values, int length, double* sums) const {
+    const T* weights = weights_.get_values();
+    const T* factors = factor_matrix_.get_values();
+    std::fill(sums, sums + factors_, 0.0);
+    double linear = bias;
+    double squares = 0.0;
+    for (int k = 0; k < length; k++) {
+        double x = values[k];
+        const T* v = factors + (long long)cols[k] * factors_;
+        linear += weights[cols[k]] * x;
+        accumulate_factors(x, v, sums, factors_);
+        squares += x * x * simd_sum_squares(v, factors_);
+    }
+    return linear + 0.5 * (simd_sum_squares(sums, factors_) - squares);
+}
+
+// 学習の本体
+// エポックごとに行のブロックの順番を混ぜ、ブロックを並列に処理する
+// 各行で予測値と損失の勾配 g を求め、行に現れる特徴量の w_i と v_i を g x_i と g x_i (Σ v_jf x_j - v_if x_i) に正則化を加えた勾配で更新する
+// バイアスとその勾配の2乗和はブロックの中では写しを更新し、ブロックの終わりに増分をロックして足し込む（すべての行が書き込むので競合する）
+template <class T>
+template <class D, class Y>
+double BasicFactorizationMachine<T>::fit(const D& X, const Y& targets, int epochs, double learning_rate, double regularization, const char* optimizer, const char* loss) {
+    bool adagrad = strcmp(optimizer, "adagrad") == 0;
+    bool logistic = strcmp(loss, "logistic") == 0;
+    if ((!adagrad && strcmp(optimizer, "sgd") != 0) || (!logistic && strcmp(loss, "squared") != 0)) {
+        std::cerr << "FactorizationMachine::train(): Unknown optimizer or loss (" << optimizer << ", " << loss << ")" << std::endl;
+        exit(1);
+    }
+    if (X.cols() > features_) {
+        std::cerr << "FactorizationMachine::train(): Size unmatched" << std::endl;
+        exit(1);
+    }
+    int rows = X.rows();
+    int blocks = (rows + kFmBlockRows - 1) / kFmBlockRows;
+    std::vector<int> order(blocks);
+    for (int b = 0; b < blocks; b++) {
+        order[b] = b;
+    }
+    int grain = std::max(1, kParallelGrain / (kFmBlockRows * factors_));
+    std::mutex bias_mutex;
+    double mean_loss = 0.0;
+    for (int epoch = 0; epoch < epochs; epoch++) {
+        std::mt19937 generator(seed_ + epoch);
+        std::shuffle(order.begin(), order.end(), generator);
+        double total = parallel_sum(0, blocks, grain, [&](int begin, int end) {
+            std::vector<double> sums(factors_);
+            std::vector<int> row_cols;
+            std::vector<T> row_values;
+            T* weights = weights_.get_values();
+            T* factors = factor_matrix_.get_values();
+            T* weight_accumulators = weight_accumulators_.get_values();
+            T* factor_accumulators = factor_accumulators_.get_values();
+            double block_loss = 0.0;
+            for (int b = begin; b < end; b++) {
+                int first = order[b] * kFmBlockRows;
+                int last = std::min(first + kFmBlockRows, rows);
+                double bias;
+                double bias_accumulator;
+                {
+                    std::lock_guard<std::mutex> lock(bias_mutex);
+                    bias = bias_;
+                    bias_accumulator = bias_accumulator_;
+                }
+                double initial_bias = bias;
+                double initial_bias_accumulator = bias_accumulator;
+                visit_rows(X, first, last, row_cols, row_values, [&](int r, const int* cols, const T* values, int length) {
+                    double prediction = predict_row(bias, cols, values, length, sums.data());
+                    double target = targets(r);
+                    double g;
+                    if (logistic) {
+                        double y = target > 0.0 ? 1.0 : -1.0;
+                        double margin = y * prediction;
+                        block_loss += margin > 0.0 ? std::log1p(std::exp(-margin)) : -margin + std::log1p(std::exp(margin));
+                        g = -y / (1.0 + std::exp(margin));
+                    } else {
+                        g = prediction - target;
+                        block_loss += g * g;
+                    }
+                    if (adagrad) {
+                        bias_accumulator += g * g;
+                        bias -= learning_rate * g / (std::sqrt(bias_accumulator) + kFmAdagradEpsilon);
+                    } else {
+                        bias -= learning_rate * g;
+                    }
+                    for (int k = 0; k < length; k++) {
+                        int i = cols[k];
+                        double x = values[k];
+                        T* v = factors + (long long)i * factors_;
+                        double weight_gradient = g * x + regularization * weights[i];
+                        // v_if の勾配は g x (sums_f - v_if x) + λ v_if = g x sums_f + (λ - g x^2) v_if
+                        double gx = g * x;
+                        double decay = regularization - gx * x;
+                        if (adagrad) {
+                            T* v_accumulators = factor_accumulators + (long long)i * factors_;
+                            weight_accumulators[i] += weight_gradient * weight_gradient;
+                            weights[i] -= learning_rate * weight_gradient / (std::sqrt((double)weight_accumulators[i]) + kFmAdagradEpsilon);
+                            for (int f = 0; f < factors_; f++) {
+                                double gradient = gx * sums[f] + decay * v[f];
+                                v_accumulators[f] += gradient * gradient;
+                                v[f] -= learning_rate * gradient / (std::sqrt((double)v_accumulators[f]) + kFmAdagradEpsilon);
+                            }
+                        } else {
+                            weights[i] -= learning_rate * weight_gradient;
+                            for (int f = 0; f < factors_; f++) {
+                                v[f] -= learning_rate * (gx * sums[f] + decay * v[f]);
+                            }
+                        }
+                    }
+                });
+                std::lock_guard<std::mutex> lock(bias_mutex);
+                bias_ += bias - initial_bias;
+                bias_accumulator_ += bias_accumulator - initial_bias_accumulator;
+            }
+            return block_loss;
+        });
+        mean_loss = rows > 0 ? total / rows : 0.0;
+    }
+    return mean_loss;
+}
+
+// 予測の本体（行の区間ごとに作業配列を1回だけ確保する）
+template <class T>
+template <class D>
+void BasicFactorizationMachine<T>::predict_rows(const D& X, const BasicVectorView<T>& result) const {
+    if (X.cols() > features_ || result.size() != X.rows()) {
+        std::cerr << "FactorizationMachine::predict(): Size unmatched" << std::endl;
+        exit(1);
+    }
+    parallel_for(0, X.rows(), std::max(1, kParallelGrain / factors_), [&](int begin, int end) {
+        std::vector<double> sums(factors_);
+        std::vector<int> row_cols;
+        std::vector<T> row_values;
+        visit_rows(X, begin, end, row_cols, row_values, [&](int r, const int* cols, const T* values, int length) {
+            result[r] = predict_row(bias_, cols, values, length, sums.data());
+        });
+    });
+}
+
+// CSR 形式の計画行列で学習し、最後のエポックの平均損失を返す
+// optimizer は "sgd" か "adagrad"、loss は "squared"（平均二乗誤差を返す）か "logistic"（目的変数が正なら正例）
+template <class T>
+double BasicFactorizationMachine<T>::train(const BasicSparseMatrix<T>& X, const BasicVectorView<T>& targets, int epochs, double learning_rate, double regularization, const char* optimizer, const char* loss) {
+    if (targets.size() != X.rows()) {
+        std::cerr << "FactorizationMachine::train(const SparseMatrix &, const VectorView &, int, double, double, const char *, const char *): Size unmatched" << std::endl;
+        exit(1);
+    }
+    VectorTargets<T> y = {targets};
+    return fit(X, y, epochs, learning_rate, regularization, optimizer, loss);
+}
+
+// FmDesignMatrix の評価値を目的変数として学習し、最後のエポックの平均損失を返す
+template <class T>
+double BasicFactorizationMachine<T>::train(const BasicFmDesignMatrix<T>& X, int epochs, double learning_rate, double regularization, const char* optimizer, const char* loss) {
+    DesignTargets<T> y = {X};
+    return fit(X, y, epochs, learning_rate, regularization, optimizer, loss);
+}
+
+// 各行の予測値を result に書き込む
+template <class T>
+void BasicFactorizationMachine<T>::predict(const BasicSparseMatrix<T>& X, const BasicVectorView<T>& result) const { predict_rows(X, result); }
+
+// 各行の予測値を result に書き込む
+template <class T>
+void BasicFactorizationMachine<T>::predict(const BasicFmDesignMatrix<T>& X, const BasicVectorView<T>& result) const { predict_rows(X, result); }
+
+// 各行の予測値を返す
+template <class T>
+BasicVector<T> BasicFactorizationMachine<T>::predict(const BasicSparseMatrix<T>& X) const {
+    BasicVector<T> result(X.rows());
+    predict_rows(X, BasicVectorView<T>(result));
+    return result;
+}
+
+// 各行の予測値を返す
+template <class T>
+BasicVector<T> BasicFactorizationMachine<T>::predict(const BasicFmDesignMatrix<T>& X) const {
+    BasicVector<T> result(X.rows());
+    predict_rows(X, BasicVectorView<T>(result));
+    return result;
+}
+
+// 倍精度と単精度で実体化する
+template class BasicFactorizationMachine<double>;
+template class BasicFactorizationMachine<float>;
@@ -0,0 +1,51 @@
+#include <vector>  // 可変長配列の標準ライブラリ
+
+#include "fm_design_matrix.h"
+#include "sparse_matrix.h"
+
+#ifndef __FACTORIZATION_MACHINE__
+#define __FACTORIZATION_MACHINE__
+
+// 2次の Factorization Machine
+// y = w0 + Σ w_i x_i + Σ_{i<j} <v_i, v_j> x_i x_j を、因子ごとに (Σ v_if x_i)^2 - Σ v_if^2 x_i^2 の半分として O(因子数 × 非ゼロ要素数) で計算する
+// 計画行列は CSR 形式の疎行列（行が特徴量のベクトル）か FmDesignMatrix で渡す
+// 学習は行のブロックを並列に処理する SGD / Adagrad で、重みと因子行列はロックせずに更新する（Hogwild!）
+// すべての行が更新するバイアスは、ブロックごとに写しを取って更新し、ブロックの終わりに差分をロックして反映する
+template <class T>
+class BasicFactorizationMachine {
+   private:
+    int features_;                   // 特徴量の数
+    int factors_;                    // 因子の数
+    double bias_;                    // バイアス w0
+    double bias_accumulator_;        // バイアスの勾配の2乗和（Adagrad）
+    BasicVector<T> weights_;         // 1次の重み w
+    BasicMatrix<T> factor_matrix_;   // 因子行列 V（特徴量の数 × 因子の数）
+    BasicVector<T> weight_accumulators_; // 1次の重みの勾配の2乗和（Adagrad）
+    BasicMatrix<T> factor_accumulators_; // 因子行列の勾配の2乗和（Adagrad）
+    unsigned seed_;                  // 行のブロックの順番を混ぜる乱数の種
+
+    double predict_row(double bias, const int* cols, const T* values, int length, double* sums) const; // バイアス bias で1行の予測値を計算し、因子ごとの Σ v_if x_i を sums に残す
+    template <class D, class Y>
+    double fit(const D& X, const Y& targets, int epochs, double learning_rate, double regularization, const char* optimizer, const char* loss); // 学習の本体
+    template <class D>
+    void predict_rows(const D& X, const BasicVectorView<T>& result) const; // 予測の本体
+
+   public:
+    BasicFactorizationMachine(int features, int factors, double init_stddev = 0.01, unsigned seed = 0); // 特徴量と因子の数を指定するコンストラクタ（因子行列は正規乱数で初期化する）
+    int features(void) const;        // 特徴量の数を返す
+    int factors(void) const;         // 因子の数を返す
+    double bias(void) const;         // バイアスを返す
+    BasicVector<T>& weights(void);   // 1次の重みを返す
+    BasicMatrix<T>& factor_matrix(void); // 因子行列を返す
+    double train(const BasicSparseMatrix<T>& X, const BasicVectorView<T>& targets, int epochs, double learning_rate, double regularization, const char* optimizer = "adagrad", const char* loss = "squared"); // CSR 形式の計画行列で学習し、最後のエポックの平均損失を返す
+    double train(const BasicFmDesignMatrix<T>& X, int epochs, double learning_rate, double regularization, const char* optimizer = "adagrad", const char* loss = "squared"); // FmDesignMatrix の評価値を目的変数として学習し、最後のエポックの平均損失を返す
+    void predict(const BasicSparseMatrix<T>& X, const BasicVectorView<T>& result) const; // 各行の予測値を result に書き込む
+    void predict(const BasicFmDesignMatrix<T>& X, const BasicVectorView<T>& result) const; // 各行の予測値を result に書き込む
+    BasicVector<T> predict(const BasicSparseMatrix<T>& X) const; // 各行の予測値を返す
+    BasicVector<T> predict(const BasicFmDesignMatrix<T>& X) const; // 各行の予測値を返す
+};
+
+typedef BasicFactorizationMachine<double> FactorizationMachine;
+typedef BasicFactorizationMachine<float> FloatFactorizationMachine;
+
+#endif // __FACTORIZATION_MACHINE__
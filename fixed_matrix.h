@@ -0,0 +1,151 @@
+#include "fixed_vector.h"
+#include "matrix.h"
+
+#ifndef __FIXED_MATRIX__
+#define __FIXED_MATRIX__
+
+// 行数と列数をコンパイル時に固定した行列（値は行優先でオブジェクト内に保持する）
+// 各行の処理は FixedKernel<C> で展開される
+// MatrixView に暗黙に変換されるので、Matrix やビューを受け取るカーネルにもそのまま渡せる
+template <int R, int C>
+class FixedMatrix : public MatrixExpression<FixedMatrix<R, C> > {
+   private:
+    alignas(kSimdAlignment) double values_[R * C];  // 行列の値
+
+   public:
+    FixedMatrix(void);                          // 全要素をゼロで初期化するコンストラクタ
+    explicit FixedMatrix(double value);         // 全要素を value で初期化するコンストラクタ
+    template <class E>
+    FixedMatrix(const MatrixExpression<E> &expr); // 式（Matrix やビューを含む）を評価して構築するコンストラクタ
+    template <class E>
+    FixedMatrix &operator=(const MatrixExpression<E> &rhs); // 式を評価して代入する演算子
+    template <class E>
+    FixedMatrix &operator+=(const MatrixExpression<E> &rhs); // 式の加算代入演算子
+    template <class E>
+    FixedMatrix &operator-=(const MatrixExpression<E> &rhs); // 式の減算代入演算子
+
+    int rows(void) const { return R; }          // 行数を取得するメソッド
+    int cols(void) const { return C; }          // 列数を取得するメソッド
+    double &operator()(int row, int col) { return values_[row * C + col]; }      // 要素にアクセスする演算子（非const版）
+    double operator()(int row, int col) const { return values_[row * C + col]; } // 要素にアクセスする演算子（const版）
+    double eval(int index) const { return values_[index]; } // 式テンプレートから要素を読み出すメソッド
+    VectorView row(int row) const { return VectorView(const_cast<double *>(values_) + row * C, C); } // 行を指すビューを返すメソッド
+    double *get_values(void) { return values_; }             // データへのポインタを取得するメソッド
+    const double *get_values(void) const { return values_; } // データへのポインタを取得するメソッド（const版）
+    operator MatrixView(void) const { return MatrixView(const_cast<double *>(values_), R, C, C); } // ビューへの変換
+};
+
+// 式の中では参照で保持する
+template <int R, int C>
+struct MatrixOperand<FixedMatrix<R, C> > {
+    typedef const FixedMatrix<R, C> &type;
+};
+
+// Matrix への変換は明示的に書かせる
+template <int R, int C>
+struct ExplicitMatrixCopy<FixedMatrix<R, C> > {
+    static const bool value = true;
+};
+
+// 全要素をゼロで初期化するコンストラクタ
+template <int R, int C>
+FixedMatrix<R, C>::FixedMatrix(void) {
+    for (int i = 0; i < R * C; i++) {
+        values_[i] = 0.0;
+    }
+}
+
+// 全要素を value で初期化するコンストラクタ
+template <int R, int C>
+FixedMatrix<R, C>::FixedMatrix(double value) {
+    for (int i = 0; i < R * C; i++) {
+        values_[i] = value;
+    }
+}
+
+// 式を評価して構築するコンストラクタ
+template <int R, int C>
+template <class E>
+FixedMatrix<R, C>::FixedMatrix(const MatrixExpression<E> &expr) {
+    *this = expr;
+}
+
+// 式を評価して代入する演算子
+template <int R, int C>
+template <class E>
+FixedMatrix<R, C> &FixedMatrix<R, C>::operator=(const MatrixExpression<E> &rhs) {
+    const E &arg = rhs.self();
+    if (arg.rows() != R || arg.cols() != C) {
+        std::cerr << "FixedMatrix::operator=: Size Unmatched" << std::endl;
+        exit(1);
+    }
+    for (int i = 0; i < R * C; i++) {
+        values_[i] = arg.eval(i);
+    }
+    return *this;
+}
+
+// 式の加算代入演算子
+template <int R, int C>
+template <class E>
+FixedMatrix<R, C> &FixedMatrix<R, C>::operator+=(const MatrixExpression<E> &rhs) {
+    const E &arg = rhs.self();
+    if (arg.rows() != R || arg.cols() != C) {
+        std::cerr << "FixedMatrix::operator+=: Size Unmatched" << std::endl;
+        exit(1);
+    }
+    for (int i = 0; i < R * C; i++) {
+        values_[i] += arg.eval(i);
+    }
+    return *this;
+}
+
+// 式の減算代入演算子
+template <int R, int C>
+template <class E>
+FixedMatrix<R, C> &FixedMatrix<R, C>::operator-=(const MatrixExpression<E> &rhs) {
+    const E &arg = rhs.self();
+    if (arg.rows() != R || arg.cols() != C) {
+        std::cerr << "FixedMatrix::operator-=: Size Unmatched" << std::endl;
+        exit(1);
+    }
+    for (int i = 0; i < R * C; i++) {
+        values_[i] -= arg.eval(i);
+    }
+    return *this;
+}
+
+// 固定長の行列とベクトルの乗算演算子（各行との内積）
+template <int R, int C>
+FixedVector<R> operator*(const FixedMatrix<R, C> &lhs, const FixedVector<C> &rhs) {
+    FixedVector<R> result;
+    const double *values = lhs.get_values();
+    Unroll<0, R>::run([&](int i) { result[i] = FixedKernel<C>::dot(values + i * C, rhs.get_values()); });
+    return result;
+}
+
+// 固定長の行列同士の乗算演算子（結果の各行に rhs の行を axpy で足し込む）
+template <int R, int K, int C>
+FixedMatrix<R, C> operator*(const FixedMatrix<R, K> &lhs, const FixedMatrix<K, C> &rhs) {
+    FixedMatrix<R, C> result;
+    double *result_values = result.get_values();
+    const double *rhs_values = rhs.get_values();
+    for (int i = 0; i < R; i++) {
+        Unroll<0, K>::run([&](int k) { FixedKernel<C>::axpy(lhs(i, k), rhs_values + k * C, result_values + i * C); });
+    }
+    return result;
+}
+
+// 固定長の行列の転置を計算する関数
+template <int R, int C>
+FixedMatrix<C, R> transpose(const FixedMatrix<R, C> &arg) {
+    FixedMatrix<C, R> result;
+    for (int i = 0; i < R; i++) {
+        for (int j = 0; j < C; j++) {
+            result(j, i) = arg(i, j);
+        }
+    }
+    return result;
+}
+
+#endif
@@ -0,0 +1,283 @@
+#include "simd_register.h"
+#include "vector.h"
+
+#ifndef __FIXED_VECTOR__
+#define __FIXED_VECTOR__
+
+// I から N - 1 までの添字で f を呼ぶ処理をコンパイル時に展開する
+template <int I, int N>
+struct Unroll {
+    template <class F>
+    static void run(const F& f) {
+        f(I);
+        Unroll<I + 1, N>::run(f);
+    }
+};
+template <int N>
+struct Unroll<N, N> {
+    template <class F>
+    static void run(const F&) {}
+};
+
+// 長さ N のレベル1カーネル（SIMDレジスタ単位のループと端数の処理をすべて展開する）
+// 命令セットはこのヘッダーをインクルードした翻訳単位のコンパイル時に選択される
+template <int N>
+struct FixedKernel {
+    typedef SimdRegister Simd;
+    typedef typename Simd::reg reg;
+    static const int kWidth = Simd::width;       // 1レジスタの要素数
+    static const int kRegisters = N / kWidth;    // レジスタで処理する回数
+    static const int kHead = kRegisters * kWidth; // レジスタで処理する要素数
+
+    // 内積（4アキュムレータ）
+    static double dot(const double* x, const double* y) {
+        reg acc[4] = {Simd::zero(), Simd::zero(), Simd::zero(), Simd::zero()};
+        Unroll<0, kRegisters>::run([&](int r) {
+            acc[r & 3] = Simd::fmadd(Simd::load(x + r * kWidth), Simd::load(y + r * kWidth), acc[r & 3]);
+        });
+        double result = Simd::sum(Simd::add(Simd::add(acc[0], acc[1]), Simd::add(acc[2], acc[3])));
+        Unroll<kHead, N>::run([&](int i) { result += x[i] * y[i]; });
+        return result;
+    }
+
+    // y += alpha * x
+    static void axpy(double alpha, const double* x, double* y) {
+        reg a = Simd::set1(alpha);
+        Unroll<0, kRegisters>::run([&](int r) {
+            Simd::store(y + r * kWidth, Simd::fmadd(a, Simd::load(x + r * kWidth), Simd::load(y + r * kWidth)));
+        });
+        Unroll<kHead, N>::run([&](int i) { y[i] += alpha * x[i]; });
+    }
+
+    // y = alpha * x + beta * y
+    static void axpby(double alpha, const double* x, double beta, double* y) {
+        reg a = Simd::set1(alpha);
+        reg b = Simd::set1(beta);
+        Unroll<0, kRegisters>::run([&](int r) {
+            Simd::store(y + r * kWidth, Simd::fmadd(a, Simd::load(x + r * kWidth), Simd::mul(b, Simd::load(y + r * kWidth))));
+        });
+        Unroll<kHead, N>::run([&](int i) { y[i] = alpha * x[i] + beta * y[i]; });
+    }
+
+    // x *= alpha
+    static void scal(double alpha, double* x) {
+        reg a = Simd::set1(alpha);
+        Unroll<0, kRegisters>::run([&](int r) { Simd::store(x + r * kWidth, Simd::mul(a, Simd::load(x + r * kWidth))); });
+        Unroll<kHead, N>::run([&](int i) { x[i] *= alpha; });
+    }
+
+    // z += alpha * x * y（要素ごとの積）
+    static void fmadd(double alpha, const double* x, const double* y, double* z) {
+        reg a = Simd::set1(alpha);
+        Unroll<0, kRegisters>::run([&](int r) {
+            reg ax = Simd::mul(a, Simd::load(x + r * kWidth));
+            Simd::store(z + r * kWidth, Simd::fmadd(ax, Simd::load(y + r * kWidth), Simd::load(z + r * kWidth)));
+        });
+        Unroll<kHead, N>::run([&](int i) { z[i] += alpha * x[i] * y[i]; });
+    }
+
+    // x・y, x・x, y・y を同時に計算
+    static void dot_norms(const double* x, const double* y, double* xy, double* xx, double* yy) {
+        reg sxy = Simd::zero(), sxx = Simd::zero(), syy = Simd::zero();
+        Unroll<0, kRegisters>::run([&](int r) {
+            reg vx = Simd::load(x + r * kWidth);
+            reg vy = Simd::load(y + r * kWidth);
+            sxy = Simd::fmadd(vx, vy, sxy);
+            sxx = Simd::fmadd(vx, vx, sxx);
+            syy = Simd::fmadd(vy, vy, syy);
+        });
+        double rxy = Simd::sum(sxy), rxx = Simd::sum(sxx), ryy = Simd::sum(syy);
+        Unroll<kHead, N>::run([&](int i) {
+            rxy += x[i] * y[i];
+            rxx += x[i] * x[i];
+            ryy += y[i] * y[i];
+        });
+        *xy = rxy;
+        *xx = rxx;
+        *yy = ryy;
+    }
+
+    // u' = alpha * u + beta * v, v' = alpha * v + beta * u
+    static void coupled_axpby(double alpha, double beta, double* u, double* v) {
+        reg a = Simd::set1(alpha);
+        reg b = Simd::set1(beta);
+        Unroll<0, kRegisters>::run([&](int r) {
+            reg vu = Simd::load(u + r * kWidth);
+            reg vv = Simd::load(v + r * kWidth);
+            Simd::store(u + r * kWidth, Simd::fmadd(a, vu, Simd::mul(b, vv)));
+            Simd::store(v + r * kWidth, Simd::fmadd(a, vv, Simd::mul(b, vu)));
+        });
+        Unroll<kHead, N>::run([&](int i) {
+            double u_i = u[i];
+            double v_i = v[i];
+            u[i] = alpha * u_i + beta * v_i;
+            v[i] = alpha * v_i + beta * u_i;
+        });
+    }
+};
+
+// 要素数をコンパイル時に固定したベクトル（値はオブジェクト内に64バイト境界に揃えて保持する）
+// 行列分解の潜在ベクトルのように次元が決まっている場合に、ヒープ確保なしで展開されたカーネルを使う
+// VectorView に暗黙に変換されるので、Vector や行列の行を受け取るカーネルにもそのまま渡せる
+// 要素は倍精度のみ（単精度は FloatVector を使う）
+template <int N>
+class FixedVector : public VectorExpression<FixedVector<N> > {
+   private:
+    alignas(kSimdAlignment) double values_[N];  // ベクトルの値
+
+   public:
+    FixedVector(void);                          // 全要素をゼロで初期化するコンストラクタ
+    explicit FixedVector(double value);         // 全要素を value で初期化するコンストラクタ
+    template <class E>
+    FixedVector(const VectorExpression<E>& expr); // 式（Vector やビューを含む）を評価して構築するコンストラクタ
+    template <class E>
+    FixedVector& operator=(const VectorExpression<E>& rhs); // 式を評価して代入する演算子
+    template <class E>
+    FixedVector& operator+=(const VectorExpression<E>& rhs); // 式の加算代入演算子
+    template <class E>
+    FixedVector& operator-=(const VectorExpression<E>& rhs); // 式の減算代入演算子
+
+    int size(void) const { return N; }                       // サイズを取得するメソッド
+    double operator[](int index) const { return values_[index]; } // インデックスで要素にアクセスするためのconstメソッド
+    double& operator[](int index) { return values_[index]; } // インデックスで要素にアクセスするための非constメソッド
+    double eval(int index) const { return values_[index]; }  // 式テンプレートから要素を読み出すメソッド
+    double* get_values(void) { return values_; }             // データへのポインタを取得するメソッド
+    const double* get_values(void) const { return values_; } // データへのポインタを取得するメソッド（const版）
+    operator VectorView(void) const { return VectorView(const_cast<double*>(values_), N); } // ビューへの変換
+};
+
+// 式の中では参照で保持する
+template <int N>
+struct VectorOperand<FixedVector<N> > {
+    typedef const FixedVector<N>& type;
+};
+
+// Vector への変換は明示的に書かせる
+template <int N>
+struct ExplicitVectorCopy<FixedVector<N> > {
+    static const bool value = true;
+};
+
+// 全要素をゼロで初期化するコンストラクタ
+template <int N>
+FixedVector<N>::FixedVector(void) {
+    for (int i = 0; i < N; i++) {
+        values_[i] = 0.0;
+    }
+}
+
+// 全要素を value で初期化するコンストラクタ
+template <int N>
+FixedVector<N>::FixedVector(double value) {
+    for (int i = 0; i < N; i++) {
+        values_[i] = value;
+    }
+}
+
+// 式を評価して構築するコンストラクタ
+template <int N>
+template <class E>
+FixedVector<N>::FixedVector(const VectorExpression<E>& expr) {
+    *this = expr;
+}
+
+// 式を評価して代入する演算子
+template <int N>
+template <class E>
+FixedVector<N>& FixedVector<N>::operator=(const VectorExpression<E>& rhs) {
+    const E& arg = rhs.self();
+    if (arg.size() != N) {
+        std::cerr << "FixedVector::operator=: Size Unmatched" << std::endl;
+        exit(1);
+    }
+    for (int i = 0; i < N; i++) {
+        values_[i] = arg.eval(i);
+    }
+    return *this;
+}
+
+// 式の加算代入演算子
+template <int N>
+template <class E>
+FixedVector<N>& FixedVector<N>::operator+=(const VectorExpression<E>& rhs) {
+    const E& arg = rhs.self();
+    if (arg.size() != N) {
+        std::cerr << "FixedVector::operator+=: Size Unmatched" << std::endl;
+        exit(1);
+    }
+    for (int i = 0; i < N; i++) {
+        values_[i] += arg.eval(i);
+    }
+    return *this;
+}
+
+// 式の減算代入演算子
+template <int N>
+template <class E>
+FixedVector<N>& FixedVector<N>::operator-=(const VectorExpression<E>& rhs) {
+    const E& arg = rhs.self();
+    if (arg.size() != N) {
+        std::cerr << "FixedVector::operator-=: Size Unmatched" << std::endl;
+        exit(1);
+    }
+    for (int i = 0; i < N; i++) {
+        values_[i] -= arg.eval(i);
+    }
+    return *this;
+}
+
+// 固定長ベクトルの内積を計算する関数
+template <int N>
+double dot(const FixedVector<N>& lhs, const FixedVector<N>& rhs) {
+    return FixedKernel<N>::dot(lhs.get_values(), rhs.get_values());
+}
+
+// 固定長ベクトル同士の内積演算子で使う
+template <int N>
+double expression_dot(const FixedVector<N>& lhs, const FixedVector<N>& rhs) {
+    return dot(lhs, rhs);
+}
+
+// 固定長ベクトルの平方和を計算する関数
+template <int N>
+double squared_sum(const FixedVector<N>& arg) {
+    return FixedKernel<N>::dot(arg.get_values(), arg.get_values());
+}
+
+// y += alpha * x
+template <int N>
+void axpy(double alpha, const FixedVector<N>& x, FixedVector<N>& y) {
+    FixedKernel<N>::axpy(alpha, x.get_values(), y.get_values());
+}
+
+// y = alpha * x + beta * y
+template <int N>
+void axpby(double alpha, const FixedVector<N>& x, double beta, FixedVector<N>& y) {
+    FixedKernel<N>::axpby(alpha, x.get_values(), beta, y.get_values());
+}
+
+// x *= alpha
+template <int N>
+void scal(double alpha, FixedVector<N>& x) {
+    FixedKernel<N>::scal(alpha, x.get_values());
+}
+
+// z += alpha * x * y（要素ごとの積）
+template <int N>
+void fmadd(double alpha, const FixedVector<N>& x, const FixedVector<N>& y, FixedVector<N>& z) {
+    FixedKernel<N>::fmadd(alpha, x.get_values(), y.get_values(), z.get_values());
+}
+
+// 内積と両方の平方和を同時に計算する関数
+template <int N>
+void dot_and_norms(const FixedVector<N>& x, const FixedVector<N>& y, double& xy, double& xx, double& yy) {
+    FixedKernel<N>::dot_norms(x.get_values(), y.get_values(), &xy, &xx, &yy);
+}
+
+// 行列分解のSGD更新を u と v に同時に行う関数（どちらも更新前の値を使う）
+template <int N>
+void sgd_update(double lr, double err, double reg, FixedVector<N>& u, FixedVector<N>& v) {
+    FixedKernel<N>::coupled_axpby(1.0 - lr * reg, lr * err, u.get_values(), v.get_values());
+}
+
+#endif
@@ -0,0 +1,151 @@
+#include "fm_design_matrix.h"
+
+#include <climits>
+#include <vector>
+
+namespace {
+
+// 計画行列の行 rows 行を処理する並列化の粒度を返す（1行あたり平均 nnz / rows 要素）
+int design_grain(int rows, long long nnz) { return std::max(1, (int)((long long)kParallelGrain * rows / std::max(1LL, nnz))); }
+
+}  // namespace
+
+// 評価行列だけから作るコンストラクタ
+template <class T>
+BasicFmDesignMatrix<T>::BasicFmDesignMatrix(const BasicSparseMatrix<T>& interactions)
+    : interactions_(&interactions), user_features_(nullptr), item_features_(nullptr) {
+    user_feature_offset_ = interactions.rows() + interactions.cols();
+    item_feature_offset_ = user_feature_offset_;
+    cols_ = user_feature_offset_;
+}
+
+// 特徴量を加えるコンストラクタ（行数が0の行列はその側の特徴量を使わない）
+template <class T>
+BasicFmDesignMatrix<T>::BasicFmDesignMatrix(const BasicSparseMatrix<T>& interactions, const BasicSparseMatrix<T>& user_features, const BasicSparseMatrix<T>& item_features)
+    : BasicFmDesignMatrix(interactions) {
+    if ((user_features.rows() != 0 && user_features.rows() != interactions.rows()) || (item_features.rows() != 0 && item_features.rows() != interactions.cols())) {
+        std::cerr << "FmDesignMatrix::FmDesignMatrix(const SparseMatrix &, const SparseMatrix &, const SparseMatrix &): Size unmatched" << std::endl;
+        exit(1);
+    }
+    if (user_features.rows() != 0) {
+        user_features_ = &user_features;
+        item_feature_offset_ += user_features.cols();
+    }
+    if (item_features.rows() != 0) {
+        item_features_ = &item_features;
+    }
+    cols_ = item_feature_offset_ + (item_features_ != nullptr ? item_features.cols() : 0);
+}
+
+// 行数（評価行列の非ゼロ要素数）を返す
+template <class T>
+int BasicFmDesignMatrix<T>::rows(void) const { return interactions_->nnz(); }
+
+// 列数を返す
+template <class T>
+int BasicFmDesignMatrix<T>::cols(void) const { return cols_; }
+
+// 非ゼロ要素数を返す
+// 各行の2要素に、ユーザーごとの（評価数 × 特徴量の数）とアイテムごとの特徴量の数を足す
+template <class T>
+long long BasicFmDesignMatrix<T>::nnz(void) const {
+    const int* row_pointers = interactions_->get_row_pointers();
+    const int* col_indices = interactions_->get_col_indices();
+    long long result = 2LL * interactions_->nnz();
+    if (user_features_ != nullptr) {
+        const int* feature_row_pointers = user_features_->get_row_pointers();
+        for (int i = 0; i < interactions_->rows(); i++) {
+            result += (long long)(row_pointers[i + 1] - row_pointers[i]) * (feature_row_pointers[i + 1] - feature_row_pointers[i]);
+        }
+    }
+    if (item_features_ != nullptr) {
+        const int* feature_row_pointers = item_features_->get_row_pointers();
+        result += (long long)parallel_sum(0, interactions_->nnz(), kParallelGrain, [&](int begin, int end) {
+            long long sum = 0;
+            for (int r = begin; r < end; r++) {
+                sum += feature_row_pointers[col_indices[r] + 1] - feature_row_pointers[col_indices[r]];
+            }
+            return (double)sum;
+        });
+    }
+    return result;
+}
+
+// 行に対応するユーザー（評価行列の行）を返す
+template <class T>
+int BasicFmDesignMatrix<T>::user(int row) const {
+    const int* row_pointers = interactions_->get_row_pointers();
+    return (int)(std::upper_bound(row_pointers, row_pointers + interactions_->rows() + 1, row) - row_pointers) - 1;
+}
+
+// 行に対応するアイテム（評価行列の列）を返す
+template <class T>
+int BasicFmDesignMatrix<T>::item(int row) const { return interactions_->get_col_indices()[row]; }
+
+// 行に対応する評価値を返す
+template <class T>
+T BasicFmDesignMatrix<T>::target(int row) const { return interactions_->get_values()[row]; }
+
+// CSR 形式の計画行列を作る
+// 行ごとの要素数を並列に数えて累積和で行ポインタを作り、行の区間ごとに並列に書き込む
+template <class T>
+BasicSparseMatrix<T> BasicFmDesignMatrix<T>::materialize(void) const {
+    int rows = this->rows();
+    long long total = nnz();
+    if (total > INT_MAX) {
+        std::cerr << "FmDesignMatrix::materialize(): Too many non-zero elements (" << total << ")" << std::endl;
+        exit(1);
+    }
+    BasicSparseMatrix<T> result(rows, cols_, (int)total);
+    int* row_pointers = result.get_row_pointers();
+    int* col_indices = result.get_col_indices();
+    T* values = result.get_values();
+    int grain = design_grain(rows, total);
+    row_pointers[0] = 0;
+    parallel_for(0, rows, grain, [&](int begin, int end) {
+        for (int r = begin; r < end; r++) {
+            row_pointers[r + 1] = 0;
+        }
+        for_each(begin, end, [&](int r, int, T) { row_pointers[r + 1]++; });
+    });
+    parallel_prefix_sum(row_pointers + 1, rows);
+    parallel_for(0, rows, grain, [&](int begin, int end) {
+        int position = row_pointers[begin];
+        for_each(begin, end, [&](int, int col, T value) {
+            col_indices[position] = col;
+            values[position] = value;
+            position++;
+        });
+    });
+    return result;
+}
+
+// ベクトル（ビューを含む）との乗算演算子
+template <class T>
+BasicVector<T> BasicFmDesignMatrix<T>::operator*(const BasicVectorView<T>& arg) const {
+    BasicVector<T> result(rows());
+    multiply(1.0, arg, 0.0, BasicVectorView<T>(result));
+    return result;
+}
+
+// y = alpha * X * x + beta * y
+// 行の区間ごとに倍精度の作業配列へ集計してから y に書き込む
+template <class T>
+void BasicFmDesignMatrix<T>::multiply(double alpha, const BasicVectorView<T>& x, double beta, const BasicVectorView<T>& y) const {
+    if (x.size() != cols_ || y.size() != rows()) {
+        std::cerr << "FmDesignMatrix::multiply(double, const VectorView &, double, const VectorView &): Size unmatched" << std::endl;
+        exit(1);
+    }
+    int rows = this->rows();
+    parallel_for(0, rows, design_grain(rows, 2LL * rows), [&](int begin, int end) {
+        std::vector<double> sums(end - begin, 0.0);
+        for_each(begin, end, [&](int r, int col, T value) { sums[r - begin] += (double)value * x[col]; });
+        for (int r = begin; r < end; r++) {
+            y[r] = beta == 0.0 ? alpha * sums[r - begin] : alpha * sums[r - begin] + beta * y[r];
+        }
+    });
+}
+
+// 倍精度と単精度で実体化する
+template class BasicFmDesignMatrix<double>;
+template class BasicFmDesignMatrix<float>;
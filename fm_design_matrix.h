@@ -0,0 +1,75 @@
+#include <algorithm>  // アルゴリズムの標準ライブラリ
+
+#include "sparse_matrix.h"
+
+#ifndef __FM_DESIGN_MATRIX__
+#define __FM_DESIGN_MATRIX__
+
+// 評価行列（行がユーザー、列がアイテム）から作る Factorization Machine の計画行列のビュー
+// 計画行列の r 行は評価行列の r 番目の非ゼロ要素 (i, j) に対応し、列 i と列 rows + j が 1 の行になる
+// ユーザーとアイテムの特徴量の行列を渡すと、その行 i と行 j の要素をさらに後ろの列に並べる
+// 計画行列は作らずに元の行列を参照するだけなので、元の行列より長く使わないこと
+template <class T>
+class BasicFmDesignMatrix {
+   private:
+    const BasicSparseMatrix<T>* interactions_;  // 評価行列
+    const BasicSparseMatrix<T>* user_features_; // ユーザーの特徴量（使わない場合は nullptr）
+    const BasicSparseMatrix<T>* item_features_; // アイテムの特徴量（使わない場合は nullptr）
+    int user_feature_offset_;                    // ユーザーの特徴量の先頭の列
+    int item_feature_offset_;                    // アイテムの特徴量の先頭の列
+    int cols_;                                   // 列数
+
+   public:
+    explicit BasicFmDesignMatrix(const BasicSparseMatrix<T>& interactions); // 評価行列だけから作るコンストラクタ
+    BasicFmDesignMatrix(const BasicSparseMatrix<T>& interactions, const BasicSparseMatrix<T>& user_features, const BasicSparseMatrix<T>& item_features); // 特徴量を加えるコンストラクタ（行数が0の行列はその側の特徴量を使わない）
+    int rows(void) const;                        // 行数（評価行列の非ゼロ要素数）を返す
+    int cols(void) const;                        // 列数を返す
+    long long nnz(void) const;                   // 非ゼロ要素数を返す
+    int user(int row) const;                     // 行に対応するユーザー（評価行列の行）を返す
+    int item(int row) const;                     // 行に対応するアイテム（評価行列の列）を返す
+    T target(int row) const;                     // 行に対応する評価値を返す
+    template <class F>
+    void for_each(int begin, int end, F f) const; // 行 [begin, end) の要素について順に f(行, 列, 値) を呼ぶ
+    BasicSparseMatrix<T> materialize(void) const; // CSR 形式の計画行列を作る
+    BasicVector<T> operator*(const BasicVectorView<T>& arg) const; // ベクトル（ビューを含む）との乗算演算子
+    void multiply(double alpha, const BasicVectorView<T>& x, double beta, const BasicVectorView<T>& y) const; // y = alpha * X * x + beta * y
+};
+
+typedef BasicFmDesignMatrix<double> FmDesignMatrix;
+typedef BasicFmDesignMatrix<float> FloatFmDesignMatrix;
+
+// 行 [begin, end) の要素について順に f(行, 列, 値) を呼ぶ
+// 先頭の行のユーザーだけを二分探索で求め、その後は評価行列の行ポインタを進めながら辿る
+template <class T>
+template <class F>
+void BasicFmDesignMatrix<T>::for_each(int begin, int end, F f) const {
+    if (begin >= end) return;
+    const int* row_pointers = interactions_->get_row_pointers();
+    const int* col_indices = interactions_->get_col_indices();
+    int users = interactions_->rows();
+    int i = user(begin);
+    for (int r = begin; r < end; r++) {
+        while (row_pointers[i + 1] <= r) i++;
+        int j = col_indices[r];
+        f(r, i, (T)1);
+        f(r, users + j, (T)1);
+        if (user_features_ != nullptr) {
+            const int* feature_row_pointers = user_features_->get_row_pointers();
+            const int* feature_col_indices = user_features_->get_col_indices();
+            const T* feature_values = user_features_->get_values();
+            for (int k = feature_row_pointers[i]; k < feature_row_pointers[i + 1]; k++) {
+                f(r, user_feature_offset_ + feature_col_indices[k], feature_values[k]);
+            }
+        }
+        if (item_features_ != nullptr) {
+            const int* feature_row_pointers = item_features_->get_row_pointers();
+            const int* feature_col_indices = item_features_->get_col_indices();
+            const T* feature_values = item_features_->get_values();
+            for (int k = feature_row_pointers[j]; k < feature_row_pointers[j + 1]; k++) {
+                f(r, item_feature_offset_ + feature_col_indices[k], feature_values[k]);
+            }
+        }
+    }
+}
+
+#endif // __FM_DESIGN_MATRIX__
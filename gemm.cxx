@@ -0,0 +1,313 @@
+#include "gemm.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "simd_register.h"
+#include "thread_pool.h"
+
+namespace {
+
+// マイクロタイルの大きさ（レジスタに載せる C の部分行列）
+#if defined(__AVX512F__)
+const int kMR = 6;   // 6行 x 16列 = zmmレジスタ12本
+const int kNR = 16;
+#elif defined(__AVX2__) && defined(__FMA__)
+const int kMR = 6;   // 6行 x 8列 = ymmレジスタ12本
+const int kNR = 8;
+#else
+const int kMR = 4;
+const int kNR = 4;
+#endif
+
+// キャッシュブロッキングのパラメータ
+const int kMC = 96;    // L2に載せる A のブロック行数（kMRの倍数）
+const int kKC = 256;   // L1に載せるパネルの深さ
+const int kNC = 4096;  // L3に載せる B のブロック列数（kNRの倍数）
+
+// A のブロック（mc x kc）を kMR 行ごとのマイクロパネルに詰め替える
+// alpha はここで掛けておき、端数の行はゼロで埋める（float の入力もここで倍精度に変換する）
+template <class T>
+void pack_a(int mc, int kc, const T* a, int row_stride, int col_stride, double alpha, double* packed) {
+    for (int i = 0; i < mc; i += kMR) {
+        int mr = std::min(kMR, mc - i);
+        for (int p = 0; p < kc; p++) {
+            const T* src = a + i * row_stride + p * col_stride;
+            for (int r = 0; r < mr; r++) {
+                packed[r] = alpha * src[r * row_stride];
+            }
+            for (int r = mr; r < kMR; r++) {
+                packed[r] = 0.0;
+            }
+            packed += kMR;
+        }
+    }
+}
+
+// B のブロック（kc x nc）を kNR 列ごとのマイクロパネルに詰め替える
+// 端数の列はゼロで埋める
+template <class T>
+void pack_b(int kc, int nc, const T* b, int row_stride, int col_stride, double* packed) {
+    for (int j = 0; j < nc; j += kNR) {
+        int nr = std::min(kNR, nc - j);
+        for (int p = 0; p < kc; p++) {
+            const T* src = b + p * row_stride + j * col_stride;
+            if (col_stride == 1) {
+                for (int c = 0; c < nr; c++) {
+                    packed[c] = src[c];
+                }
+            } else {
+                for (int c = 0; c < nr; c++) {
+                    packed[c] = src[c * col_stride];
+                }
+            }
+            for (int c = nr; c < kNR; c++) {
+                packed[c] = 0.0;
+            }
+            packed += kNR;
+        }
+    }
+}
+
+// 端数のタイルを C に足し込む
+template <class T>
+void add_partial_tile(const double* tile, T* c, int ldc, int mr, int nr) {
+    for (int r = 0; r < mr; r++) {
+        for (int j = 0; j < nr; j++) {
+            c[r * ldc + j] += tile[r * kNR + j];
+        }
+    }
+}
+
+#if defined(__AVX512F__)
+
+// マイクロカーネル（AVX-512）: C(6x16) += A(6xkc) * B(kcx16)
+template <class T>
+void micro_kernel(int kc, const double* a, const double* b, T* c, int ldc, int mr, int nr) {
+    __m512d c00 = _mm512_setzero_pd(), c01 = _mm512_setzero_pd();
+    __m512d c10 = _mm512_setzero_pd(), c11 = _mm512_setzero_pd();
+    __m512d c20 = _mm512_setzero_pd(), c21 = _mm512_setzero_pd();
+    __m512d c30 = _mm512_setzero_pd(), c31 = _mm512_setzero_pd();
+    __m512d c40 = _mm512_setzero_pd(), c41 = _mm512_setzero_pd();
+    __m512d c50 = _mm512_setzero_pd(), c51 = _mm512_setzero_pd();
+    for (int p = 0; p < kc; p++) {
+        __m512d b0 = _mm512_loadu_pd(b);
+        __m512d b1 = _mm512_loadu_pd(b + 8);
+        __m512d ai;
+        ai = _mm512_set1_pd(a[0]);
+        c00 = _mm512_fmadd_pd(ai, b0, c00);
+        c01 = _mm512_fmadd_pd(ai, b1, c01);
+        ai = _mm512_set1_pd(a[1]);
+        c10 = _mm512_fmadd_pd(ai, b0, c10);
+        c11 = _mm512_fmadd_pd(ai, b1, c11);
+        ai = _mm512_set1_pd(a[2]);
+        c20 = _mm512_fmadd_pd(ai, b0, c20);
+        c21 = _mm512_fmadd_pd(ai, b1, c21);
+        ai = _mm512_set1_pd(a[3]);
+        c30 = _mm512_fmadd_pd(ai, b0, c30);
+        c31 = _mm512_fmadd_pd(ai, b1, c31);
+        ai = _mm512_set1_pd(a[4]);
+        c40 = _mm512_fmadd_pd(ai, b0, c40);
+        c41 = _mm512_fmadd_pd(ai, b1, c41);
+        ai = _mm512_set1_pd(a[5]);
+        c50 = _mm512_fmadd_pd(ai, b0, c50);
+        c51 = _mm512_fmadd_pd(ai, b1, c51);
+        a += kMR;
+        b += kNR;
+    }
+    if (mr == kMR && nr == kNR) {
+        __m512d acc[kMR][2] = {{c00, c01}, {c10, c11}, {c20, c21}, {c30, c31}, {c40, c41}, {c50, c51}};
+        for (int r = 0; r < kMR; r++) {
+            T* row = c + r * ldc;
+            SimdRegister::store(row, SimdRegister::add(SimdRegister::load(row), acc[r][0]));
+            SimdRegister::store(row + 8, SimdRegister::add(SimdRegister::load(row + 8), acc[r][1]));
+        }
+    } else {
+        double tile[kMR * kNR];
+        _mm512_storeu_pd(tile + 0 * kNR, c00);
+        _mm512_storeu_pd(tile + 0 * kNR + 8, c01);
+        _mm512_storeu_pd(tile + 1 * kNR, c10);
+        _mm512_storeu_pd(tile + 1 * kNR + 8, c11);
+        _mm512_storeu_pd(tile + 2 * kNR, c20);
+        _mm512_storeu_pd(tile + 2 * kNR + 8, c21);
+        _mm512_storeu_pd(tile + 3 * kNR, c30);
+        _mm512_storeu_pd(tile + 3 * kNR + 8, c31);
+        _mm512_storeu_pd(tile + 4 * kNR, c40);
+        _mm512_storeu_pd(tile + 4 * kNR + 8, c41);
+        _mm512_storeu_pd(tile + 5 * kNR, c50);
+        _mm512_storeu_pd(tile + 5 * kNR + 8, c51);
+        add_partial_tile(tile, c, ldc, mr, nr);
+    }
+}
+
+#elif defined(__AVX2__) && defined(__FMA__)
+
+// マイクロカーネル（AVX2 + FMA）: C(6x8) += A(6xkc) * B(kcx8)
+template <class T>
+void micro_kernel(int kc, const double* a, const double* b, T* c, int ldc, int mr, int nr) {
+    __m256d c00 = _mm256_setzero_pd(), c01 = _mm256_setzero_pd();
+    __m256d c10 = _mm256_setzero_pd(), c11 = _mm256_setzero_pd();
+    __m256d c20 = _mm256_setzero_pd(), c21 = _mm256_setzero_pd();
+    __m256d c30 = _mm256_setzero_pd(), c31 = _mm256_setzero_pd();
+    __m256d c40 = _mm256_setzero_pd(), c41 = _mm256_setzero_pd();
+    __m256d c50 = _mm256_setzero_pd(), c51 = _mm256_setzero_pd();
+    for (int p = 0; p < kc; p++) {
+        __m256d b0 = _mm256_loadu_pd(b);
+        __m256d b1 = _mm256_loadu_pd(b + 4);
+        __m256d ai;
+        ai = _mm256_broadcast_sd(a + 0);
+        c00 = _mm256_fmadd_pd(ai, b0, c00);
+        c01 = _mm256_fmadd_pd(ai, b1, c01);
+        ai = _mm256_broadcast_sd(a + 1);
+        c10 = _mm256_fmadd_pd(ai, b0, c10);
+        c11 = _mm256_fmadd_pd(ai, b1, c11);
+        ai = _mm256_broadcast_sd(a + 2);
+        c20 = _mm256_fmadd_pd(ai, b0, c20);
+        c21 = _mm256_fmadd_pd(ai, b1, c21);
+        ai = _mm256_broadcast_sd(a + 3);
+        c30 = _mm256_fmadd_pd(ai, b0, c30);
+        c31 = _mm256_fmadd_pd(ai, b1, c31);
+        ai = _mm256_broadcast_sd(a + 4);
+        c40 = _mm256_fmadd_pd(ai, b0, c40);
+        c41 = _mm256_fmadd_pd(ai, b1, c41);
+        ai = _mm256_broadcast_sd(a + 5);
+        c50 = _mm256_fmadd_pd(ai, b0, c50);
+        c51 = _mm256_fmadd_pd(ai, b1, c51);
+        a += kMR;
+        b += kNR;
+    }
+    if (mr == kMR && nr == kNR) {
+        __m256d acc[kMR][2] = {{c00, c01}, {c10, c11}, {c20, c21}, {c30, c31}, {c40, c41}, {c50, c51}};
+        for (int r = 0; r < kMR; r++) {
+            T* row = c + r * ldc;
+            SimdRegister::store(row, SimdRegister::add(SimdRegister::load(row), acc[r][0]));
+            SimdRegister::store(row + 4, SimdRegister::add(SimdRegister::load(row + 4), acc[r][1]));
+        }
+    } else {
+        double tile[kMR * kNR];
+        _mm256_storeu_pd(tile + 0 * kNR, c00);
+        _mm256_storeu_pd(tile + 0 * kNR + 4, c01);
+        _mm256_storeu_pd(tile + 1 * kNR, c10);
+        _mm256_storeu_pd(tile + 1 * kNR + 4, c11);
+        _mm256_storeu_pd(tile + 2 * kNR, c20);
+        _mm256_storeu_pd(tile + 2 * kNR + 4, c21);
+        _mm256_storeu_pd(tile + 3 * kNR, c30);
+        _mm256_storeu_pd(tile + 3 * kNR + 4, c31);
+        _mm256_storeu_pd(tile + 4 * kNR, c40);
+        _mm256_storeu_pd(tile + 4 * kNR + 4, c41);
+        _mm256_storeu_pd(tile + 5 * kNR, c50);
+        _mm256_storeu_pd(tile + 5 * kNR + 4, c51);
+        add_partial_tile(tile, c, ldc, mr, nr);
+    }
+}
+
+#else
+
+// マイクロカーネル（スカラー版）: C(4x4) += A(4xkc) * B(kcx4)
+template <class T>
+void micro_kernel(int kc, const double* a, const double* b, T* c, int ldc, int mr, int nr) {
+    double tile[kMR * kNR] = {0.0};
+    for (int p = 0; p < kc; p++) {
+        for (int r = 0; r < kMR; r++) {
+            double ar = a[r];
+            for (int j = 0; j < kNR; j++) {
+                tile[r * kNR + j] += ar * b[j];
+            }
+        }
+        a += kMR;
+        b += kNR;
+    }
+    add_partial_tile(tile, c, ldc, mr, nr);
+}
+
+#endif
+
+// 詰め替え済みのブロックに対してマイクロカーネルを並べる
+template <class T>
+void macro_kernel(int mc, int nc, int kc, const double* packed_a, const double* packed_b, T* c, int ldc) {
+    for (int j = 0; j < nc; j += kNR) {
+        int nr = std::min(kNR, nc - j);
+        for (int i = 0; i < mc; i += kMR) {
+            int mr = std::min(kMR, mc - i);
+            micro_kernel(kc, packed_a + i * kc, packed_b + j * kc, c + i * ldc + j, ldc, mr, nr);
+        }
+    }
+}
+
+// C = beta * C
+template <class T>
+void scale_c(int m, int n, double beta, T* c, int ldc) {
+    if (beta == 1.0) return;
+    for (int i = 0; i < m; i++) {
+        T* row = c + i * ldc;
+        if (beta == 0.0) {
+            for (int j = 0; j < n; j++) row[j] = 0.0;
+        } else {
+            for (int j = 0; j < n; j++) row[j] *= beta;
+        }
+    }
+}
+
+// キャッシュブロッキングとレジスタタイル化を行う行列積カーネル（パネルは常に倍精度）
+template <class T>
+void gemm_kernel(int m, int n, int k, double alpha,
+                 const T* a, int a_row_stride, int a_col_stride,
+                 const T* b, int b_row_stride, int b_col_stride,
+                 double beta, T* c, int ldc) {
+    if (m <= 0 || n <= 0) return;
+    scale_c(m, n, beta, c, ldc);
+    if (k <= 0 || alpha == 0.0) return;
+
+    // 詰め替え用のバッファはスレッドごとに使い回す
+    static thread_local std::vector<double> packed_b;
+    int kc_max = std::min(kKC, k);
+    int nc_max = std::min(kNC, n);
+    packed_b.resize((size_t)((nc_max + kNR - 1) / kNR * kNR) * kc_max);
+    double* pb = packed_b.data();
+
+    for (int jc = 0; jc < n; jc += kNC) {
+        int nc = std::min(kNC, n - jc);
+        // A のブロック数がスレッド数より少ない場合は列方向にも分割する
+        int m_blocks = (m + kMC - 1) / kMC;
+        int n_panels = (nc + kNR - 1) / kNR;
+        int n_groups = std::max(1, std::min(n_panels, get_num_threads() / m_blocks));
+        int panels_per_group = (n_panels + n_groups - 1) / n_groups;
+        for (int pc = 0; pc < k; pc += kKC) {
+            int kc = std::min(kKC, k - pc);
+            pack_b(kc, nc, b + pc * b_row_stride + jc * b_col_stride, b_row_stride, b_col_stride, pb);
+            // 小さな行列では並列化しない
+            int grain = (long long)m * nc * kc < (1 << 18) ? m_blocks * n_groups : 1;
+            parallel_for(0, m_blocks * n_groups, grain, [&](int first, int last) {
+                static thread_local std::vector<double> packed_a;
+                packed_a.resize((size_t)((std::min(kMC, m) + kMR - 1) / kMR * kMR) * kc_max);
+                for (int tile = first; tile < last; tile++) {
+                    int ic = (tile / n_groups) * kMC;
+                    int jr = (tile % n_groups) * panels_per_group * kNR;
+                    if (jr >= nc) continue;
+                    int mc = std::min(kMC, m - ic);
+                    int ncg = std::min(panels_per_group * kNR, nc - jr);
+                    pack_a(mc, kc, a + ic * a_row_stride + pc * a_col_stride, a_row_stride, a_col_stride, alpha, packed_a.data());
+                    macro_kernel(mc, ncg, kc, packed_a.data(), pb + jr * kc, c + ic * ldc + jc + jr, ldc);
+                }
+            });
+        }
+    }
+}
+
+}  // namespace
+
+// 倍精度の行列積
+void dgemm(int m, int n, int k, double alpha,
+           const double* a, int a_row_stride, int a_col_stride,
+           const double* b, int b_row_stride, int b_col_stride,
+           double beta, double* c, int ldc) {
+    gemm_kernel(m, n, k, alpha, a, a_row_stride, a_col_stride, b, b_row_stride, b_col_stride, beta, c, ldc);
+}
+
+// 単精度の行列積（詰め替えの際に倍精度に変換し、C に書き戻すときに丸める）
+void sgemm(int m, int n, int k, double alpha,
+           const float* a, int a_row_stride, int a_col_stride,
+           const float* b, int b_row_stride, int b_col_stride,
+           double beta, float* c, int ldc) {
+    gemm_kernel(m, n, k, alpha, a, a_row_stride, a_col_stride, b, b_row_stride, b_col_stride, beta, c, ldc);
+}
@@ -0,0 +1,21 @@
+#ifndef __GEMM__
+#define __GEMM__
+
+// キャッシュブロッキングとレジスタタイル化を行う行列積カーネル
+// C = alpha * A * B + beta * C を計算する
+// A(i, p) = a[i * a_row_stride + p * a_col_stride]
+// B(p, j) = b[p * b_row_stride + j * b_col_stride]
+// C(i, j) = c[i * ldc + j]
+// ストライドを任意に指定できるため、転置した行列もコピーせずに渡せる
+void dgemm(int m, int n, int k, double alpha,
+           const double* a, int a_row_stride, int a_col_stride,
+           const double* b, int b_row_stride, int b_col_stride,
+           double beta, double* c, int ldc);
+
+// 単精度の行列を受け取る版（内部の計算は倍精度で行う）
+void sgemm(int m, int n, int k, double alpha,
+           const float* a, int a_row_stride, int a_col_stride,
+           const float* b, int b_row_stride, int b_col_stride,
+           double beta, float* c, int ldc);
+
+#endif
@@ -1,36 +1,179 @@
 #include "matrix.h"
 
+#include <algorithm>
+
+#include "gemm.h"
+#include "thread_pool.h"
+
+namespace {
+
+// 1行あたり cols 要素の処理を kParallelGrain 程度にまとめる行数
+int row_grain(int cols) { return cols > 0 ? (kParallelGrain + cols - 1) / cols : kParallelGrain; }
+
+// 転置でキャッシュに載せるタイルの一辺
+const int kTransposeTile = 32;
+
+// src（rows x cols、行の間隔 src_stride）の転置を dst（行の間隔 dst_stride）に書き込む
+template <class T>
+void transpose_tile(const T* src, int src_stride, T* dst, int dst_stride, int rows, int cols) {
+    for (int i = 0; i < rows; i++) {
+        for (int j = 0; j < cols; j++) {
+            dst[j * dst_stride + i] = src[i * src_stride + j];
+        }
+    }
+}
+
+// 要素の型に合わせて dgemm と sgemm を呼び分ける
+void typed_gemm(int m, int n, int k, double alpha,
+                const double* a, int a_row_stride, int a_col_stride,
+                const double* b, int b_row_stride, int b_col_stride,
+                double beta, double* c, int ldc) {
+    dgemm(m, n, k, alpha, a, a_row_stride, a_col_stride, b, b_row_stride, b_col_stride, beta, c, ldc);
+}
+void typed_gemm(int m, int n, int k, double alpha,
+                const float* a, int a_row_stride, int a_col_stride,
+                const float* b, int b_row_stride, int b_col_stride,
+                double beta, float* c, int ldc) {
+    sgemm(m, n, k, alpha, a, a_row_stride, a_col_stride, b, b_row_stride, b_col_stride, beta, c, ldc);
+}
+
+// ビューとベクトルの乗算演算子
+template <class T>
+BasicVector<T> matrix_vector_kernel(const BasicMatrixView<T>& lhs, const BasicVectorView<T>& rhs) {
+    if (lhs.cols() != rhs.size() || lhs.rows() == 0) {
+        std::cerr << "operator*(const MatrixView &, const VectorView &): Size unmatched" << std::endl;
+        exit(1);
+    }
+    BasicVector<T> result(lhs.rows());
+    gemv(1.0, lhs, rhs, 0.0, BasicVectorView<T>(result));
+    return result;
+}
+
+// ビュー（転置行列を含む）同士の乗算演算子
+template <class T>
+BasicMatrix<T> matrix_product_kernel(const BasicMatrixView<T>& lhs, const BasicMatrixView<T>& rhs) {
+    if (lhs.cols() != rhs.rows() || lhs.rows() == 0 || rhs.cols() == 0) {
+        std::cerr << "operator*(const Matrix &, const Matrix &): Size unmatched" << std::endl;
+        exit(1);
+    }
+    BasicMatrix<T> result(lhs.rows(), rhs.cols());
+    gemm(1.0, lhs, rhs, 0.0, BasicMatrixView<T>(result));
+    return result;
+}
+
+// ビュー（転置行列を含む）に対する gemm
+// A と B のストライドはそのまま dgemm（単精度は sgemm）に渡し、C の列が連続していない場合は C^T = B^T * A^T として計算する
+template <class T>
+void gemm_kernel(double alpha, const BasicMatrixView<T>& A, const BasicMatrixView<T>& B, double beta, const BasicMatrixView<T>& C) {
+    if (A.cols() != B.rows() || C.rows() != A.rows() || C.cols() != B.cols()) {
+        std::cerr << "gemm(double, const Matrix &, const Matrix &, double, Matrix &): Size unmatched" << std::endl;
+        exit(1);
+    }
+    if (C.col_stride() == 1) {
+        typed_gemm(A.rows(), B.cols(), A.cols(), alpha,
+                   A.data(), A.row_stride(), A.col_stride(),
+                   B.data(), B.row_stride(), B.col_stride(),
+                   beta, C.data(), C.row_stride());
+    } else if (C.row_stride() == 1) {
+        typed_gemm(B.cols(), A.rows(), A.cols(), alpha,
+                   B.data(), B.col_stride(), B.row_stride(),
+                   A.data(), A.col_stride(), A.row_stride(),
+                   beta, C.data(), C.col_stride());
+    } else {
+        BasicMatrix<T> result(C);
+        gemm(alpha, A, B, beta, BasicMatrixView<T>(result));
+        BasicMatrixView<T> target = C;
+        target = BasicMatrixView<T>(result);
+    }
+}
+
+// y = alpha * A * x + beta * y を計算する関数
+// A の行が連続していれば行ごとの内積で、列が連続していれば列ごとの axpy で計算する（どちらも出力の区間で並列化する）
+template <class T>
+void gemv_kernel(double alpha, const BasicMatrixView<T>& A, const BasicVectorView<T>& x, double beta, const BasicVectorView<T>& y) {
+    if (A.cols() != x.size() || A.rows() != y.size()) {
+        std::cerr << "gemv(double, const MatrixView &, const VectorView &, double, const VectorView &): Size unmatched" << std::endl;
+        exit(1);
+    }
+    int rows = A.rows();
+    int cols = A.cols();
+    if (A.row_stride() == 1 && A.col_stride() != 1) {
+        parallel_for(0, rows, row_grain(cols), [&](int begin, int end) {
+            BasicVectorView<T> y_range = y.range(begin, end);
+            if (beta == 0.0) {
+                for (int i = 0; i < end - begin; i++) {
+                    y_range[i] = 0.0;
+                }
+            } else {
+                scal(beta, y_range);
+            }
+            for (int j = 0; j < cols; j++) {
+                axpy(alpha * x[j], A.col(j).range(begin, end), y_range);
+            }
+        });
+        return;
+    }
+    parallel_for(0, rows, row_grain(cols), [&](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            double product = alpha * dot(A.row(i), x);
+            y[i] = beta == 0.0 ? product : product + beta * y[i];
+        }
+    });
+}
+
+}  // namespace
+
 // コンストラクタ（行数と列数を指定）
-Matrix::Matrix(int rows, int cols) : rows_(rows), cols_(cols), values_(new double[rows * cols]) {}
+template <class T>
+BasicMatrix<T>::BasicMatrix(int rows, int cols) : rows_(rows), cols_(cols), values_(simd_alloc<T>(rows * cols)) {}
 
 // コンストラクタ（行数、列数、および初期値を指定）
-Matrix::Matrix(int rows, int cols, double arg) : rows_(rows), cols_(cols), values_(new double[rows * cols]) {
+template <class T>
+BasicMatrix<T>::BasicMatrix(int rows, int cols, double arg) : rows_(rows), cols_(cols), values_(simd_alloc<T>(rows * cols)) {
     for (int i = 0; i < rows * cols; i++) {
         values_[i] = arg;
     }
 }
 
 // デフォルトコンストラクタ
-Matrix::Matrix(void) : rows_(0), cols_(0), values_(NULL) {}
+template <class T>
+BasicMatrix<T>::BasicMatrix(void) : rows_(0), cols_(0), values_(NULL) {}
 
 // コピーコンストラクタ
-Matrix::Matrix(const Matrix& other) : rows_(other.rows_), cols_(other.cols_), values_(new double[other.rows_ * other.cols_]) {
+template <class T>
+BasicMatrix<T>::BasicMatrix(const BasicMatrix& other) : rows_(other.rows_), cols_(other.cols_), values_(simd_alloc<T>(other.rows_ * other.cols_)) {
     for (int i = 0; i < rows_ * cols_; i++) {
         values_[i] = other.values_[i];
     }
 }
 
+// ムーブコンストラクタ
+template <class T>
+BasicMatrix<T>::BasicMatrix(BasicMatrix&& other) : rows_(other.rows_), cols_(other.cols_), values_(other.values_) {
+    other.rows_ = 0;
+    other.cols_ = 0;
+    other.values_ = NULL;
+}
+
+// ビューの要素をコピーするコンストラクタ
+template <class T>
+BasicMatrix<T>::BasicMatrix(const BasicMatrixView<T>& arg) : rows_(arg.rows()), cols_(arg.cols()), values_(simd_alloc<T>(arg.rows() * arg.cols())) {
+    BasicMatrixView<T>(*this) = arg;
+}
+
 // デストラクタ
-Matrix::~Matrix() { delete[] values_; }
+template <class T>
+BasicMatrix<T>::~BasicMatrix() { simd_free(values_); }
 
 // 代入演算子
-Matrix& Matrix::operator=(const Matrix& other) {
+template <class T>
+BasicMatrix<T>& BasicMatrix<T>::operator=(const BasicMatrix& other) {
     if (this != &other) {
         if (rows_ != other.rows_ || cols_ != other.cols_) {
-            delete[] values_;
+            simd_free(values_);
             rows_ = other.rows_;
             cols_ = other.cols_;
-            values_ = new double[rows_ * cols_];
+            values_ = simd_alloc<T>(rows_ * cols_);
         }
         for (int i = 0; i < rows_ * cols_; i++) {
             values_[i] = other.values_[i];
@@ -39,68 +182,96 @@ Matrix& Matrix::operator=(const Matrix& other) {
     return *this;
 }
 
+// ムーブ代入演算子
+template <class T>
+BasicMatrix<T>& BasicMatrix<T>::operator=(BasicMatrix&& other) {
+    if (this != &other) {
+        simd_free(values_);
+        rows_ = other.rows_;
+        cols_ = other.cols_;
+        values_ = other.values_;
+        other.rows_ = 0;
+        other.cols_ = 0;
+        other.values_ = NULL;
+    }
+    return *this;
+}
+
 // 行数を取得するメソッド
-int Matrix::rows() const { return rows_; }
+template <class T>
+int BasicMatrix<T>::rows() const { return rows_; }
 
 // 列数を取得するメソッド
-int Matrix::cols() const { return cols_; }
+template <class T>
+int BasicMatrix<T>::cols() const { return cols_; }
 
 // 要素にアクセスする演算子（非const版）
-double& Matrix::operator()(int row, int col) { return values_[row * cols_ + col]; }
+template <class T>
+T& BasicMatrix<T>::operator()(int row, int col) { return values_[row * cols_ + col]; }
 
 // 要素にアクセスする演算子（const版）
-double Matrix::operator()(int row, int col) const { return values_[row * cols_ + col]; }
+template <class T>
+T BasicMatrix<T>::operator()(int row, int col) const { return values_[row * cols_ + col]; }
+
+// 行を指すビューを返すメソッド
+template <class T>
+BasicVectorView<T> BasicMatrix<T>::row(int row) { return BasicMatrixView<T>(*this).row(row); }
+
+// 列を指すビューを返すメソッド
+template <class T>
+BasicVectorView<T> BasicMatrix<T>::col(int col) { return BasicMatrixView<T>(*this).col(col); }
+
+// [begin, end) 行を指すビューを返すメソッド
+template <class T>
+BasicMatrixView<T> BasicMatrix<T>::row_range(int begin, int end) { return BasicMatrixView<T>(*this).row_range(begin, end); }
+
+// (row, col) から rows x cols のブロックを指すビューを返すメソッド
+template <class T>
+BasicMatrixView<T> BasicMatrix<T>::block(int row, int col, int rows, int cols) { return BasicMatrixView<T>(*this).block(row, col, rows, cols); }
 
 // 行にアクセスする演算子
-Vector Matrix::operator[](int row) {
+template <class T>
+BasicVector<T> BasicMatrix<T>::operator[](int row) {
     if (row >= 0 && row < rows_) {
-        return Vector(values_ + row * cols_, cols_);
+        return BasicVector<T>(values_ + row * cols_, cols_);
     } else {
         throw std::out_of_range("Row index out of range");
     }
 }
 
-// 単項プラス演算子
-Matrix Matrix::operator+() const { return *this; }
-
-// 単項マイナス演算子
-Matrix Matrix::operator-() const {
-    Matrix result(*this);
-    int total_size = rows_ * cols_;
-    for (int i = 0; i < total_size; i++) {
-        result.values_[i] *= -1.0;
-    }
-    return result;
-}
-
 // 加算代入演算子
-Matrix& Matrix::operator+=(const Matrix& rhs) {
+template <class T>
+BasicMatrix<T>& BasicMatrix<T>::operator+=(const BasicMatrix& rhs) {
     if (rows_ != rhs.rows_ || cols_ != rhs.cols_) {
         std::cerr << "Matrix::operator+=: Size Unmatched" << std::endl;
         exit(1);
     }
-    int total_size = rows_ * cols_;
-    for (int i = 0; i < total_size; i++) {
-        values_[i] += rhs.values_[i];
-    }
+    T* values = values_;
+    const T* rhs_values = rhs.values_;
+    parallel_for(0, rows_ * cols_, kParallelGrain, [=](int begin, int end) {
+        simd_add(values + begin, rhs_values + begin, end - begin);
+    });
     return *this;
 }
 
 // 減算代入演算子
-Matrix& Matrix::operator-=(const Matrix& rhs) {
+template <class T>
+BasicMatrix<T>& BasicMatrix<T>::operator-=(const BasicMatrix& rhs) {
     if (rows_ != rhs.rows_ || cols_ != rhs.cols_) {
         std::cerr << "Matrix::operator-=: Size Unmatched" << std::endl;
         exit(1);
     }
-    int total_size = rows_ * cols_;
-    for (int i = 0; i < total_size; i++) {
-        values_[i] -= rhs.values_[i];
-    }
+    T* values = values_;
+    const T* rhs_values = rhs.values_;
+    parallel_for(0, rows_ * cols_, kParallelGrain, [=](int begin, int end) {
+        simd_sub(values + begin, rhs_values + begin, end - begin);
+    });
     return *this;
 }
 
 // 行列を出力するメソッド
-std::ostream& Matrix::print(std::ostream& lhs) const {
+template <class T>
+std::ostream& BasicMatrix<T>::print(std::ostream& lhs) const {
     lhs << "(";
     int rows = rows_;
     int cols = cols_;
@@ -120,84 +291,81 @@ std::ostream& Matrix::print(std::ostream& lhs) const {
 }
 
 // データへのポインタを取得するメソッド
-double* Matrix::get_values() { return values_; }
+template <class T>
+T* BasicMatrix<T>::get_values() { return values_; }
+
+// データへのポインタを取得するメソッド（const版）
+template <class T>
+const T* BasicMatrix<T>::get_values() const { return values_; }
 
 // 行列の出力演算子
-std::ostream& operator<<(std::ostream& lhs, const Matrix& rhs) { return rhs.print(lhs); }
+template <class T>
+std::ostream& operator<<(std::ostream& lhs, const BasicMatrix<T>& rhs) { return rhs.print(lhs); }
 
-// 行列の加算演算子
-Matrix operator+(const Matrix& lhs, const Matrix& rhs) {
-    Matrix result(lhs);
-    return (result += rhs);
+// 行列の加算演算子（右辺値同士）
+template <class T>
+BasicMatrix<T> operator+(BasicMatrix<T>&& lhs, BasicMatrix<T>&& rhs) {
+    lhs += rhs;
+    return std::move(lhs);
 }
 
-// 行列の減算演算子
-Matrix operator-(const Matrix& lhs, const Matrix& rhs) {
-    Matrix result(lhs);
-    return (result -= rhs);
+// 行列の減算演算子（右辺値同士）
+template <class T>
+BasicMatrix<T> operator-(BasicMatrix<T>&& lhs, BasicMatrix<T>&& rhs) {
+    lhs -= rhs;
+    return std::move(lhs);
 }
 
-// スカラー倍の行列演算子
-Matrix operator*(double factor, const Matrix& rhs) {
+// スカラー倍の行列演算子（右辺値）
+template <class T>
+BasicMatrix<T> operator*(double factor, BasicMatrix<T>&& rhs) {
     if (rhs.rows() == 0 || rhs.cols() == 0) {
-        std::cerr << "operator*(double , const Matrix &): Size unmatched" << std::endl;
+        std::cerr << "operator*(double , Matrix &&): Size unmatched" << std::endl;
         exit(1);
     }
-    Matrix result(rhs);
-    int rows = result.rows();
-    int cols = result.cols();
-    for (int row = 0; row < rows; row++) {
-        for (int col = 0; col < cols; col++) {
-            result(row, col) *= factor;
-        }
-    }
-    return result;
+    rhs = factor * rhs;
+    return std::move(rhs);
+}
+
+// スカラー除算の行列演算子（右辺値）
+template <class T>
+BasicMatrix<T> operator/(BasicMatrix<T>&& lhs, double factor) {
+    lhs = lhs / factor;
+    return std::move(lhs);
+}
+
+// 単項マイナス演算子（右辺値）
+template <class T>
+BasicMatrix<T> operator-(BasicMatrix<T>&& arg) {
+    arg = -arg;
+    return std::move(arg);
 }
 
 // 行列とベクトルの乗算演算子
-Vector operator*(const Matrix& lhs, const Vector& rhs) {
+template <class T>
+BasicVector<T> operator*(const BasicMatrix<T>& lhs, const BasicVector<T>& rhs) {
     if (lhs.cols() != rhs.size() || lhs.rows() == 0) {
         std::cerr << "operator*(const Matrix &, const Vector &): Size unmatched" << std::endl;
         exit(1);
     }
-    int rows = lhs.rows();
-    int cols = lhs.cols();
-    Vector result(rows);
-    for (int row = 0; row < rows; row++) {
-        result[row] = 0.0;
-        for (int col = 0; col < cols; col++) {
-            result[row] += lhs(row, col) * rhs[col];
-        }
-    }
+    BasicVector<T> result(lhs.rows());
+    gemv(1.0, BasicMatrixView<T>(lhs), BasicVectorView<T>(rhs), 0.0, BasicVectorView<T>(result));
     return result;
 }
 
 // 行列同士の乗算演算子
-Matrix operator*(Matrix& lhs, Matrix& rhs) {
-    if (lhs.cols() != rhs.rows() || lhs.rows() == 0 || rhs.cols() == 0) {
-        std::cerr << "operator*(const Matrix &, const Matrix &): Size unmatched" << std::endl;
-        exit(1);
-    }
-
-    int rows = lhs.rows();
-    int cols = rhs.cols();
-    int inner_dim = lhs.cols();
-    Matrix result(rows, cols);
-
-    for (int i = 0; i < rows; ++i) {
-        for (int j = 0; j < cols; ++j) {
-            result(i, j) = 0.0;
-            for (int k = 0; k < inner_dim; ++k) {
-                result(i, j) += lhs(i, k) * rhs(k, j);
-            }
-        }
-    }
+template <class T>
+BasicMatrix<T> operator*(const BasicMatrix<T>& lhs, const BasicMatrix<T>& rhs) { return BasicMatrixView<T>(lhs) * BasicMatrixView<T>(rhs); }
 
-    return result;
+// C = alpha * A * B + beta * C を計算する関数
+template <class T>
+void gemm(double alpha, const BasicMatrix<T>& A, const BasicMatrix<T>& B, double beta, BasicMatrix<T>& C) {
+    gemm(alpha, BasicMatrixView<T>(A), BasicMatrixView<T>(B), beta, BasicMatrixView<T>(C));
 }
 
 // 行列の等価比較演算子
-bool operator==(const Matrix& lhs, const Matrix& rhs) {
+template <class T>
+bool operator==(const BasicMatrix<T>& lhs, const BasicMatrix<T>& rhs) {
     if (lhs.rows() != rhs.rows() || lhs.cols() != rhs.cols()) {
         return false;
     }
@@ -214,41 +382,161 @@ bool operator==(const Matrix& lhs, const Matrix& rhs) {
 }
 
 // 行列の不等価比較演算子
-bool operator!=(const Matrix& lhs, const Matrix& rhs) {
+template <class T>
+bool operator!=(const BasicMatrix<T>& lhs, const BasicMatrix<T>& rhs) {
     return !(lhs == rhs);
 }
 
 // 行列の平方和を計算する関数
-double squared_sum(const Matrix& arg) {
-    double result = 0.0;
-    int rows = arg.rows();
-    int cols = arg.cols();
-    for (int row = 0; row < rows; row++) {
-        for (int col = 0; col < cols; col++) {
-            result += arg(row, col) * arg(row, col);
-        }
-    }
-    return result;
+template <class T>
+double squared_sum(const BasicMatrix<T>& arg) {
+    const T* values = arg.get_values();
+    return parallel_sum(0, arg.rows() * arg.cols(), kParallelGrain, [=](int begin, int end) {
+        return simd_sum_squares(values + begin, end - begin);
+    });
 }
 
 // フロベニウスノルムを計算する関数
-double frobenius_norm(const Matrix& arg) {
+template <class T>
+double frobenius_norm(const BasicMatrix<T>& arg) {
     return sqrt(squared_sum(arg));
 }
 
 // 行列の転置を計算する関数
-Matrix transpose(Matrix& arg) {
+// kTransposeTile 四方のタイルごとに転置し、書き込み先の行をキャッシュに載せたまま処理する
+template <class T>
+BasicMatrix<T> transpose(const BasicMatrix<T>& arg) {
     if (arg.rows() == 0 || arg.cols() == 0) {
         std::cerr << "transpose(const Matrix): zero-sized matrix" << std::endl;
         exit(1);
     }
     int rows = arg.rows();
     int cols = arg.cols();
-    Matrix result(cols, rows);
-    for (int i = 0; i < rows; i++) {
-        for (int j = 0; j < cols; j++) {
-            result(j, i) = arg(i, j);
+    BasicMatrix<T> result(cols, rows);
+    const T* src = arg.get_values();
+    T* dst = result.get_values();
+    int row_tiles = (rows + kTransposeTile - 1) / kTransposeTile;
+    parallel_for(0, row_tiles, row_grain(cols * kTransposeTile), [&](int begin, int end) {
+        for (int ti = begin; ti < end; ti++) {
+            int i = ti * kTransposeTile;
+            int tile_rows = std::min(kTransposeTile, rows - i);
+            for (int j = 0; j < cols; j += kTransposeTile) {
+                int tile_cols = std::min(kTransposeTile, cols - j);
+                transpose_tile(src + i * cols + j, cols, dst + j * rows + i, rows, tile_rows, tile_cols);
+            }
         }
-    }
+    });
     return result;
 }
+
+// 行列をその場で転置する関数
+// 正方行列は対角線を挟んだタイルの組を入れ替える
+template <class T>
+void transpose_in_place(BasicMatrix<T>& arg) {
+    int n = arg.rows();
+    if (n != arg.cols()) {
+        arg = transpose(arg);
+        return;
+    }
+    T* values = arg.get_values();
+    int tiles = (n + kTransposeTile - 1) / kTransposeTile;
+    parallel_for(0, tiles, row_grain(n * kTransposeTile), [&](int begin, int end) {
+        for (int ti = begin; ti < end; ti++) {
+            int i0 = ti * kTransposeTile;
+            int i1 = std::min(i0 + kTransposeTile, n);
+            // 対角タイル
+            for (int i = i0; i < i1; i++) {
+                for (int j = i + 1; j < i1; j++) {
+                    std::swap(values[i * n + j], values[j * n + i]);
+                }
+            }
+            // 右側のタイルと、対応する下側のタイルを入れ替える
+            for (int j0 = i1; j0 < n; j0 += kTransposeTile) {
+                int j1 = std::min(j0 + kTransposeTile, n);
+                for (int i = i0; i < i1; i++) {
+                    for (int j = j0; j < j1; j++) {
+                        std::swap(values[i * n + j], values[j * n + i]);
+                    }
+                }
+            }
+        }
+    });
+}
+
+// 転置行列のビューを返す関数
+template <class T>
+BasicTransposedMatrix<T> transposed(const BasicMatrix<T>& arg) { return BasicTransposedMatrix<T>(arg); }
+
+// 転置する行列を指定するコンストラクタ
+template <class T>
+BasicTransposedMatrix<T>::BasicTransposedMatrix(const BasicMatrix<T>& matrix) : matrix_(&matrix) {}
+
+// 行数（元の行列の列数）を取得するメソッド
+template <class T>
+int BasicTransposedMatrix<T>::rows(void) const { return matrix_->cols(); }
+
+// 列数（元の行列の行数）を取得するメソッド
+template <class T>
+int BasicTransposedMatrix<T>::cols(void) const { return matrix_->rows(); }
+
+// 要素にアクセスする演算子
+template <class T>
+T BasicTransposedMatrix<T>::operator()(int row, int col) const { return (*matrix_)(col, row); }
+
+// 転置する前の行列を取得するメソッド
+template <class T>
+const BasicMatrix<T>& BasicTransposedMatrix<T>::matrix(void) const { return *matrix_; }
+
+// ビューとベクトルの乗算演算子
+Vector operator*(const MatrixView& lhs, const VectorView& rhs) { return matrix_vector_kernel(lhs, rhs); }
+FloatVector operator*(const FloatMatrixView& lhs, const FloatVectorView& rhs) { return matrix_vector_kernel(lhs, rhs); }
+
+// ビュー（転置行列を含む）同士の乗算演算子
+Matrix operator*(const MatrixView& lhs, const MatrixView& rhs) { return matrix_product_kernel(lhs, rhs); }
+FloatMatrix operator*(const FloatMatrixView& lhs, const FloatMatrixView& rhs) { return matrix_product_kernel(lhs, rhs); }
+
+// ビュー（転置行列を含む）に対する gemm
+void gemm(double alpha, const MatrixView& A, const MatrixView& B, double beta, const MatrixView& C) { gemm_kernel(alpha, A, B, beta, C); }
+void gemm(double alpha, const FloatMatrixView& A, const FloatMatrixView& B, double beta, const FloatMatrixView& C) { gemm_kernel(alpha, A, B, beta, C); }
+
+// y = alpha * A * x + beta * y を計算する関数
+void gemv(double alpha, const MatrixView& A, const VectorView& x, double beta, const VectorView& y) { gemv_kernel(alpha, A, x, beta, y); }
+void gemv(double alpha, const FloatMatrixView& A, const FloatVectorView& x, double beta, const FloatVectorView& y) { gemv_kernel(alpha, A, x, beta, y); }
+
+// 倍精度と単精度で実体化する
+template class BasicMatrix<double>;
+template class BasicMatrix<float>;
+template class BasicTransposedMatrix<double>;
+template class BasicTransposedMatrix<float>;
+template std::ostream& operator<<(std::ostream&, const BasicMatrix<double>&);
+template std::ostream& operator<<(std::ostream&, const BasicMatrix<float>&);
+template BasicVector<double> operator*(const BasicMatrix<double>&, const BasicVector<double>&);
+template BasicVector<float> operator*(const BasicMatrix<float>&, const BasicVector<float>&);
+template BasicMatrix<double> operator*(const BasicMatrix<double>&, const BasicMatrix<double>&);
+template BasicMatrix<float> operator*(const BasicMatrix<float>&, const BasicMatrix<float>&);
+template BasicMatrix<double> operator+(BasicMatrix<double>&&, BasicMatrix<double>&&);
+template BasicMatrix<float> operator+(BasicMatrix<float>&&, BasicMatrix<float>&&);
+template BasicMatrix<double> operator-(BasicMatrix<double>&&, BasicMatrix<double>&&);
+template BasicMatrix<float> operator-(BasicMatrix<float>&&, BasicMatrix<float>&&);
+template BasicMatrix<double> operator*(double, BasicMatrix<double>&&);
+template BasicMatrix<float> operator*(double, BasicMatrix<float>&&);
+template BasicMatrix<double> operator/(BasicMatrix<double>&&, double);
+template BasicMatrix<float> operator/(BasicMatrix<float>&&, double);
+template BasicMatrix<double> operator-(BasicMatrix<double>&&);
+template BasicMatrix<float> operator-(BasicMatrix<float>&&);
+template void gemm(double, const BasicMatrix<double>&, const BasicMatrix<double>&, double, BasicMatrix<double>&);
+template void gemm(double, const BasicMatrix<float>&, const BasicMatrix<float>&, double, BasicMatrix<float>&);
+template bool operator==(const BasicMatrix<double>&, const BasicMatrix<double>&);
+template bool operator==(const BasicMatrix<float>&, const BasicMatrix<float>&);
+template bool operator!=(const BasicMatrix<double>&, const BasicMatrix<double>&);
+template bool operator!=(const BasicMatrix<float>&, const BasicMatrix<float>&);
+template double squared_sum(const BasicMatrix<double>&);
+template double squared_sum(const BasicMatrix<float>&);
+template double frobenius_norm(const BasicMatrix<double>&);
+template double frobenius_norm(const BasicMatrix<float>&);
+template BasicMatrix<double> transpose(const BasicMatrix<double>&);
+template BasicMatrix<float> transpose(const BasicMatrix<float>&);
+template void transpose_in_place(BasicMatrix<double>&);
+template void transpose_in_place(BasicMatrix<float>&);
+template BasicTransposedMatrix<double> transposed(const BasicMatrix<double>&);
+template BasicTransposedMatrix<float> transposed(const BasicMatrix<float>&);
@@ -1,45 +1,240 @@
+#include <type_traits> // 型特性の標準ライブラリ
+
+#include "matrix_expression.h"
+#include "matrix_view.h"
+#include "thread_pool.h"
 #include "vector.h"
 
 #ifndef __MATRIX__
 #define __MATRIX__
 
-class Matrix {
+// 要素の型 T（float または double）を指定する行列
+// float の場合も行列積や平方和の累積は倍精度で計算する
+template <class T>
+class BasicMatrix : public MatrixExpression<BasicMatrix<T> > {
    private:
     int rows_;       // 行数
     int cols_;       // 列数
-    double *values_; // 値を保持する配列
+    T *values_;      // 値を保持する配列（64バイト境界に揃えて確保する）
 
    public:
-    Matrix(int rows, int cols);            // 行数と列数を指定するコンストラクタ
-    Matrix(int rows, int cols, double arg); // 行数、列数、および初期値を指定するコンストラクタ
-    Matrix(void);                           // デフォルトコンストラクタ
-    Matrix(const Matrix &arg);              // コピーコンストラクタ
-    Matrix &operator=(const Matrix &rhs);   // 代入演算子
-    ~Matrix(void);                          // デストラクタ
+    BasicMatrix(int rows, int cols);        // 行数と列数を指定するコンストラクタ
+    BasicMatrix(int rows, int cols, double arg); // 行数、列数、および初期値を指定するコンストラクタ
+    BasicMatrix(void);                      // デフォルトコンストラクタ
+    BasicMatrix(const BasicMatrix &arg);    // コピーコンストラクタ
+    BasicMatrix(BasicMatrix &&arg);         // ムーブコンストラクタ
+    explicit BasicMatrix(const BasicMatrixView<T> &arg); // ビューの要素をコピーするコンストラクタ（暗黙にはコピーしない）
+    template <class E, class = typename std::enable_if<!ExplicitMatrixCopy<E>::value>::type>
+    BasicMatrix(const MatrixExpression<E> &expr); // 式を評価して構築するコンストラクタ
+    BasicMatrix &operator=(const BasicMatrix &rhs); // 代入演算子
+    BasicMatrix &operator=(BasicMatrix &&rhs); // ムーブ代入演算子
+    template <class E>
+    BasicMatrix &operator=(const MatrixExpression<E> &rhs); // 式を評価して代入する演算子
+    ~BasicMatrix(void);                     // デストラクタ
     int rows(void) const;                   // 行数を取得するメソッド
     int cols(void) const;                   // 列数を取得するメソッド
-    double &operator()(int row, int col);   // 要素にアクセスする演算子（非const版）
-    double operator()(int row, int col) const; // 要素にアクセスする演算子（const版）
-    Vector operator[](int row);             // 行にアクセスする演算子
-    Matrix operator+(void) const;           // 単項プラス演算子
-    Matrix operator-(void) const;           // 単項マイナス演算子
-    Matrix &operator+=(const Matrix &rhs);  // 加算代入演算子
-    Matrix &operator-=(const Matrix &rhs);  // 減算代入演算子
+    T &operator()(int row, int col);        // 要素にアクセスする演算子（非const版）
+    T operator()(int row, int col) const;   // 要素にアクセスする演算子（const版）
+    double eval(int index) const { return values_[index]; } // 式テンプレートから要素を読み出すメソッド
+    BasicVector<T> operator[](int row);     // 行にアクセスする演算子
+    BasicVectorView<T> row(int row);        // 行を指すビューを返すメソッド
+    BasicVectorView<T> col(int col);        // 列を指すビューを返すメソッド
+    BasicMatrixView<T> row_range(int begin, int end); // [begin, end) 行を指すビューを返すメソッド
+    BasicMatrixView<T> block(int row, int col, int rows, int cols); // (row, col) から rows x cols のブロックを指すビューを返すメソッド
+    BasicMatrix &operator+=(const BasicMatrix &rhs); // 加算代入演算子
+    BasicMatrix &operator-=(const BasicMatrix &rhs); // 減算代入演算子
+    template <class E>
+    BasicMatrix &operator+=(const MatrixExpression<E> &rhs); // 式の加算代入演算子
+    template <class E>
+    BasicMatrix &operator-=(const MatrixExpression<E> &rhs); // 式の減算代入演算子
     std::ostream &print(std::ostream &lhs) const; // 行列を出力するメソッド
-    double *get_values();                   // データへのポインタを取得するメソッド
+    T *get_values();                        // データへのポインタを取得するメソッド
+    const T *get_values() const;            // データへのポインタを取得するメソッド（const版）
 };
 
+typedef BasicMatrix<double> Matrix;
+typedef BasicMatrix<float> FloatMatrix;
+
+// 転置行列のビュー（値はコピーせず、元の行列を参照する）
+// MatrixView に暗黙に変換されるので、行列積、行列とベクトルの積、SparseMatrix::product にそのまま渡せる
+template <class T>
+class BasicTransposedMatrix {
+   private:
+    const BasicMatrix<T> *matrix_; // 転置する前の行列
+
+   public:
+    explicit BasicTransposedMatrix(const BasicMatrix<T> &matrix); // 転置する行列を指定するコンストラクタ
+    int rows(void) const;                   // 行数（元の行列の列数）を取得するメソッド
+    int cols(void) const;                   // 列数（元の行列の行数）を取得するメソッド
+    T operator()(int row, int col) const;   // 要素にアクセスする演算子
+    const BasicMatrix<T> &matrix(void) const; // 転置する前の行列を取得するメソッド
+};
+
+typedef BasicTransposedMatrix<double> TransposedMatrix;
+typedef BasicTransposedMatrix<float> FloatTransposedMatrix;
+
 // 非メンバー関数の宣言
-std::ostream &operator<<(std::ostream &lhs, const Matrix &rhs); // 行列の出力演算子
-Matrix operator+(const Matrix &lhs, const Matrix &rhs); // 行列の加算演算子
-Matrix operator-(const Matrix &lhs, const Matrix &rhs); // 行列の減算演算子
-Vector operator*(const Matrix &lhs, const Vector &rhs); // 行列とベクトルの乗算演算子
-Matrix operator*(Matrix &lhs, Matrix &rhs);             // 行列同士の乗算演算子
-bool operator==(const Matrix &lhs, const Matrix &rhs);  // 行列の等価比較演算子
-bool operator!=(const Matrix &lhs, const Matrix &rhs);  // 行列の不等価比較演算子
-Matrix operator*(double factor, const Matrix &rhs);     // スカラー倍の行列演算子
-double squared_sum(const Matrix &arg);                  // 行列の平方和を計算する関数
-double frobenius_norm(const Matrix &arg);               // フロベニウスノルムを計算する関数
-Matrix transpose(Matrix &arg);                          // 行列の転置を計算する関数
+// 加算、減算、スカラー倍、スカラー除算の演算子は matrix_expression.h の式テンプレートで定義する
+template <class T>
+std::ostream &operator<<(std::ostream &lhs, const BasicMatrix<T> &rhs); // 行列の出力演算子
+template <class T>
+BasicVector<T> operator*(const BasicMatrix<T> &lhs, const BasicVector<T> &rhs); // 行列とベクトルの乗算演算子
+template <class T>
+BasicMatrix<T> operator*(const BasicMatrix<T> &lhs, const BasicMatrix<T> &rhs); // 行列同士の乗算演算子
+template <class T>
+BasicMatrix<T> operator+(BasicMatrix<T> &&lhs, BasicMatrix<T> &&rhs); // 行列の加算演算子（右辺値同士）
+template <class T>
+BasicMatrix<T> operator-(BasicMatrix<T> &&lhs, BasicMatrix<T> &&rhs); // 行列の減算演算子（右辺値同士）
+template <class T>
+BasicMatrix<T> operator*(double factor, BasicMatrix<T> &&rhs); // スカラー倍の行列演算子（右辺値）
+template <class T>
+BasicMatrix<T> operator/(BasicMatrix<T> &&lhs, double factor); // スカラー除算の行列演算子（右辺値）
+template <class T>
+BasicMatrix<T> operator-(BasicMatrix<T> &&arg);     // 単項マイナス演算子（右辺値）
+template <class T>
+void gemm(double alpha, const BasicMatrix<T> &A, const BasicMatrix<T> &B, double beta, BasicMatrix<T> &C); // C = alpha * A * B + beta * C を計算する関数
+template <class T>
+bool operator==(const BasicMatrix<T> &lhs, const BasicMatrix<T> &rhs); // 行列の等価比較演算子
+template <class T>
+bool operator!=(const BasicMatrix<T> &lhs, const BasicMatrix<T> &rhs); // 行列の不等価比較演算子
+template <class T>
+double squared_sum(const BasicMatrix<T> &arg);      // 行列の平方和を計算する関数
+template <class T>
+double frobenius_norm(const BasicMatrix<T> &arg);   // フロベニウスノルムを計算する関数
+template <class T>
+BasicMatrix<T> transpose(const BasicMatrix<T> &arg); // 行列の転置を計算する関数（タイル単位でコピーする）
+template <class T>
+void transpose_in_place(BasicMatrix<T> &arg);       // 行列をその場で転置する関数（正方行列以外は新しい領域に転置する）
+template <class T>
+BasicTransposedMatrix<T> transposed(const BasicMatrix<T> &arg); // 転置行列のビューを返す関数
+
+// ビュー（転置行列を含む）を受け取る演算は、ビューへの変換を使うため double 版と float 版をそれぞれ非テンプレートの関数として宣言する
+Matrix operator*(const MatrixView &lhs, const MatrixView &rhs); // ビュー（転置行列を含む）同士の乗算演算子
+FloatMatrix operator*(const FloatMatrixView &lhs, const FloatMatrixView &rhs);
+Vector operator*(const MatrixView &lhs, const VectorView &rhs); // ビューとベクトルの乗算演算子
+FloatVector operator*(const FloatMatrixView &lhs, const FloatVectorView &rhs);
+void gemm(double alpha, const MatrixView &A, const MatrixView &B, double beta, const MatrixView &C); // ビュー（転置行列を含む）に対する gemm
+void gemm(double alpha, const FloatMatrixView &A, const FloatMatrixView &B, double beta, const FloatMatrixView &C);
+void gemv(double alpha, const MatrixView &A, const VectorView &x, double beta, const VectorView &y); // y = alpha * A * x + beta * y を計算する関数
+void gemv(double alpha, const FloatMatrixView &A, const FloatVectorView &x, double beta, const FloatVectorView &y);
+
+// 評価が必要な式のノード（Matrix、ビュー、固定長行列以外）かどうか
+template <class E>
+struct IsMatrixNode {
+    static const bool value = !ExplicitMatrixCopy<E>::value;
+};
+template <class T>
+struct IsMatrixNode<BasicMatrix<T> > {
+    static const bool value = false;
+};
+
+// 式との積は、式を倍精度の Matrix、Vector に評価してから計算する
+template <class L, class R, class = typename std::enable_if<IsMatrixNode<L>::value || IsVectorNode<R>::value>::type>
+Vector operator*(const MatrixExpression<L> &lhs, const VectorExpression<R> &rhs) {
+    return Matrix(lhs.self()) * Vector(rhs.self());
+}
+template <class L, class R, class = typename std::enable_if<IsMatrixNode<L>::value || IsMatrixNode<R>::value>::type>
+Matrix operator*(const MatrixExpression<L> &lhs, const MatrixExpression<R> &rhs) {
+    return Matrix(lhs.self()) * Matrix(rhs.self());
+}
+
+// 右辺値の行列との演算は、その領域を再利用して結果を書き込む
+// 行列の加算演算子（左辺が右辺値）
+template <class T, class R>
+BasicMatrix<T> operator+(BasicMatrix<T> &&lhs, const MatrixExpression<R> &rhs) {
+    lhs += rhs;
+    return std::move(lhs);
+}
+
+// 行列の加算演算子（右辺が右辺値）
+template <class L, class T>
+BasicMatrix<T> operator+(const MatrixExpression<L> &lhs, BasicMatrix<T> &&rhs) {
+    rhs += lhs;
+    return std::move(rhs);
+}
+
+// 行列の減算演算子（左辺が右辺値）
+template <class T, class R>
+BasicMatrix<T> operator-(BasicMatrix<T> &&lhs, const MatrixExpression<R> &rhs) {
+    lhs -= rhs;
+    return std::move(lhs);
+}
+
+// 行列の減算演算子（右辺が右辺値）
+template <class L, class T>
+BasicMatrix<T> operator-(const MatrixExpression<L> &lhs, BasicMatrix<T> &&rhs) {
+    rhs = lhs - rhs;
+    return std::move(rhs);
+}
+
+// 式を評価して構築するコンストラクタ
+template <class T>
+template <class E, class>
+BasicMatrix<T>::BasicMatrix(const MatrixExpression<E> &expr) : rows_(expr.rows()), cols_(expr.cols()), values_(simd_alloc<T>(expr.rows() * expr.cols())) {
+    const E &arg = expr.self();
+    T *values = values_;
+    parallel_for(0, rows_ * cols_, kParallelGrain, [&arg, values](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            values[i] = arg.eval(i);
+        }
+    });
+}
+
+// 式を評価して代入する演算子
+template <class T>
+template <class E>
+BasicMatrix<T> &BasicMatrix<T>::operator=(const MatrixExpression<E> &rhs) {
+    const E &arg = rhs.self();
+    if (rows_ != arg.rows() || cols_ != arg.cols()) {
+        simd_free(values_);
+        rows_ = arg.rows();
+        cols_ = arg.cols();
+        values_ = simd_alloc<T>(rows_ * cols_);
+    }
+    // 要素ごとの演算なので、右辺が自分自身を参照していても1回のループで評価できる
+    T *values = values_;
+    parallel_for(0, rows_ * cols_, kParallelGrain, [&arg, values](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            values[i] = arg.eval(i);
+        }
+    });
+    return *this;
+}
+
+// 式の加算代入演算子
+template <class T>
+template <class E>
+BasicMatrix<T> &BasicMatrix<T>::operator+=(const MatrixExpression<E> &rhs) {
+    const E &arg = rhs.self();
+    if (rows_ != arg.rows() || cols_ != arg.cols()) {
+        std::cerr << "Matrix::operator+=: Size Unmatched" << std::endl;
+        exit(1);
+    }
+    T *values = values_;
+    parallel_for(0, rows_ * cols_, kParallelGrain, [&arg, values](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            values[i] += arg.eval(i);
+        }
+    });
+    return *this;
+}
+
+// 式の減算代入演算子
+template <class T>
+template <class E>
+BasicMatrix<T> &BasicMatrix<T>::operator-=(const MatrixExpression<E> &rhs) {
+    const E &arg = rhs.self();
+    if (rows_ != arg.rows() || cols_ != arg.cols()) {
+        std::cerr << "Matrix::operator-=: Size Unmatched" << std::endl;
+        exit(1);
+    }
+    T *values = values_;
+    parallel_for(0, rows_ * cols_, kParallelGrain, [&arg, values](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            values[i] -= arg.eval(i);
+        }
+    });
+    return *this;
+}
 
 #endif
\ No newline at end of file
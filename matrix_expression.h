@@ -0,0 +1,125 @@
+#include "vector_expression.h"
+
+#ifndef __MATRIX_EXPRESSION__
+#define __MATRIX_EXPRESSION__
+
+template <class T>
+class BasicMatrix;
+
+// 行列の式テンプレートの基底クラス（CRTP）
+// 要素は行優先の通し番号 eval(row * cols + col) で読み出す
+template <class E>
+class MatrixExpression {
+   public:
+    const E& self(void) const { return static_cast<const E&>(*this); }
+    int rows(void) const { return self().rows(); }
+    int cols(void) const { return self().cols(); }
+    double eval(int index) const { return self().eval(index); }
+};
+
+// Matrix への変換（要素のコピー）を明示的に書かせる式（ビューや固定長行列）
+template <class E>
+struct ExplicitMatrixCopy {
+    static const bool value = false;
+};
+
+// 式のオペランドの保持方法（Matrixは参照で、式は値で保持する）
+template <class E>
+struct MatrixOperand {
+    typedef const E type;
+};
+template <class T>
+struct MatrixOperand<BasicMatrix<T> > {
+    typedef const BasicMatrix<T>& type;
+};
+
+// 二項演算の式
+template <class L, class R, class Op>
+class MatrixBinary : public MatrixExpression<MatrixBinary<L, R, Op> > {
+   private:
+    typename MatrixOperand<L>::type lhs_;  // 左辺
+    typename MatrixOperand<R>::type rhs_;  // 右辺
+
+   public:
+    MatrixBinary(const L& lhs, const R& rhs) : lhs_(lhs), rhs_(rhs) {}
+    int rows(void) const { return lhs_.rows(); }
+    int cols(void) const { return lhs_.cols(); }
+    double eval(int index) const { return Op::apply(lhs_.eval(index), rhs_.eval(index)); }
+};
+
+// スカラーとの演算の式
+template <class E, class Op>
+class MatrixScalar : public MatrixExpression<MatrixScalar<E, Op> > {
+   private:
+    typename MatrixOperand<E>::type arg_;  // 行列側の式
+    double scalar_;                        // スカラー
+
+   public:
+    MatrixScalar(const E& arg, double scalar) : arg_(arg), scalar_(scalar) {}
+    int rows(void) const { return arg_.rows(); }
+    int cols(void) const { return arg_.cols(); }
+    double eval(int index) const { return Op::apply(arg_.eval(index), scalar_); }
+};
+
+// 符号反転の式
+template <class E>
+class MatrixNegate : public MatrixExpression<MatrixNegate<E> > {
+   private:
+    typename MatrixOperand<E>::type arg_;  // 反転する式
+
+   public:
+    explicit MatrixNegate(const E& arg) : arg_(arg) {}
+    int rows(void) const { return arg_.rows(); }
+    int cols(void) const { return arg_.cols(); }
+    double eval(int index) const { return -arg_.eval(index); }
+};
+
+// 行列の加算演算子
+template <class L, class R>
+MatrixBinary<L, R, AddOp> operator+(const MatrixExpression<L>& lhs, const MatrixExpression<R>& rhs) {
+    if (lhs.rows() != rhs.rows() || lhs.cols() != rhs.cols()) {
+        std::cerr << "operator+(const Matrix &, const Matrix &): Size Unmatched" << std::endl;
+        exit(1);
+    }
+    return MatrixBinary<L, R, AddOp>(lhs.self(), rhs.self());
+}
+
+// 行列の減算演算子
+template <class L, class R>
+MatrixBinary<L, R, SubtractOp> operator-(const MatrixExpression<L>& lhs, const MatrixExpression<R>& rhs) {
+    if (lhs.rows() != rhs.rows() || lhs.cols() != rhs.cols()) {
+        std::cerr << "operator-(const Matrix &, const Matrix &): Size Unmatched" << std::endl;
+        exit(1);
+    }
+    return MatrixBinary<L, R, SubtractOp>(lhs.self(), rhs.self());
+}
+
+// スカラー倍の行列演算子
+template <class E>
+MatrixScalar<E, ScaleOp> operator*(double factor, const MatrixExpression<E>& rhs) {
+    if (rhs.rows() == 0 || rhs.cols() == 0) {
+        std::cerr << "operator*(double , const Matrix &): Size unmatched" << std::endl;
+        exit(1);
+    }
+    return MatrixScalar<E, ScaleOp>(rhs.self(), factor);
+}
+
+// スカラー除算の行列演算子
+template <class E>
+MatrixScalar<E, DivideOp> operator/(const MatrixExpression<E>& lhs, double factor) {
+    return MatrixScalar<E, DivideOp>(lhs.self(), factor);
+}
+
+// 単項プラス演算子
+template <class E>
+const E& operator+(const MatrixExpression<E>& arg) {
+    return arg.self();
+}
+
+// 単項マイナス演算子
+template <class E>
+MatrixNegate<E> operator-(const MatrixExpression<E>& arg) {
+    return MatrixNegate<E>(arg.self());
+}
+
+#endif
@@ -0,0 +1,381 @@
+#include "matrix_factorization.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <random>
+
+#include "simd.h"
+
+namespace {
+
+// Hogwild! で行の順番を混ぜる単位（連続した行をまとめて処理してキャッシュの局所性を保つ）
+const int kMfBlockRows = 64;
+
+// 非ゼロ要素 (i, j) の評価値 rating で p_i と q_j を更新し、更新前の誤差の2乗を返す
+// p_i' = (1 - ηλ) p_i + η e q_j, q_j' = (1 - ηλ) q_j + η e p_i を1回の SIMD カーネルで同時に計算する
+template <class T>
+inline double sgd_update(T* p, T* q, int factors, double rating, double learning_rate, double regularization) {
+    double e = rating - simd_dot(p, q, factors);
+    simd_coupled_axpby(1.0 - learning_rate * regularization, learning_rate * e, p, q, factors);
+    return e * e;
+}
+
+// A x = b をコレスキー分解で解き、解を b に書き込む（A は n × n の対称正定値行列で、下三角だけを使い L で上書きする）
+// K > 0 の場合は n = K としてループの長さをコンパイル時に決め、小さな行列を展開してレジスタに載せたまま計算する
+// 数値誤差で対角要素が正でなくなった場合は小さな正の値に置き換える
+template <int K>
+void cholesky_solve(double* A, double* b, int size) {
+    const int n = K > 0 ? K : size;
+    for (int j = 0; j < n; j++) {
+        double* row_j = A + j * n;
+        double d = row_j[j];
+        for (int p = 0; p < j; p++) {
+            d -= row_j[p] * row_j[p];
+        }
+        d = std::sqrt(std::max(d, 1e-12));
+        row_j[j] = d;
+        for (int i = j + 1; i < n; i++) {
+            double* row_i = A + i * n;
+            double s = row_i[j];
+            for (int p = 0; p < j; p++) {
+                s -= row_i[p] * row_j[p];
+            }
+            row_i[j] = s / d;
+        }
+    }
+    // L y = b
+    for (int i = 0; i < n; i++) {
+        const double* row_i = A + i * n;
+        double s = b[i];
+        for (int p = 0; p < i; p++) {
+            s -= row_i[p] * b[p];
+        }
+        b[i] = s / row_i[i];
+    }
+    // L^T x = y
+    for (int i = n - 1; i >= 0; i--) {
+        double s = b[i];
+        for (int p = i + 1; p < n; p++) {
+            s -= A[p * n + i] * b[p];
+        }
+        b[i] = s / A[i * n + i];
+    }
+}
+
+// 因子の数に合わせて展開したコレスキー分解を選んで A x = b を解く
+void cholesky_solve(double* A, double* b, int n) {
+    switch (n) {
+        case 4: cholesky_solve<4>(A, b, n); break;
+        case 8: cholesky_solve<8>(A, b, n); break;
+        case 16: cholesky_solve<16>(A, b, n); break;
+        case 32: cholesky_solve<32>(A, b, n); break;
+        case 64: cholesky_solve<64>(A, b, n); break;
+        default: cholesky_solve<0>(A, b, n); break;
+    }
+}
+
+}  // namespace
+
+// 学習率、正則化の係数、スケジュールを指定するコンストラクタ
+template <class T>
+BasicSgdMatrixFactorization<T>::BasicSgdMatrixFactorization(double learning_rate, double regularization, const char* schedule, unsigned seed)
+    : learning_rate_(learning_rate), regularization_(regularization), seed_(seed) {
+    if (strcmp(schedule, "hogwild") != 0 && strcmp(schedule, "dsgd") != 0) {
+        std::cerr << "SgdMatrixFactorization::SgdMatrixFactorization(double, double, const char *, unsigned): Unknown schedule " << schedule << std::endl;
+        exit(1);
+    }
+    stratified_ = strcmp(schedule, "dsgd") == 0;
+}
+
+// Hogwild! で1エポック処理し、誤差の2乗和を返す
+// 行のブロックの順番を混ぜ、ブロックを並列に処理する（同じアイテムの行を複数のスレッドがロックせずに更新することがある）
+template <class T>
+double BasicSgdMatrixFactorization<T>::hogwild_epoch(const BasicSparseMatrix<T>& ratings, T* user_factors, T* item_factors, int factors, std::vector<int>& order, int epoch) {
+    const int* row_pointers = ratings.get_row_pointers();
+    const int* col_indices = ratings.get_col_indices();
+    const T* values = ratings.get_values();
+    int rows = ratings.rows();
+    int blocks = (int)order.size();
+    std::mt19937 generator(seed_ + epoch);
+    std::shuffle(order.begin(), order.end(), generator);
+    long long work = (long long)ratings.nnz() * factors;
+    int grain = std::max(1, (int)((long long)kParallelGrain * blocks / std::max(1LL, work)));
+    return parallel_sum(0, blocks, grain, [&](int begin, int end) {
+        double sum = 0.0;
+        for (int b = begin; b < end; b++) {
+            int first = order[b] * kMfBlockRows;
+            int last = std::min(first + kMfBlockRows, rows);
+            for (int i = first; i < last; i++) {
+                T* p = user_factors + (long long)i * factors;
+                for (int k = row_pointers[i]; k < row_pointers[i + 1]; k++) {
+                    sum += sgd_update(p, item_factors + (long long)col_indices[k] * factors, factors, values[k], learning_rate_, regularization_);
+                }
+            }
+        }
+        return sum;
+    });
+}
+
+// 因子行列 P（ユーザー × 因子）と Q（アイテム × 因子）を epochs エポック更新する
+// DSGD の場合は最初に、非ゼロ要素数が揃うように行と列をブロックに分け、非ゼロ要素を（行のブロック, 列のブロック）ごとに並べた索引を作る
+// 各エポックはブロックのずらし幅 s の順番を混ぜ、s ごとに行のブロック b と列のブロック (b + s) % ブロック数 の組を並列に処理する
+template <class T>
+void BasicSgdMatrixFactorization<T>::train(const BasicSparseMatrix<T>& ratings, BasicMatrix<T>& user_factors, BasicMatrix<T>& item_factors, int epochs) {
+    if (user_factors.rows() != ratings.rows() || item_factors.rows() != ratings.cols() || user_factors.cols() != item_factors.cols()) {
+        std::cerr << "SgdMatrixFactorization::train(const SparseMatrix &, Matrix &, Matrix &, int): Size unmatched" << std::endl;
+        exit(1);
+    }
+    int rows = ratings.rows();
+    int cols = ratings.cols();
+    int nnz = ratings.nnz();
+    int factors = user_factors.cols();
+    const int* row_pointers = ratings.get_row_pointers();
+    const int* col_indices = ratings.get_col_indices();
+    const T* values = ratings.get_values();
+    T* p = user_factors.get_values();
+    T* q = item_factors.get_values();
+    losses_.clear();
+    updates_per_second_.clear();
+
+    std::vector<int> order;
+    int strata = 1;
+    std::vector<int> row_bounds;
+    std::vector<long long> bucket_offsets;
+    std::vector<int> entry_rows;
+    std::vector<int> entry_positions;
+    if (!stratified_) {
+        order.resize((rows + kMfBlockRows - 1) / kMfBlockRows);
+        for (int b = 0; b < (int)order.size(); b++) {
+            order[b] = b;
+        }
+    } else {
+        strata = get_num_threads();
+        // 非ゼロ要素数で行を等分する
+        row_bounds.resize(strata + 1);
+        for (int b = 0; b <= strata; b++) {
+            row_bounds[b] = (int)(std::lower_bound(row_pointers, row_pointers + rows + 1, (int)((long long)nnz * b / strata)) - row_pointers);
+        }
+        row_bounds[strata] = rows;
+        // 非ゼロ要素数で列を等分する
+        std::vector<long long> col_counts(cols + 1, 0);
+        for (int k = 0; k < nnz; k++) {
+            col_counts[col_indices[k] + 1]++;
+        }
+        std::vector<int> col_blocks(cols);
+        for (int j = 0; j < cols; j++) {
+            col_counts[j + 1] += col_counts[j];
+            col_blocks[j] = (int)std::min<long long>(strata - 1, col_counts[j] * strata / std::max(1, nnz));
+        }
+        // 行のブロックごとに、非ゼロ要素を列のブロックの順に並べる
+        std::vector<long long> counts((size_t)strata * strata, 0);
+        parallel_for(0, strata, 1, [&](int begin, int end) {
+            for (int b = begin; b < end; b++) {
+                for (int k = row_pointers[row_bounds[b]]; k < row_pointers[row_bounds[b + 1]]; k++) {
+                    counts[(size_t)b * strata + col_blocks[col_indices[k]]]++;
+                }
+            }
+        });
+        bucket_offsets.assign((size_t)strata * strata + 1, 0);
+        for (size_t c = 0; c < counts.size(); c++) {
+            bucket_offsets[c + 1] = bucket_offsets[c] + counts[c];
+        }
+        entry_rows.resize(nnz);
+        entry_positions.resize(nnz);
+        parallel_for(0, strata, 1, [&](int begin, int end) {
+            for (int b = begin; b < end; b++) {
+                std::vector<long long> position(bucket_offsets.begin() + (size_t)b * strata, bucket_offsets.begin() + (size_t)(b + 1) * strata);
+                for (int i = row_bounds[b]; i < row_bounds[b + 1]; i++) {
+                    for (int k = row_pointers[i]; k < row_pointers[i + 1]; k++) {
+                        long long dest = position[col_blocks[col_indices[k]]]++;
+                        entry_rows[dest] = i;
+                        entry_positions[dest] = k;
+                    }
+                }
+            }
+        });
+        order.resize(strata);
+        for (int s = 0; s < strata; s++) {
+            order[s] = s;
+        }
+    }
+
+    for (int epoch = 0; epoch < epochs; epoch++) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        double sum = 0.0;
+        if (!stratified_) {
+            sum = hogwild_epoch(ratings, p, q, factors, order, epoch);
+        } else {
+            std::mt19937 generator(seed_ + epoch);
+            std::shuffle(order.begin(), order.end(), generator);
+            for (int s = 0; s < strata; s++) {
+                int shift = order[s];
+                sum += parallel_sum(0, strata, 1, [&](int begin, int end) {
+                    double bucket_sum = 0.0;
+                    for (int b = begin; b < end; b++) {
+                        size_t bucket = (size_t)b * strata + (b + shift) % strata;
+                        for (long long e = bucket_offsets[bucket]; e < bucket_offsets[bucket + 1]; e++) {
+                            int k = entry_positions[e];
+                            bucket_sum += sgd_update(p + (long long)entry_rows[e] * factors, q + (long long)col_indices[k] * factors, factors, values[k], learning_rate_, regularization_);
+                        }
+                    }
+                    return bucket_sum;
+                });
+            }
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        losses_.push_back(nnz > 0 ? std::sqrt(sum / nnz) : 0.0);
+        updates_per_second_.push_back(seconds > 0.0 ? nnz / seconds : 0.0);
+    }
+}
+
+// エポックごとの RMSE を返す
+template <class T>
+const std::vector<double>& BasicSgdMatrixFactorization<T>::losses(void) const { return losses_; }
+
+// エポックごとの1秒あたりの更新数を返す
+template <class T>
+const std::vector<double>& BasicSgdMatrixFactorization<T>::updates_per_second(void) const { return updates_per_second_; }
+
+// エポックごとの RMSE と1秒あたりの更新数を表示する
+template <class T>
+void BasicSgdMatrixFactorization<T>::print_report(void) const {
+    for (size_t epoch = 0; epoch < losses_.size(); epoch++) {
+        std::cout << "epoch " << epoch + 1 << ": rmse " << losses_[epoch] << ", " << updates_per_second_[epoch] << " updates/s" << std::endl;
+    }
+}
+
+// 正則化の係数とフィードバックの種類を指定するコンストラクタ
+template <class T>
+BasicAlsMatrixFactorization<T>::BasicAlsMatrixFactorization(double regularization, const char* feedback, double alpha)
+    : regularization_(regularization), alpha_(alpha) {
+    if (strcmp(feedback, "explicit") != 0 && strcmp(feedback, "implicit") != 0) {
+        std::cerr << "AlsMatrixFactorization::AlsMatrixFactorization(double, const char *, double): Unknown feedback " << feedback << std::endl;
+        exit(1);
+    }
+    implicit_ = strcmp(feedback, "implicit") == 0;
+}
+
+// fixed を固定して solved の各行を解く
+// 行ごとの計算量（非ゼロ要素数 × k^2 と分解の k^3）の累積和で行を区間に分け、区間ごとに k × k の作業配列を1回だけ確保する
+// グラム行列は固定側の行を倍精度に変換してから、下三角の各行に SIMD の axpy で足し込む
+template <class T>
+void BasicAlsMatrixFactorization<T>::solve_factors(const BasicSparseMatrix<T>& ratings, const BasicMatrix<T>& fixed, BasicMatrix<T>& solved) const {
+    int rows = ratings.rows();
+    int k = fixed.cols();
+    const int* row_pointers = ratings.get_row_pointers();
+    const int* col_indices = ratings.get_col_indices();
+    const T* values = ratings.get_values();
+    const T* fixed_values = fixed.get_values();
+    T* solved_values = solved.get_values();
+
+    // 暗黙的なフィードバックでは全要素の分の Q^T Q を先に計算する
+    std::vector<double> base((size_t)k * k, 0.0);
+    if (implicit_) {
+        BasicMatrix<T> gram(k, k);
+        gemm(1.0, BasicMatrixView<T>(transposed(fixed)), BasicMatrixView<T>(fixed), 0.0, BasicMatrixView<T>(gram));
+        std::copy(gram.get_values(), gram.get_values() + (size_t)k * k, base.begin());
+    }
+    for (int a = 0; a < k; a++) {
+        base[(size_t)a * k + a] += regularization_;
+    }
+
+    // 計算量の累積和で行を区間に分ける
+    long long solve_cost = (long long)k * k * k / 3 + 1;
+    long long total = (long long)ratings.nnz() * k * k + solve_cost * rows;
+    int parts = (int)std::max(1LL, std::min<long long>(4 * get_num_threads(), total / kParallelGrain));
+    std::vector<int> part_rows(parts + 1, rows);
+    part_rows[0] = 0;
+    for (int p = 1; p < parts; p++) {
+        long long target = total * p / parts;
+        int low = part_rows[p - 1];
+        int high = rows;
+        while (low < high) {
+            int mid = low + (high - low) / 2;
+            if ((long long)row_pointers[mid] * k * k + solve_cost * mid < target) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        part_rows[p] = low;
+    }
+
+    parallel_for(0, parts, 1, [&](int begin, int end) {
+        std::vector<double> A((size_t)k * k);
+        std::vector<double> b(k);
+        std::vector<double> q(k);
+        for (int part = begin; part < end; part++) {
+            for (int i = part_rows[part]; i < part_rows[part + 1]; i++) {
+                std::copy(base.begin(), base.end(), A.begin());
+                std::fill(b.begin(), b.end(), 0.0);
+                for (int e = row_pointers[i]; e < row_pointers[i + 1]; e++) {
+                    const T* fixed_row = fixed_values + (long long)col_indices[e] * k;
+                    std::copy(fixed_row, fixed_row + k, q.begin());
+                    double r = values[e];
+                    // explicit: A += q q^T, b += r q／implicit: A += (c - 1) q q^T, b += c q（c = 1 + alpha r）
+                    double weight = implicit_ ? alpha_ * r : 1.0;
+                    double coefficient = implicit_ ? 1.0 + alpha_ * r : r;
+                    for (int a = 0; a < k; a++) {
+                        simd_axpy(weight * q[a], q.data(), A.data() + (size_t)a * k, a + 1);
+                    }
+                    simd_axpy(coefficient, q.data(), b.data(), k);
+                }
+                cholesky_solve(A.data(), b.data(), k);
+                std::copy(b.begin(), b.end(), solved_values + (long long)i * k);
+            }
+        }
+    });
+}
+
+// 因子行列 P（ユーザー × 因子）と Q（アイテム × 因子）を iterations 回交互に更新する
+// アイテムごとの方程式は評価行列の転置（最初に1回だけ作る）の行から作る
+template <class T>
+void BasicAlsMatrixFactorization<T>::train(const BasicSparseMatrix<T>& ratings, BasicMatrix<T>& user_factors, BasicMatrix<T>& item_factors, int iterations) {
+    if (user_factors.rows() != ratings.rows() || item_factors.rows() != ratings.cols() || user_factors.cols() != item_factors.cols()) {
+        std::cerr << "AlsMatrixFactorization::train(const SparseMatrix &, Matrix &, Matrix &, int): Size unmatched" << std::endl;
+        exit(1);
+    }
+    int rows = ratings.rows();
+    int nnz = ratings.nnz();
+    int k = user_factors.cols();
+    const int* row_pointers = ratings.get_row_pointers();
+    const int* col_indices = ratings.get_col_indices();
+    const T* values = ratings.get_values();
+    // 信頼度 1 + alpha r が 1 未満になると連立方程式が正定値でなくなるので、負の評価は受け付けない
+    if (implicit_ && std::any_of(values, values + nnz, [](T value) { return value < 0; })) {
+        std::cerr << "AlsMatrixFactorization::train(const SparseMatrix &, Matrix &, Matrix &, int): Negative rating in implicit feedback" << std::endl;
+        exit(1);
+    }
+    BasicSparseMatrix<T> transposed_ratings = ratings.transpose();
+    losses_.clear();
+    for (int iteration = 0; iteration < iterations; iteration++) {
+        solve_factors(ratings, item_factors, user_factors);
+        solve_factors(transposed_ratings, user_factors, item_factors);
+        const T* p = user_factors.get_values();
+        const T* q = item_factors.get_values();
+        double sum = parallel_sum(0, rows, std::max(1, (int)((long long)kParallelGrain * rows / std::max(1LL, (long long)nnz * k))), [&](int begin, int end) {
+            double partial = 0.0;
+            for (int i = begin; i < end; i++) {
+                for (int e = row_pointers[i]; e < row_pointers[i + 1]; e++) {
+                    double target = implicit_ ? 1.0 : (double)values[e];
+                    double error = target - simd_dot(p + (long long)i * k, q + (long long)col_indices[e] * k, k);
+                    partial += error * error;
+                }
+            }
+            return partial;
+        });
+        losses_.push_back(nnz > 0 ? std::sqrt(sum / nnz) : 0.0);
+    }
+}
+
+// 反復ごとの RMSE を返す
+template <class T>
+const std::vector<double>& BasicAlsMatrixFactorization<T>::losses(void) const { return losses_; }
+
+// 倍精度と単精度で実体化する
+template class BasicSgdMatrixFactorization<double>;
+template class BasicSgdMatrixFactorization<float>;
+template class BasicAlsMatrixFactorization<double>;
+template class BasicAlsMatrixFactorization<float>;
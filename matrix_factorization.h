@@ -0,0 +1,60 @@
+#include <vector>  // 可変長配列の標準ライブラリ
+
+#include "matrix.h"
+#include "sparse_matrix.h"
+
+#ifndef __MATRIX_FACTORIZATION__
+#define __MATRIX_FACTORIZATION__
+
+// 評価行列 R（ユーザー × アイテム）を R ≈ P Q^T に分解する SGD
+// 非ゼロ要素 (i, j) ごとに e = r_ij - p_i・q_j を求め、p_i と q_j を学習率と正則化で同時に更新する
+// schedule が "hogwild" の場合は行のブロックの順番を混ぜて並列に処理し、因子行列の行をロックせずに更新する
+// "dsgd" の場合は行と列をそれぞれスレッド数のブロックに分け、行のブロックも列のブロックも重ならない組を並列に処理する（更新が競合しない）
+template <class T>
+class BasicSgdMatrixFactorization {
+   private:
+    double learning_rate_;                 // 学習率
+    double regularization_;                // 正則化の係数
+    bool stratified_;                      // DSGD の層別のスケジュールを使うか
+    unsigned seed_;                        // 処理の順番を混ぜる乱数の種
+    std::vector<double> losses_;           // エポックごとの学習データの RMSE（更新前の誤差）
+    std::vector<double> updates_per_second_; // エポックごとの1秒あたりの更新数
+
+    double hogwild_epoch(const BasicSparseMatrix<T>& ratings, T* user_factors, T* item_factors, int factors, std::vector<int>& order, int epoch); // Hogwild! で1エポック処理し、誤差の2乗和を返す
+
+   public:
+    BasicSgdMatrixFactorization(double learning_rate, double regularization, const char* schedule = "hogwild", unsigned seed = 0); // 学習率、正則化の係数、スケジュールを指定するコンストラクタ
+    void train(const BasicSparseMatrix<T>& ratings, BasicMatrix<T>& user_factors, BasicMatrix<T>& item_factors, int epochs); // 因子行列 P（ユーザー × 因子）と Q（アイテム × 因子）を epochs エポック更新する
+    const std::vector<double>& losses(void) const; // 直前の train のエポックごとの RMSE を返す
+    const std::vector<double>& updates_per_second(void) const; // 直前の train のエポックごとの1秒あたりの更新数を返す
+    void print_report(void) const;         // 直前の train のエポックごとの RMSE と1秒あたりの更新数を表示する
+};
+
+typedef BasicSgdMatrixFactorization<double> SgdMatrixFactorization;
+typedef BasicSgdMatrixFactorization<float> FloatSgdMatrixFactorization;
+
+// 評価行列 R（ユーザー × アイテム）を R ≈ P Q^T に分解する交互最小二乗法（ALS）
+// Q を固定して各ユーザーの p_u を (Σ_j w_uj q_j q_j^T + λI) p_u = Σ_j c_uj q_j の解で置き換え、次に R^T で Q を同様に更新する
+// feedback が "explicit" の場合は w_uj = 1, c_uj = r_uj で、評価のある要素だけに当てはめる
+// "implicit" の場合は信頼度 1 + alpha r_uj で全要素の好み（評価があれば 1）に当てはめ、Q^T Q を先に計算して評価のある要素の分だけ補正する（評価は 0 以上であること）
+// 行ごとの k × k の連立方程式はコレスキー分解で解き、行の非ゼロ要素数に応じた計算量で行を区間に分けて並列に処理する
+template <class T>
+class BasicAlsMatrixFactorization {
+   private:
+    double regularization_;                // 正則化の係数 λ
+    bool implicit_;                        // 暗黙的なフィードバックとして扱うか
+    double alpha_;                         // 暗黙的なフィードバックの信頼度の係数
+    std::vector<double> losses_;           // 反復ごとの評価のある要素の RMSE（暗黙的なフィードバックでは好み 1 との差）
+
+    void solve_factors(const BasicSparseMatrix<T>& ratings, const BasicMatrix<T>& fixed, BasicMatrix<T>& solved) const; // fixed を固定して solved の各行を解く
+
+   public:
+    explicit BasicAlsMatrixFactorization(double regularization, const char* feedback = "explicit", double alpha = 40.0); // 正則化の係数とフィードバックの種類を指定するコンストラクタ
+    void train(const BasicSparseMatrix<T>& ratings, BasicMatrix<T>& user_factors, BasicMatrix<T>& item_factors, int iterations); // 因子行列 P（ユーザー × 因子）と Q（アイテム × 因子）を iterations 回交互に更新する
+    const std::vector<double>& losses(void) const; // 直前の train の反復ごとの RMSE を返す
+};
+
+typedef BasicAlsMatrixFactorization<double> AlsMatrixFactorization;
+typedef BasicAlsMatrixFactorization<float> FloatAlsMatrixFactorization;
+
+#endif // __MATRIX_FACTORIZATION__
@@ -0,0 +1,93 @@
+#include "matrix_view.h"
+
+#include "matrix.h"
+
+// 先頭のポインタ、大きさ、間隔を指定するコンストラクタ
+template <class T>
+BasicMatrixView<T>::BasicMatrixView(T *values, int rows, int cols, int row_stride, int col_stride)
+    : values_(values), rows_(rows), cols_(cols), row_stride_(row_stride), col_stride_(col_stride) {}
+
+// 行列全体を指すコンストラクタ
+template <class T>
+BasicMatrixView<T>::BasicMatrixView(const BasicMatrix<T> &arg)
+    : values_(const_cast<T *>(arg.get_values())), rows_(arg.rows()), cols_(arg.cols()), row_stride_(arg.cols()), col_stride_(1) {}
+
+// 転置行列を指すコンストラクタ
+template <class T>
+BasicMatrixView<T>::BasicMatrixView(const BasicTransposedMatrix<T> &arg)
+    : values_(const_cast<T *>(arg.matrix().get_values())), rows_(arg.rows()), cols_(arg.cols()), row_stride_(1), col_stride_(arg.rows()) {}
+
+// 参照先に要素をコピーする代入演算子
+template <class T>
+BasicMatrixView<T> &BasicMatrixView<T>::operator=(const BasicMatrixView &rhs) {
+    if (rows_ != rhs.rows_ || cols_ != rhs.cols_) {
+        std::cerr << "MatrixView::operator=: Size Unmatched" << std::endl;
+        exit(1);
+    }
+    for (int i = 0; i < rows_; i++) {
+        row(i) = rhs.row(i);
+    }
+    return *this;
+}
+
+// 行数を取得するメソッド
+template <class T>
+int BasicMatrixView<T>::rows(void) const { return rows_; }
+
+// 列数を取得するメソッド
+template <class T>
+int BasicMatrixView<T>::cols(void) const { return cols_; }
+
+// 行の間隔を取得するメソッド
+template <class T>
+int BasicMatrixView<T>::row_stride(void) const { return row_stride_; }
+
+// 列の間隔を取得するメソッド
+template <class T>
+int BasicMatrixView<T>::col_stride(void) const { return col_stride_; }
+
+// 先頭の要素へのポインタを取得するメソッド
+template <class T>
+T *BasicMatrixView<T>::data(void) const { return values_; }
+
+// 行を指すビューを返すメソッド
+template <class T>
+BasicVectorView<T> BasicMatrixView<T>::row(int row) const {
+    if (row < 0 || row >= rows_) {
+        std::cerr << "MatrixView::row(int): Index out of range" << std::endl;
+        exit(1);
+    }
+    return BasicVectorView<T>(values_ + row * row_stride_, cols_, col_stride_);
+}
+
+// 列を指すビューを返すメソッド
+template <class T>
+BasicVectorView<T> BasicMatrixView<T>::col(int col) const {
+    if (col < 0 || col >= cols_) {
+        std::cerr << "MatrixView::col(int): Index out of range" << std::endl;
+        exit(1);
+    }
+    return BasicVectorView<T>(values_ + col * col_stride_, rows_, row_stride_);
+}
+
+// [begin, end) 行を指すビューを返すメソッド
+template <class T>
+BasicMatrixView<T> BasicMatrixView<T>::row_range(int begin, int end) const { return block(begin, 0, end - begin, cols_); }
+
+// (row, col) から rows x cols のブロックを指すビューを返すメソッド
+template <class T>
+BasicMatrixView<T> BasicMatrixView<T>::block(int row, int col, int rows, int cols) const {
+    if (row < 0 || col < 0 || rows < 0 || cols < 0 || row + rows > rows_ || col + cols > cols_) {
+        std::cerr << "MatrixView::block(int, int, int, int): Index out of range" << std::endl;
+        exit(1);
+    }
+    return BasicMatrixView(values_ + row * row_stride_ + col * col_stride_, rows, cols, row_stride_, col_stride_);
+}
+
+// 転置を指すビューを返すメソッド
+template <class T>
+BasicMatrixView<T> BasicMatrixView<T>::transposed(void) const { return BasicMatrixView(values_, cols_, rows_, col_stride_, row_stride_); }
+
+// 倍精度と単精度で実体化する
+template class BasicMatrixView<double>;
+template class BasicMatrixView<float>;
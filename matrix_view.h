@@ -0,0 +1,77 @@
+#include "matrix_expression.h"
+#include "thread_pool.h"
+#include "vector_view.h"
+
+#ifndef __MATRIX_VIEW__
+#define __MATRIX_VIEW__
+
+template <class T>
+class BasicTransposedMatrix;
+
+// 値を所有しないストライド付きの行列（行列全体、行の範囲、矩形ブロック、転置を指す）
+// 要素 (row, col) は data()[row * row_stride() + col * col_stride()] にある
+// コピーしてもビューが複製されるだけで、代入演算子は参照先の要素に値を書き込む
+// const な Matrix から作ったビューは読み出し専用として使う
+template <class T>
+class BasicMatrixView : public MatrixExpression<BasicMatrixView<T> > {
+   private:
+    T *values_;       // 先頭の要素へのポインタ
+    int rows_;        // 行数
+    int cols_;        // 列数
+    int row_stride_;  // 隣り合う行の間隔
+    int col_stride_;  // 隣り合う列の間隔
+
+   public:
+    BasicMatrixView(T *values, int rows, int cols, int row_stride, int col_stride = 1); // 先頭のポインタ、大きさ、間隔を指定するコンストラクタ
+    BasicMatrixView(const BasicMatrix<T> &arg); // 行列全体を指すコンストラクタ
+    BasicMatrixView(const BasicTransposedMatrix<T> &arg); // 転置行列を指すコンストラクタ
+    BasicMatrixView(const BasicMatrixView &arg) = default; // ビューを複製するコピーコンストラクタ
+    BasicMatrixView &operator=(const BasicMatrixView &rhs); // 参照先に要素をコピーする代入演算子
+    template <class E>
+    BasicMatrixView &operator=(const MatrixExpression<E> &rhs); // 式を評価して参照先に書き込む演算子
+
+    int rows(void) const;                       // 行数を取得するメソッド
+    int cols(void) const;                       // 列数を取得するメソッド
+    int row_stride(void) const;                 // 行の間隔を取得するメソッド
+    int col_stride(void) const;                 // 列の間隔を取得するメソッド
+    T *data(void) const;                        // 先頭の要素へのポインタを取得するメソッド
+    T &operator()(int row, int col) const { return values_[row * row_stride_ + col * col_stride_]; } // 要素にアクセスする演算子
+    double eval(int index) const { return (*this)(index / cols_, index % cols_); } // 式テンプレートから要素を読み出すメソッド
+    BasicVectorView<T> row(int row) const;             // 行を指すビューを返すメソッド
+    BasicVectorView<T> col(int col) const;             // 列を指すビューを返すメソッド
+    BasicMatrixView row_range(int begin, int end) const; // [begin, end) 行を指すビューを返すメソッド
+    BasicMatrixView block(int row, int col, int rows, int cols) const; // (row, col) から rows x cols のブロックを指すビューを返すメソッド
+    BasicMatrixView transposed(void) const;     // 転置を指すビューを返すメソッド
+};
+
+typedef BasicMatrixView<double> MatrixView;
+typedef BasicMatrixView<float> FloatMatrixView;
+
+// Matrix への変換は明示的に書かせる
+template <class T>
+struct ExplicitMatrixCopy<BasicMatrixView<T> > {
+    static const bool value = true;
+};
+
+// 式を評価して参照先に書き込む演算子
+template <class T>
+template <class E>
+BasicMatrixView<T> &BasicMatrixView<T>::operator=(const MatrixExpression<E> &rhs) {
+    const E &arg = rhs.self();
+    if (rows_ != arg.rows() || cols_ != arg.cols()) {
+        std::cerr << "MatrixView::operator=: Size Unmatched" << std::endl;
+        exit(1);
+    }
+    const BasicMatrixView &self = *this;
+    int cols = cols_;
+    parallel_for(0, rows_, cols > 0 ? (kParallelGrain + cols - 1) / cols : kParallelGrain, [&arg, &self, cols](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            for (int j = 0; j < cols; j++) {
+                self(i, j) = arg.eval(i * cols + j);
+            }
+        }
+    });
+    return *this;
+}
+
+#endif
@@ -0,0 +1,228 @@
+#include "sell_matrix.h"
+
+#include <algorithm>
+
+namespace {
+
+// σ を kSellChunk の倍数に切り上げる（チャンクが窓をまたがないようにする）
+int round_sigma(int sigma) {
+    if (sigma < kSellChunk) return kSellChunk;
+    return (sigma + kSellChunk - 1) / kSellChunk * kSellChunk;
+}
+
+// σ 行ごとの窓の中で行を非ゼロ要素数の多い順に並べた元の行番号の列を返す
+std::vector<int> sorted_rows(const int* row_pointers, int rows, int sigma) {
+    std::vector<int> order(rows);
+    for (int i = 0; i < rows; i++) {
+        order[i] = i;
+    }
+    parallel_for(0, (rows + sigma - 1) / sigma, 1, [&](int begin, int end) {
+        for (int w = begin; w < end; w++) {
+            int first = w * sigma;
+            int last = std::min(rows, first + sigma);
+            std::stable_sort(order.begin() + first, order.begin() + last, [row_pointers](int lhs, int rhs) {
+                return row_pointers[lhs + 1] - row_pointers[lhs] > row_pointers[rhs + 1] - row_pointers[rhs];
+            });
+        }
+    });
+    return order;
+}
+
+// C の各行に beta を掛ける（beta が 0 の場合はゼロにする）
+template <class T>
+void scale_rows(double beta, const BasicMatrixView<T>& C) {
+    int cols = C.cols();
+    parallel_for(0, C.rows(), cols > 0 ? (kParallelGrain + cols - 1) / cols : kParallelGrain, [&](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            BasicVectorView<T> c_row = C.row(i);
+            if (beta == 0.0) {
+                for (int j = 0; j < cols; j++) {
+                    c_row[j] = 0.0;
+                }
+            } else if (beta != 1.0) {
+                scal(beta, c_row);
+            }
+        }
+    });
+}
+
+}  // namespace
+
+// CSR 形式の疎行列から変換するコンストラクタ
+template <class T>
+BasicSellMatrix<T>::BasicSellMatrix(const BasicSparseMatrix<T>& arg, int sigma)
+    : rows_(arg.rows()), cols_(arg.cols()), nnz_(arg.nnz()), sigma_(round_sigma(sigma)) {
+    const int* row_pointers = arg.get_row_pointers();
+    const int* col_indices = arg.get_col_indices();
+    const T* values = arg.get_values();
+    chunks_ = (rows_ + kSellChunk - 1) / kSellChunk;
+
+    std::vector<int> order = sorted_rows(row_pointers, rows_, sigma_);
+    permutation_.assign((size_t)chunks_ * kSellChunk, -1);
+    row_lengths_.assign((size_t)chunks_ * kSellChunk, 0);
+    chunk_widths_.assign(chunks_, 0);
+    chunk_pointers_.assign(chunks_ + 1, 0);
+    for (int k = 0; k < rows_; k++) {
+        permutation_[k] = order[k];
+        row_lengths_[k] = row_pointers[order[k] + 1] - row_pointers[order[k]];
+    }
+    for (int c = 0; c < chunks_; c++) {
+        int width = 0;
+        for (int r = 0; r < kSellChunk; r++) {
+            width = std::max(width, row_lengths_[c * kSellChunk + r]);
+        }
+        chunk_widths_[c] = width;
+        chunk_pointers_[c + 1] = chunk_pointers_[c] + (long long)width * kSellChunk;
+    }
+
+    // チャンクごとに列優先で詰める（埋める位置は値 0 で、列はその行の最後の列にして x の非有限値を新たに読まないようにする）
+    col_indices_.assign((size_t)chunk_pointers_[chunks_], 0);
+    values_.assign((size_t)chunk_pointers_[chunks_], T(0));
+    parallel_for(0, chunks_, std::max(1, kParallelGrain / (kSellChunk * std::max(1, nnz_ / std::max(1, rows_)))), [&](int begin, int end) {
+        for (int c = begin; c < end; c++) {
+            long long base = chunk_pointers_[c];
+            for (int r = 0; r < kSellChunk; r++) {
+                int row = permutation_[c * kSellChunk + r];
+                if (row < 0) continue;
+                int length = row_lengths_[c * kSellChunk + r];
+                for (int j = 0; j < length; j++) {
+                    col_indices_[base + (long long)j * kSellChunk + r] = col_indices[row_pointers[row] + j];
+                    values_[base + (long long)j * kSellChunk + r] = values[row_pointers[row] + j];
+                }
+                for (int j = length; length > 0 && j < chunk_widths_[c]; j++) {
+                    col_indices_[base + (long long)j * kSellChunk + r] = col_indices[row_pointers[row] + length - 1];
+                }
+            }
+        }
+    });
+}
+
+// 行数を返す
+template <class T>
+int BasicSellMatrix<T>::rows(void) const { return rows_; }
+
+// 列数を返す
+template <class T>
+int BasicSellMatrix<T>::cols(void) const { return cols_; }
+
+// 非ゼロ要素数を返す
+template <class T>
+int BasicSellMatrix<T>::nnz(void) const { return nnz_; }
+
+// 並べ替えの窓の行数を返す
+template <class T>
+int BasicSellMatrix<T>::sigma(void) const { return sigma_; }
+
+// 埋めたゼロを含めて格納している要素数を返す
+template <class T>
+long long BasicSellMatrix<T>::stored(void) const { return chunk_pointers_[chunks_]; }
+
+// ベクトル（ビューを含む）との乗算演算子
+template <class T>
+BasicVector<T> BasicSellMatrix<T>::operator*(const BasicVectorView<T>& arg) const {
+    BasicVector<T> result(rows_);
+    multiply(1.0, arg, 0.0, BasicVectorView<T>(result));
+    return result;
+}
+
+// 行列（ビュー、転置行列を含む）との乗算演算子
+template <class T>
+BasicMatrix<T> BasicSellMatrix<T>::operator*(const BasicMatrixView<T>& arg) const {
+    BasicMatrix<T> result(rows_, arg.cols());
+    multiply(1.0, arg, 0.0, BasicMatrixView<T>(result));
+    return result;
+}
+
+// y = alpha * A * x + beta * y
+// チャンクごとに kSellChunk 行分の和を倍精度の配列に持ち、j 番目の非ゼロ要素を kSellChunk 行分まとめて足し込む
+// 内側のループは長さが固定で分岐がないため、コンパイラがベクトル化（gather を含む）できる
+template <class T>
+void BasicSellMatrix<T>::multiply(double alpha, const BasicVectorView<T>& x, double beta, const BasicVectorView<T>& y) const {
+    if (x.size() != cols_ || y.size() != rows_) {
+        std::cerr << "SellMatrix::multiply(double, const VectorView &, double, const VectorView &): Size unmatched" << std::endl;
+        exit(1);
+    }
+    const int* col_indices = col_indices_.data();
+    const T* values = values_.data();
+    int grain = std::max(1, kParallelGrain / (kSellChunk * std::max(1, nnz_ / std::max(1, rows_))));
+    parallel_for(0, chunks_, grain, [&](int begin, int end) {
+        for (int c = begin; c < end; c++) {
+            double sums[kSellChunk] = {0.0};
+            long long base = chunk_pointers_[c];
+            int width = chunk_widths_[c];
+            for (int j = 0; j < width; j++) {
+                const int* chunk_cols = col_indices + base + (long long)j * kSellChunk;
+                const T* chunk_values = values + base + (long long)j * kSellChunk;
+                for (int r = 0; r < kSellChunk; r++) {
+                    sums[r] += (double)chunk_values[r] * x[chunk_cols[r]];
+                }
+            }
+            for (int r = 0; r < kSellChunk; r++) {
+                int row = permutation_[c * kSellChunk + r];
+                if (row < 0) continue;
+                // 空の行は埋めた位置だけなので、x の値によらず 0 にする
+                double sum = row_lengths_[c * kSellChunk + r] == 0 ? 0.0 : sums[r];
+                y[row] = beta == 0.0 ? alpha * sum : alpha * sum + beta * y[row];
+            }
+        }
+    });
+}
+
+// C = alpha * A * B + beta * C
+// チャンクごとに各行の非ゼロ要素について C の行に B の行を axpy で足し込む（行は並べ替え前の位置に書き込むので競合しない）
+template <class T>
+void BasicSellMatrix<T>::multiply(double alpha, const BasicMatrixView<T>& B, double beta, const BasicMatrixView<T>& C) const {
+    if (B.rows() != cols_ || C.rows() != rows_ || C.cols() != B.cols()) {
+        std::cerr << "SellMatrix::multiply(double, const MatrixView &, double, const MatrixView &): Size unmatched" << std::endl;
+        exit(1);
+    }
+    scale_rows(beta, C);
+    if (alpha == 0.0 || B.cols() == 0) return;
+    const int* col_indices = col_indices_.data();
+    const T* values = values_.data();
+    long long work = (long long)nnz_ * B.cols();
+    int grain = std::max(1LL, (long long)kParallelGrain * chunks_ / std::max(1LL, work));
+    parallel_for(0, chunks_, grain, [&](int begin, int end) {
+        for (int c = begin; c < end; c++) {
+            long long base = chunk_pointers_[c];
+            for (int r = 0; r < kSellChunk; r++) {
+                int row = permutation_[c * kSellChunk + r];
+                if (row < 0) continue;
+                BasicVectorView<T> c_row = C.row(row);
+                for (int j = 0; j < row_lengths_[c * kSellChunk + r]; j++) {
+                    long long k = base + (long long)j * kSellChunk + r;
+                    axpy(alpha * values[k], B.row(col_indices[k]), c_row);
+                }
+            }
+        }
+    });
+}
+
+// 変換した場合に格納する要素数を返す（変換はしない）
+template <class T>
+long long BasicSellMatrix<T>::stored_size(const BasicSparseMatrix<T>& arg, int sigma) {
+    const int* row_pointers = arg.get_row_pointers();
+    int rows = arg.rows();
+    std::vector<int> order = sorted_rows(row_pointers, rows, round_sigma(sigma));
+    long long stored = 0;
+    for (int first = 0; first < rows; first += kSellChunk) {
+        int width = 0;
+        for (int k = first; k < std::min(rows, first + kSellChunk); k++) {
+            width = std::max(width, row_pointers[order[k] + 1] - row_pointers[order[k]]);
+        }
+        stored += (long long)width * kSellChunk;
+    }
+    return stored;
+}
+
+// y = alpha * A * x + beta * y を計算する関数
+void spmv(double alpha, const SellMatrix& A, const VectorView& x, double beta, const VectorView& y) { A.multiply(alpha, x, beta, y); }
+void spmv(double alpha, const FloatSellMatrix& A, const FloatVectorView& x, double beta, const FloatVectorView& y) { A.multiply(alpha, x, beta, y); }
+
+// C = alpha * A * B + beta * C を計算する関数
+void spmm(double alpha, const SellMatrix& A, const MatrixView& B, double beta, const MatrixView& C) { A.multiply(alpha, B, beta, C); }
+void spmm(double alpha, const FloatSellMatrix& A, const FloatMatrixView& B, double beta, const FloatMatrixView& C) { A.multiply(alpha, B, beta, C); }
+
+// 倍精度と単精度で実体化する
+template class BasicSellMatrix<double>;
+template class BasicSellMatrix<float>;
@@ -0,0 +1,55 @@
+#include <vector>  // 可変長配列の標準ライブラリ
+
+#include "sparse_matrix.h"
+
+#ifndef __SELL_MATRIX__
+#define __SELL_MATRIX__
+
+// SELL-C-σ 形式の1チャンクの行数（AVX-512 の1レジスタ、AVX2 の2レジスタ分の倍精度）
+const int kSellChunk = 8;
+
+// SELL-C-σ（スライス ELLPACK）形式の疎行列
+// σ 行ごとの窓の中で行を非ゼロ要素数の多い順に並べ替え、kSellChunk 行ずつのチャンクに分ける
+// チャンクの中は列優先（j 番目の非ゼロ要素を kSellChunk 行分連続）で、行の長さの差はゼロで埋める
+// 同じ j の kSellChunk 行分をまとめて計算できるので、行の長さが不揃いな CSR より SpMV をベクトル化しやすい
+template <class T>
+class BasicSellMatrix {
+   private:
+    int rows_;                           // 行数
+    int cols_;                           // 列数
+    int nnz_;                            // 非ゼロ要素数（埋めたゼロを含まない）
+    int sigma_;                          // 並べ替えの窓の行数（kSellChunk の倍数）
+    int chunks_;                         // チャンク数
+    std::vector<long long> chunk_pointers_; // チャンクの先頭の位置
+    std::vector<int> chunk_widths_;      // チャンクの幅（チャンク内の最長の行の非ゼロ要素数）
+    std::vector<int> permutation_;       // 並べ替えた位置の元の行番号（埋めた行は -1）
+    std::vector<int> row_lengths_;       // 並べ替えた位置の行の非ゼロ要素数
+    std::vector<int> col_indices_;       // 列インデックス（埋めた位置はその行の最後の列、空の行は 0）
+    std::vector<T> values_;              // 値（埋めた位置は 0）
+
+   public:
+    explicit BasicSellMatrix(const BasicSparseMatrix<T>& arg, int sigma = 256); // CSR 形式の疎行列から変換するコンストラクタ
+    int rows(void) const;                // 行数を返す
+    int cols(void) const;                // 列数を返す
+    int nnz(void) const;                 // 非ゼロ要素数を返す
+    int sigma(void) const;               // 並べ替えの窓の行数を返す
+    long long stored(void) const;        // 埋めたゼロを含めて格納している要素数を返す
+    BasicVector<T> operator*(const BasicVectorView<T>& arg) const; // ベクトル（ビューを含む）との乗算演算子
+    BasicMatrix<T> operator*(const BasicMatrixView<T>& arg) const; // 行列（ビュー、転置行列を含む）との乗算演算子
+    void multiply(double alpha, const BasicVectorView<T>& x, double beta, const BasicVectorView<T>& y) const; // y = alpha * A * x + beta * y
+    void multiply(double alpha, const BasicMatrixView<T>& B, double beta, const BasicMatrixView<T>& C) const; // C = alpha * A * B + beta * C
+    static long long stored_size(const BasicSparseMatrix<T>& arg, int sigma = 256); // 変換した場合に格納する要素数を返す（変換はしない）
+};
+
+typedef BasicSellMatrix<double> SellMatrix;
+typedef BasicSellMatrix<float> FloatSellMatrix;
+
+// y = alpha * A * x + beta * y を計算する関数（x と y は重ならないこと）
+void spmv(double alpha, const SellMatrix& A, const VectorView& x, double beta, const VectorView& y);
+void spmv(double alpha, const FloatSellMatrix& A, const FloatVectorView& x, double beta, const FloatVectorView& y);
+
+// C = alpha * A * B + beta * C を計算する関数
+void spmm(double alpha, const SellMatrix& A, const MatrixView& B, double beta, const MatrixView& C);
+void spmm(double alpha, const FloatSellMatrix& A, const FloatMatrixView& B, double beta, const FloatMatrixView& C);
+
+#endif // __SELL_MATRIX__
@@ -0,0 +1,289 @@
+#include "simd.h"
+#include "simd_register.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <new>
+
+#if defined(_WIN32)
+#include <malloc.h>
+#endif
+
+// 64バイト境界に揃えた領域を確保する関数
+void* simd_alloc_bytes(size_t bytes) {
+    if (bytes == 0) return nullptr;
+    void* p = nullptr;
+#if defined(_WIN32)
+    p = _aligned_malloc(bytes, kSimdAlignment);
+#else
+    if (posix_memalign(&p, kSimdAlignment, bytes) != 0) p = nullptr;
+#endif
+    if (p == nullptr) throw std::bad_alloc();
+    return p;
+}
+
+// simd_alloc で確保した領域を解放する関数
+void simd_free(void* p) {
+#if defined(_WIN32)
+    _aligned_free(p);
+#else
+    free(p);
+#endif
+}
+
+namespace {
+
+typedef SimdRegister Simd;
+typedef Simd::reg reg;
+const int W = Simd::width;
+
+// 各カーネルは double と float の配列に対して実体化する
+// float の要素は読み込み時に倍精度に変換し、計算と累積はすべて倍精度で行う
+
+// 内積（4アキュムレータ）
+template <class T>
+double dot_kernel(const T* x, const T* y, int n) {
+    reg s0 = Simd::zero(), s1 = Simd::zero(), s2 = Simd::zero(), s3 = Simd::zero();
+    int i = 0;
+    for (; i + 4 * W <= n; i += 4 * W) {
+        s0 = Simd::fmadd(Simd::load(x + i), Simd::load(y + i), s0);
+        s1 = Simd::fmadd(Simd::load(x + i + W), Simd::load(y + i + W), s1);
+        s2 = Simd::fmadd(Simd::load(x + i + 2 * W), Simd::load(y + i + 2 * W), s2);
+        s3 = Simd::fmadd(Simd::load(x + i + 3 * W), Simd::load(y + i + 3 * W), s3);
+    }
+    for (; i + W <= n; i += W) {
+        s0 = Simd::fmadd(Simd::load(x + i), Simd::load(y + i), s0);
+    }
+    double result = Simd::sum(Simd::add(Simd::add(s0, s1), Simd::add(s2, s3)));
+    for (; i < n; i++) {
+        result += (double)x[i] * y[i];
+    }
+    return result;
+}
+
+// 絶対値の和
+template <class T>
+double sum_abs_kernel(const T* x, int n) {
+    reg s0 = Simd::zero(), s1 = Simd::zero(), s2 = Simd::zero(), s3 = Simd::zero();
+    int i = 0;
+    for (; i + 4 * W <= n; i += 4 * W) {
+        s0 = Simd::add(s0, Simd::abs(Simd::load(x + i)));
+        s1 = Simd::add(s1, Simd::abs(Simd::load(x + i + W)));
+        s2 = Simd::add(s2, Simd::abs(Simd::load(x + i + 2 * W)));
+        s3 = Simd::add(s3, Simd::abs(Simd::load(x + i + 3 * W)));
+    }
+    for (; i + W <= n; i += W) {
+        s0 = Simd::add(s0, Simd::abs(Simd::load(x + i)));
+    }
+    double result = Simd::sum(Simd::add(Simd::add(s0, s1), Simd::add(s2, s3)));
+    for (; i < n; i++) {
+        result += fabs(x[i]);
+    }
+    return result;
+}
+
+// 絶対値の最大値
+template <class T>
+double max_abs_kernel(const T* x, int n) {
+    reg m0 = Simd::zero(), m1 = Simd::zero(), m2 = Simd::zero(), m3 = Simd::zero();
+    int i = 0;
+    for (; i + 4 * W <= n; i += 4 * W) {
+        m0 = Simd::max(m0, Simd::abs(Simd::load(x + i)));
+        m1 = Simd::max(m1, Simd::abs(Simd::load(x + i + W)));
+        m2 = Simd::max(m2, Simd::abs(Simd::load(x + i + 2 * W)));
+        m3 = Simd::max(m3, Simd::abs(Simd::load(x + i + 3 * W)));
+    }
+    for (; i + W <= n; i += W) {
+        m0 = Simd::max(m0, Simd::abs(Simd::load(x + i)));
+    }
+    double result = Simd::max_element(Simd::max(Simd::max(m0, m1), Simd::max(m2, m3)));
+    for (; i < n; i++) {
+        double tmp = fabs(x[i]);
+        if (result < tmp) result = tmp;
+    }
+    return result;
+}
+
+// y += x
+template <class T>
+void add_kernel(T* y, const T* x, int n) {
+    int i = 0;
+    for (; i + W <= n; i += W) {
+        Simd::store(y + i, Simd::add(Simd::load(y + i), Simd::load(x + i)));
+    }
+    for (; i < n; i++) {
+        y[i] += x[i];
+    }
+}
+
+// y -= x
+template <class T>
+void sub_kernel(T* y, const T* x, int n) {
+    int i = 0;
+    for (; i + W <= n; i += W) {
+        Simd::store(y + i, Simd::sub(Simd::load(y + i), Simd::load(x + i)));
+    }
+    for (; i < n; i++) {
+        y[i] -= x[i];
+    }
+}
+
+// y += alpha * x
+template <class T>
+void axpy_kernel(double alpha, const T* x, T* y, int n) {
+    reg a = Simd::set1(alpha);
+    int i = 0;
+    for (; i + W <= n; i += W) {
+        Simd::store(y + i, Simd::fmadd(a, Simd::load(x + i), Simd::load(y + i)));
+    }
+    for (; i < n; i++) {
+        y[i] += alpha * x[i];
+    }
+}
+
+// y = alpha * x + beta * y
+template <class T>
+void axpby_kernel(double alpha, const T* x, double beta, T* y, int n) {
+    reg a = Simd::set1(alpha);
+    reg b = Simd::set1(beta);
+    int i = 0;
+    for (; i + W <= n; i += W) {
+        Simd::store(y + i, Simd::fmadd(a, Simd::load(x + i), Simd::mul(b, Simd::load(y + i))));
+    }
+    for (; i < n; i++) {
+        y[i] = alpha * x[i] + beta * y[i];
+    }
+}
+
+// x *= alpha
+template <class T>
+void scal_kernel(double alpha, T* x, int n) {
+    reg a = Simd::set1(alpha);
+    int i = 0;
+    for (; i + W <= n; i += W) {
+        Simd::store(x + i, Simd::mul(a, Simd::load(x + i)));
+    }
+    for (; i < n; i++) {
+        x[i] *= alpha;
+    }
+}
+
+// z += alpha * x * y（要素ごとの積）
+template <class T>
+void fmadd_kernel(double alpha, const T* x, const T* y, T* z, int n) {
+    reg a = Simd::set1(alpha);
+    int i = 0;
+    for (; i + W <= n; i += W) {
+        Simd::store(z + i, Simd::fmadd(Simd::mul(a, Simd::load(x + i)), Simd::load(y + i), Simd::load(z + i)));
+    }
+    for (; i < n; i++) {
+        z[i] += alpha * x[i] * y[i];
+    }
+}
+
+// x・y, x・x, y・y を1回の走査で計算する
+template <class T>
+void dot_norms_kernel(const T* x, const T* y, int n, double* xy, double* xx, double* yy) {
+    reg s0 = Simd::zero(), s1 = Simd::zero();
+    reg p0 = Simd::zero(), p1 = Simd::zero();
+    reg q0 = Simd::zero(), q1 = Simd::zero();
+    int i = 0;
+    for (; i + 2 * W <= n; i += 2 * W) {
+        reg x0 = Simd::load(x + i), x1 = Simd::load(x + i + W);
+        reg y0 = Simd::load(y + i), y1 = Simd::load(y + i + W);
+        s0 = Simd::fmadd(x0, y0, s0);
+        s1 = Simd::fmadd(x1, y1, s1);
+        p0 = Simd::fmadd(x0, x0, p0);
+        p1 = Simd::fmadd(x1, x1, p1);
+        q0 = Simd::fmadd(y0, y0, q0);
+        q1 = Simd::fmadd(y1, y1, q1);
+    }
+    for (; i + W <= n; i += W) {
+        reg x0 = Simd::load(x + i);
+        reg y0 = Simd::load(y + i);
+        s0 = Simd::fmadd(x0, y0, s0);
+        p0 = Simd::fmadd(x0, x0, p0);
+        q0 = Simd::fmadd(y0, y0, q0);
+    }
+    double dot = Simd::sum(Simd::add(s0, s1));
+    double x_squared = Simd::sum(Simd::add(p0, p1));
+    double y_squared = Simd::sum(Simd::add(q0, q1));
+    for (; i < n; i++) {
+        dot += (double)x[i] * y[i];
+        x_squared += (double)x[i] * x[i];
+        y_squared += (double)y[i] * y[i];
+    }
+    *xy = dot;
+    *xx = x_squared;
+    *yy = y_squared;
+}
+
+// u と v を同時に更新する（u' = alpha * u + beta * v, v' = alpha * v + beta * u）
+template <class T>
+void coupled_axpby_kernel(double alpha, double beta, T* u, T* v, int n) {
+    reg a = Simd::set1(alpha);
+    reg b = Simd::set1(beta);
+    int i = 0;
+    for (; i + W <= n; i += W) {
+        reg u0 = Simd::load(u + i);
+        reg v0 = Simd::load(v + i);
+        Simd::store(u + i, Simd::fmadd(a, u0, Simd::mul(b, v0)));
+        Simd::store(v + i, Simd::fmadd(a, v0, Simd::mul(b, u0)));
+    }
+    for (; i < n; i++) {
+        double u0 = u[i];
+        double v0 = v[i];
+        u[i] = alpha * u0 + beta * v0;
+        v[i] = alpha * v0 + beta * u0;
+    }
+}
+
+}  // namespace
+
+// 内積 x・y
+double simd_dot(const double* x, const double* y, int n) { return dot_kernel(x, y, n); }
+double simd_dot(const float* x, const float* y, int n) { return dot_kernel(x, y, n); }
+
+// 平方和
+double simd_sum_squares(const double* x, int n) { return dot_kernel(x, x, n); }
+double simd_sum_squares(const float* x, int n) { return dot_kernel(x, x, n); }
+
+// 絶対値の和
+double simd_sum_abs(const double* x, int n) { return sum_abs_kernel(x, n); }
+double simd_sum_abs(const float* x, int n) { return sum_abs_kernel(x, n); }
+
+// 絶対値の最大値
+double simd_max_abs(const double* x, int n) { return max_abs_kernel(x, n); }
+double simd_max_abs(const float* x, int n) { return max_abs_kernel(x, n); }
+
+// y += x
+void simd_add(double* y, const double* x, int n) { add_kernel(y, x, n); }
+void simd_add(float* y, const float* x, int n) { add_kernel(y, x, n); }
+
+// y -= x
+void simd_sub(double* y, const double* x, int n) { sub_kernel(y, x, n); }
+void simd_sub(float* y, const float* x, int n) { sub_kernel(y, x, n); }
+
+// y += alpha * x
+void simd_axpy(double alpha, const double* x, double* y, int n) { axpy_kernel(alpha, x, y, n); }
+void simd_axpy(double alpha, const float* x, float* y, int n) { axpy_kernel(alpha, x, y, n); }
+
+// y = alpha * x + beta * y
+void simd_axpby(double alpha, const double* x, double beta, double* y, int n) { axpby_kernel(alpha, x, beta, y, n); }
+void simd_axpby(double alpha, const float* x, double beta, float* y, int n) { axpby_kernel(alpha, x, beta, y, n); }
+
+// x *= alpha
+void simd_scal(double alpha, double* x, int n) { scal_kernel(alpha, x, n); }
+void simd_scal(double alpha, float* x, int n) { scal_kernel(alpha, x, n); }
+
+// z += alpha * x * y（要素ごとの積）
+void simd_fmadd(double alpha, const double* x, const double* y, double* z, int n) { fmadd_kernel(alpha, x, y, z, n); }
+void simd_fmadd(double alpha, const float* x, const float* y, float* z, int n) { fmadd_kernel(alpha, x, y, z, n); }
+
+// x・y, x・x, y・y を1回の走査で計算する
+void simd_dot_norms(const double* x, const double* y, int n, double* xy, double* xx, double* yy) { dot_norms_kernel(x, y, n, xy, xx, yy); }
+void simd_dot_norms(const float* x, const float* y, int n, double* xy, double* xx, double* yy) { dot_norms_kernel(x, y, n, xy, xx, yy); }
+
+// u と v を同時に更新する（u' = alpha * u + beta * v, v' = alpha * v + beta * u）
+void simd_coupled_axpby(double alpha, double beta, double* u, double* v, int n) { coupled_axpby_kernel(alpha, beta, u, v, n); }
+void simd_coupled_axpby(double alpha, double beta, float* u, float* v, int n) { coupled_axpby_kernel(alpha, beta, u, v, n); }
@@ -0,0 +1,45 @@
+#include <cstddef>  // size_t の標準ライブラリ
+
+#ifndef __SIMD__
+#define __SIMD__
+
+// ベクトル・行列の値を保持する領域の境界（キャッシュライン、AVX-512のレジスタ幅）
+const size_t kSimdAlignment = 64;
+
+void* simd_alloc_bytes(size_t bytes); // 64バイト境界に揃えた bytes バイトの領域を確保する関数（失敗時は std::bad_alloc を送出）
+void simd_free(void* p);              // simd_alloc で確保した領域を解放する関数
+
+// 64バイト境界に揃えた T 型 n 個分の領域を確保する関数
+template <class T>
+T* simd_alloc(size_t n) {
+    return static_cast<T*>(simd_alloc_bytes(n * sizeof(T)));
+}
+
+// レベル1カーネル（AVX-512 / AVX2 + FMA / スカラーをコンパイル時に選択し、リダクションは複数のアキュムレータで計算する）
+// float 版は要素を倍精度に変換して計算し、内積などの累積も倍精度で行う
+double simd_dot(const double* x, const double* y, int n); // 内積 x・y
+double simd_dot(const float* x, const float* y, int n);
+double simd_sum_squares(const double* x, int n);          // 平方和
+double simd_sum_squares(const float* x, int n);
+double simd_sum_abs(const double* x, int n);              // 絶対値の和
+double simd_sum_abs(const float* x, int n);
+double simd_max_abs(const double* x, int n);              // 絶対値の最大値（n == 0 の場合は0）
+double simd_max_abs(const float* x, int n);
+void simd_add(double* y, const double* x, int n);         // y += x
+void simd_add(float* y, const float* x, int n);
+void simd_sub(double* y, const double* x, int n);         // y -= x
+void simd_sub(float* y, const float* x, int n);
+void simd_axpy(double alpha, const double* x, double* y, int n);              // y += alpha * x
+void simd_axpy(double alpha, const float* x, float* y, int n);
+void simd_axpby(double alpha, const double* x, double beta, double* y, int n); // y = alpha * x + beta * y
+void simd_axpby(double alpha, const float* x, double beta, float* y, int n);
+void simd_scal(double alpha, double* x, int n);                               // x *= alpha
+void simd_scal(double alpha, float* x, int n);
+void simd_fmadd(double alpha, const double* x, const double* y, double* z, int n); // z += alpha * x * y（要素ごとの積）
+void simd_fmadd(double alpha, const float* x, const float* y, float* z, int n);
+void simd_dot_norms(const double* x, const double* y, int n, double* xy, double* xx, double* yy); // x・y, x・x, y・y を同時に計算
+void simd_dot_norms(const float* x, const float* y, int n, double* xy, double* xx, double* yy);
+void simd_coupled_axpby(double alpha, double beta, double* u, double* v, int n); // u' = alpha * u + beta * v, v' = alpha * v + beta * u
+void simd_coupled_axpby(double alpha, double beta, float* u, float* v, int n);
+
+#endif
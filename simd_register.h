@@ -0,0 +1,84 @@
+#include <cmath>  // 数学関数の標準ライブラリ
+
+#if defined(__AVX512F__) || (defined(__AVX2__) && defined(__FMA__))
+#include <immintrin.h>
+#endif
+
+#ifndef __SIMD_REGISTER__
+#define __SIMD_REGISTER__
+
+// 命令セットごとのレジスタ操作
+// カーネルはこの構造体だけを使って書き、命令セットはインクルードした翻訳単位のコンパイル時に選択する
+// レジスタは常に倍精度で、float の配列は読み書きの際に変換する
+#if defined(__AVX512F__)
+
+struct SimdRegister {
+    typedef __m512d reg;
+    static const int width = 8;
+    static reg zero() { return _mm512_setzero_pd(); }
+    static reg set1(double x) { return _mm512_set1_pd(x); }
+    static reg load(const double* p) { return _mm512_loadu_pd(p); }
+    static void store(double* p, reg x) { _mm512_storeu_pd(p, x); }
+    static reg load(const float* p) { return _mm512_cvtps_pd(_mm256_loadu_ps(p)); }   // float を倍精度に変換して読み込む
+    static void store(float* p, reg x) { _mm256_storeu_ps(p, _mm512_cvtpd_ps(x)); }  // 単精度に丸めて書き込む
+    static reg add(reg a, reg b) { return _mm512_add_pd(a, b); }
+    static reg sub(reg a, reg b) { return _mm512_sub_pd(a, b); }
+    static reg mul(reg a, reg b) { return _mm512_mul_pd(a, b); }
+    static reg fmadd(reg a, reg b, reg c) { return _mm512_fmadd_pd(a, b, c); }  // a * b + c
+    static reg max(reg a, reg b) { return _mm512_max_pd(a, b); }
+    static reg abs(reg x) { return _mm512_castsi512_pd(_mm512_and_si512(_mm512_castpd_si512(x), _mm512_set1_epi64(0x7fffffffffffffffLL))); }
+    static double sum(reg x) { return _mm512_reduce_add_pd(x); }
+    static double max_element(reg x) { return _mm512_reduce_max_pd(x); }
+};
+
+#elif defined(__AVX2__) && defined(__FMA__)
+
+struct SimdRegister {
+    typedef __m256d reg;
+    static const int width = 4;
+    static reg zero() { return _mm256_setzero_pd(); }
+    static reg set1(double x) { return _mm256_set1_pd(x); }
+    static reg load(const double* p) { return _mm256_loadu_pd(p); }
+    static void store(double* p, reg x) { _mm256_storeu_pd(p, x); }
+    static reg load(const float* p) { return _mm256_cvtps_pd(_mm_loadu_ps(p)); }   // float を倍精度に変換して読み込む
+    static void store(float* p, reg x) { _mm_storeu_ps(p, _mm256_cvtpd_ps(x)); }  // 単精度に丸めて書き込む
+    static reg add(reg a, reg b) { return _mm256_add_pd(a, b); }
+    static reg sub(reg a, reg b) { return _mm256_sub_pd(a, b); }
+    static reg mul(reg a, reg b) { return _mm256_mul_pd(a, b); }
+    static reg fmadd(reg a, reg b, reg c) { return _mm256_fmadd_pd(a, b, c); }  // a * b + c
+    static reg max(reg a, reg b) { return _mm256_max_pd(a, b); }
+    static reg abs(reg x) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), x); }
+    static double sum(reg x) {
+        __m128d lo = _mm_add_pd(_mm256_castpd256_pd128(x), _mm256_extractf128_pd(x, 1));
+        return _mm_cvtsd_f64(_mm_add_sd(lo, _mm_unpackhi_pd(lo, lo)));
+    }
+    static double max_element(reg x) {
+        __m128d lo = _mm_max_pd(_mm256_castpd256_pd128(x), _mm256_extractf128_pd(x, 1));
+        return _mm_cvtsd_f64(_mm_max_sd(lo, _mm_unpackhi_pd(lo, lo)));
+    }
+};
+
+#else
+
+struct SimdRegister {
+    typedef double reg;
+    static const int width = 1;
+    static reg zero() { return 0.0; }
+    static reg set1(double x) { return x; }
+    static reg load(const double* p) { return *p; }
+    static void store(double* p, reg x) { *p = x; }
+    static reg load(const float* p) { return *p; }
+    static void store(float* p, reg x) { *p = (float)x; }
+    static reg add(reg a, reg b) { return a + b; }
+    static reg sub(reg a, reg b) { return a - b; }
+    static reg mul(reg a, reg b) { return a * b; }
+    static reg fmadd(reg a, reg b, reg c) { return a * b + c; }
+    static reg max(reg a, reg b) { return a < b ? b : a; }
+    static reg abs(reg x) { return fabs(x); }
+    static double sum(reg x) { return x; }
+    static double max_element(reg x) { return x; }
+};
+
+#endif
+
+#endif
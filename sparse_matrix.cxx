@@ -1,7 +1,620 @@
 #include "sparse_matrix.h"
 
+#include "fm_design_matrix.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// 行と非ゼロ要素を1列に並べた作業列（各行の非ゼロ要素の後に行の終わりが続く）で diagonal 番目の位置を求める
+// 完了した行数を row に、処理済みの非ゼロ要素数を nz に返す（row + nz = diagonal）
+void merge_path_search(const int* row_pointers, int rows, long long diagonal, int& row, int& nz) {
+    int low = 0;
+    int high = rows;
+    while (low < high) {
+        int mid = low + (high - low + 1) / 2;
+        if (row_pointers[mid] + (long long)mid <= diagonal) {
+            low = mid;
+        } else {
+            high = mid - 1;
+        }
+    }
+    row = low;
+    nz = (int)(diagonal - low);
+}
+
+// 作業列を区間に等分し、各区間の先頭の位置（完了した行数、処理済みの非ゼロ要素数）を返す
+// 区間数は max_parts（省略時はスレッド数の4倍）を上限とし、1区間の計算量 work / 区間数 が kParallelGrain 程度を下回らないようにする
+int merge_path_partition(const int* row_pointers, int rows, int nnz, long long work, std::vector<int>& part_rows, std::vector<int>& part_nzs, int max_parts = 0) {
+    if (max_parts <= 0) max_parts = 4 * get_num_threads();
+    int parts = (int)std::max(1LL, std::min<long long>(max_parts, work / kParallelGrain));
+    long long total = (long long)rows + nnz;
+    part_rows.resize(parts + 1);
+    part_nzs.resize(parts + 1);
+    for (int p = 0; p <= parts; p++) {
+        merge_path_search(row_pointers, rows, total * p / parts, part_rows[p], part_nzs[p]);
+    }
+    return parts;
+}
+
+// C = alpha * A * B + beta * C
+// 作業列を等分した区間ごとに、非ゼロ要素 A(i, k) について C の i 行に alpha * A(i, k) * B の k 行を axpy で足し込む
+// 区間の境界で分割された行は区間ごとの一時的な行に集計し、並列処理の後で C に足し込む
+template <class T>
+void spmm_kernel(double alpha, const BasicSparseMatrix<T>& A, const BasicMatrixView<T>& B, double beta, const BasicMatrixView<T>& C) {
+    if (A.cols() != B.rows() || C.rows() != A.rows() || C.cols() != B.cols()) {
+        std::cerr << "spmm(double, const SparseMatrix &, const MatrixView &, double, const MatrixView &): Size unmatched" << std::endl;
+        exit(1);
+    }
+    int rows = A.rows();
+    int cols = C.cols();
+    int nnz = A.nnz();
+    const int* row_pointers = A.get_row_pointers();
+    const int* col_indices = A.get_col_indices();
+    const T* values = A.get_values();
+
+    parallel_for(0, rows, cols > 0 ? (kParallelGrain + cols - 1) / cols : kParallelGrain, [&](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            BasicVectorView<T> c_row = C.row(i);
+            if (beta == 0.0) {
+                for (int j = 0; j < cols; j++) {
+                    c_row[j] = 0.0;
+                }
+            } else if (beta != 1.0) {
+                scal(beta, c_row);
+            }
+        }
+    });
+    if (alpha == 0.0 || nnz == 0 || cols == 0) return;
+
+    std::vector<int> part_rows;
+    std::vector<int> part_nzs;
+    int parts = merge_path_partition(row_pointers, rows, nnz, (long long)nnz * cols + rows, part_rows, part_nzs);
+
+    // 区間の先頭と末尾で分割された行の集計先（2 * p が先頭、2 * p + 1 が末尾）
+    std::vector<BasicVector<T> > carries(2 * parts);
+    std::vector<int> carry_rows(2 * parts, -1);
+    parallel_for(0, parts, 1, [&](int begin, int end) {
+        for (int p = begin; p < end; p++) {
+            int first_row = part_rows[p];
+            int last_row = part_rows[p + 1];
+            for (int i = first_row; i <= last_row && i < rows; i++) {
+                int first = i == first_row ? part_nzs[p] : row_pointers[i];
+                int last = i == last_row ? part_nzs[p + 1] : row_pointers[i + 1];
+                if (first >= last) continue;
+                bool split = first != row_pointers[i] || last != row_pointers[i + 1];
+                int slot = i == first_row ? 2 * p : 2 * p + 1;
+                if (split) {
+                    carries[slot] = BasicVector<T>(cols, 0.0, "all");
+                    carry_rows[slot] = i;
+                }
+                BasicVectorView<T> target = split ? BasicVectorView<T>(carries[slot]) : C.row(i);
+                for (int k = first; k < last; k++) {
+                    axpy(alpha * values[k], B.row(col_indices[k]), target);
+                }
+            }
+        }
+    });
+    for (int slot = 0; slot < 2 * parts; slot++) {
+        if (carry_rows[slot] >= 0) {
+            axpy(1.0, carries[slot], C.row(carry_rows[slot]));
+        }
+    }
+}
+
+// 非ゼロ要素 [first, last) と x の内積を倍精度で計算する（x の要素は列インデックスで集めるので4つのアキュムレータで依存を切る）
+template <class T>
+double sparse_row_dot(const T* values, const int* col_indices, int first, int last, const BasicVectorView<T>& x) {
+    double sum0 = 0.0, sum1 = 0.0, sum2 = 0.0, sum3 = 0.0;
+    int k = first;
+    for (; k + 4 <= last; k += 4) {
+        sum0 += (double)values[k] * x[col_indices[k]];
+        sum1 += (double)values[k + 1] * x[col_indices[k + 1]];
+        sum2 += (double)values[k + 2] * x[col_indices[k + 2]];
+        sum3 += (double)values[k + 3] * x[col_indices[k + 3]];
+    }
+    for (; k < last; k++) {
+        sum0 += (double)values[k] * x[col_indices[k]];
+    }
+    return (sum0 + sum1) + (sum2 + sum3);
+}
+
+// y = alpha * A * x + beta * y
+// 作業列を等分した区間ごとに、各行の非ゼロ要素と x の内積を計算する
+// 区間の中で完結する行は y に直接書き込み、区間の境界で分割された行は区間ごとの部分和を並列処理の後で y に足し込む
+template <class T>
+void spmv_kernel(double alpha, const BasicSparseMatrix<T>& A, const BasicVectorView<T>& x, double beta, const BasicVectorView<T>& y) {
+    if (A.cols() != x.size() || A.rows() != y.size()) {
+        std::cerr << "spmv(double, const SparseMatrix &, const VectorView &, double, const VectorView &): Size unmatched" << std::endl;
+        exit(1);
+    }
+    int rows = A.rows();
+    int nnz = A.nnz();
+    const int* row_pointers = A.get_row_pointers();
+    const int* col_indices = A.get_col_indices();
+    const T* values = A.get_values();
+    if (rows == 0) return;
+
+    std::vector<int> part_rows;
+    std::vector<int> part_nzs;
+    int parts = merge_path_partition(row_pointers, rows, nnz, (long long)nnz + rows, part_rows, part_nzs);
+
+    // 区間の先頭と末尾で分割された行の部分和（2 * p が先頭、2 * p + 1 が末尾）
+    std::vector<double> carries(2 * parts, 0.0);
+    std::vector<int> carry_rows(2 * parts, -1);
+    parallel_for(0, parts, 1, [&](int begin, int end) {
+        for (int p = begin; p < end; p++) {
+            int first_row = part_rows[p];
+            int last_row = part_rows[p + 1];
+            for (int i = first_row; i <= last_row && i < rows; i++) {
+                int first = i == first_row ? part_nzs[p] : row_pointers[i];
+                int last = i == last_row ? part_nzs[p + 1] : row_pointers[i + 1];
+                // 行の終わりを処理する区間だけが、行全体を持っていれば直接書き込む
+                if (i < last_row && first == row_pointers[i] && last == row_pointers[i + 1]) {
+                    double sum = alpha == 0.0 ? 0.0 : alpha * sparse_row_dot(values, col_indices, first, last, x);
+                    y[i] = beta == 0.0 ? sum : sum + beta * y[i];
+                } else if (first < last) {
+                    int slot = i == first_row ? 2 * p : 2 * p + 1;
+                    carries[slot] = sparse_row_dot(values, col_indices, first, last, x);
+                    carry_rows[slot] = i;
+                }
+            }
+        }
+    });
+    // 分割された行は区間の順に現れるので、行が変わるときに一度だけ beta を掛ける
+    int previous = -1;
+    for (int slot = 0; slot < 2 * parts; slot++) {
+        int i = carry_rows[slot];
+        if (i < 0) continue;
+        if (i != previous) {
+            y[i] = beta == 0.0 ? 0.0 : beta * y[i];
+            previous = i;
+        }
+        y[i] += alpha * carries[slot];
+    }
+}
+
+// y = alpha * A^T * x + beta * y（A を転置せずに CSR のまま計算する）
+// 作業列をスレッド数以下の区間に等分し、区間ごとの倍精度の作業ベクトルに x[i] * A(i, j) を散らして足し込む
+// 作業ベクトルは区間ごとに別なので競合せず、最後に列方向に並列で合計して y に書き込む
+template <class T>
+void spmv_transposed_kernel(double alpha, const BasicSparseMatrix<T>& A, const BasicVectorView<T>& x, double beta, const BasicVectorView<T>& y) {
+    if (A.rows() != x.size() || A.cols() != y.size()) {
+        std::cerr << "spmv_transposed(double, const SparseMatrix &, const VectorView &, double, const VectorView &): Size unmatched" << std::endl;
+        exit(1);
+    }
+    int rows = A.rows();
+    int cols = A.cols();
+    int nnz = A.nnz();
+    const int* row_pointers = A.get_row_pointers();
+    const int* col_indices = A.get_col_indices();
+    const T* values = A.get_values();
+    if (cols == 0) return;
+
+    std::vector<int> part_rows;
+    std::vector<int> part_nzs;
+    int parts = 0;
+    if (alpha != 0.0 && nnz > 0) {
+        parts = merge_path_partition(row_pointers, rows, nnz, (long long)nnz + rows, part_rows, part_nzs, get_num_threads());
+    }
+    std::vector<std::vector<double> > partials(parts);
+    parallel_for(0, parts, 1, [&](int begin, int end) {
+        for (int p = begin; p < end; p++) {
+            std::vector<double>& partial = partials[p];
+            partial.assign(cols, 0.0);
+            int first_row = part_rows[p];
+            int last_row = part_rows[p + 1];
+            for (int i = first_row; i <= last_row && i < rows; i++) {
+                int first = i == first_row ? part_nzs[p] : row_pointers[i];
+                int last = i == last_row ? part_nzs[p + 1] : row_pointers[i + 1];
+                double x_i = x[i];
+                if (x_i == 0.0) continue;
+                for (int k = first; k < last; k++) {
+                    partial[col_indices[k]] += x_i * values[k];
+                }
+            }
+        }
+    });
+    parallel_for(0, cols, kParallelGrain / std::max(1, parts), [&](int begin, int end) {
+        for (int j = begin; j < end; j++) {
+            double sum = 0.0;
+            for (int p = 0; p < parts; p++) {
+                sum += partials[p][j];
+            }
+            y[j] = beta == 0.0 ? alpha * sum : alpha * sum + beta * y[j];
+        }
+    });
+}
+
+// 疎行列のバイナリ形式の識別子と版
+// 版 1: ヘッダーの後に行ポインタ、列インデックス、値の配列を、それぞれ先頭を64バイト境界に揃えて置く
+const char kSparseMatrixMagic[8] = {'M', 'U', 'S', 'P', 'C', 'S', 'R', '\0'};
+const uint32_t kSparseMatrixVersion = 1;
+const uint32_t kSparseMatrixByteOrder = 0x01020304;  // 書き込んだ環境のバイト順の確認用
+const uint64_t kSparseMatrixAlignment = 64;
+
+// 疎行列のバイナリ形式のヘッダー
+struct SparseMatrixFileHeader {
+    char magic[8];                 // 識別子
+    uint32_t version;              // 版
+    uint32_t byte_order;           // kSparseMatrixByteOrder
+    uint32_t index_size;           // 行ポインタと列インデックスの1要素のバイト数
+    uint32_t value_size;           // 値の1要素のバイト数（float なら 4、double なら 8）
+    int64_t rows;                  // 行数
+    int64_t cols;                  // 列数
+    int64_t nnz;                   // 非ゼロ要素数
+    uint64_t row_pointers_offset;  // 行ポインタの配列の位置
+    uint64_t col_indices_offset;   // 列インデックスの配列の位置
+    uint64_t values_offset;        // 値の配列の位置
+    uint64_t file_size;            // ファイル全体の大きさ
+};
+
+// offset を64バイト境界に切り上げる
+uint64_t align_offset(uint64_t offset) { return (offset + kSparseMatrixAlignment - 1) / kSparseMatrixAlignment * kSparseMatrixAlignment; }
+
+// 行数、列数、非ゼロ要素数と値のバイト数からヘッダーを作る
+SparseMatrixFileHeader make_header(int rows, int cols, int nnz, uint32_t value_size) {
+    SparseMatrixFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, kSparseMatrixMagic, sizeof(header.magic));
+    header.version = kSparseMatrixVersion;
+    header.byte_order = kSparseMatrixByteOrder;
+    header.index_size = sizeof(int);
+    header.value_size = value_size;
+    header.rows = rows;
+    header.cols = cols;
+    header.nnz = nnz;
+    header.row_pointers_offset = align_offset(sizeof(header));
+    header.col_indices_offset = align_offset(header.row_pointers_offset + (uint64_t)(rows + 1) * sizeof(int));
+    header.values_offset = align_offset(header.col_indices_offset + (uint64_t)nnz * sizeof(int));
+    header.file_size = header.values_offset + (uint64_t)nnz * value_size;
+    return header;
+}
+
+// ヘッダーが読み込む型と実際のファイルの大きさに合っているかを確認する（合わなければ終了する）
+void check_header(const SparseMatrixFileHeader& header, uint64_t file_size, uint32_t value_size, const char* filename) {
+    const char* error = nullptr;
+    if (memcmp(header.magic, kSparseMatrixMagic, sizeof(header.magic)) != 0) {
+        error = "Not a sparse matrix file";
+    } else if (header.version != kSparseMatrixVersion) {
+        error = "Unsupported version";
+    } else if (header.byte_order != kSparseMatrixByteOrder) {
+        error = "Byte order unmatched";
+    } else if (header.index_size != sizeof(int) || header.value_size != value_size) {
+        error = "Element type unmatched";
+    } else if (header.rows < 0 || header.cols < 0 || header.nnz < 0 || header.rows >= INT32_MAX || header.cols > INT32_MAX || header.nnz > INT32_MAX) {
+        error = "Size out of range";
+    } else {
+        SparseMatrixFileHeader expected = make_header((int)header.rows, (int)header.cols, (int)header.nnz, value_size);
+        if (header.row_pointers_offset != expected.row_pointers_offset || header.col_indices_offset != expected.col_indices_offset ||
+            header.values_offset != expected.values_offset || header.file_size != expected.file_size || file_size < header.file_size) {
+            error = "Broken file";
+        }
+    }
+    if (error != nullptr) {
+        std::cerr << "SparseMatrix: " << error << ": " << filename << std::endl;
+        exit(1);
+    }
+}
+
+// 読み込んだ行ポインタと列インデックスが CSR 形式として正しいかを調べる（行ポインタは 0 から nnz まで単調非減少、列インデックスは 0 以上 cols 未満）
+bool valid_structure(int rows, int cols, int nnz, const int* row_pointers, const int* col_indices) {
+    if (row_pointers[0] != 0 || row_pointers[rows] != nnz) return false;
+    double broken_rows = parallel_sum(0, rows, kParallelGrain, [&](int begin, int end) {
+        double count = 0.0;
+        for (int i = begin; i < end; i++) count += row_pointers[i] > row_pointers[i + 1];
+        return count;
+    });
+    double broken_indices = parallel_sum(0, nnz, kParallelGrain, [&](int begin, int end) {
+        double count = 0.0;
+        for (int k = begin; k < end; k++) count += col_indices[k] < 0 || col_indices[k] >= cols;
+        return count;
+    });
+    return broken_rows == 0.0 && broken_indices == 0.0;
+}
+
+// SDDMM で1回に内積を取る内側の次元の長さ（lhs の行の区間を L1 キャッシュに載せたまま使い回す）
+const int kSddmmTile = 256;
+
+// SDDMM で何個先の非ゼロ要素の transpose_rhs の行を先読みするか
+const int kSddmmPrefetchDistance = 4;
+
+// p から最大 bytes バイト（先頭の数キャッシュライン）をキャッシュに読み込むよう要求する
+inline void prefetch_range(const void* p, int bytes) {
+    const char* address = static_cast<const char*>(p);
+    int limit = std::min(bytes, 512);
+    for (int offset = 0; offset < limit; offset += 64) {
+        __builtin_prefetch(address + offset);
+    }
+}
+
+// A の非ゼロ要素の位置 (i, j) について result[A の非ゼロ要素の番号] = lhs の i 行 ・ transpose_rhs の j 行 を計算する
+// 作業列を等分した区間ごとに、行の非ゼロ要素に対して lhs の行を使い回す
+// transpose_rhs の行が連続していれば内側の次元を kSddmmTile ごとに区切って SIMD の内積を取り、次に読む行を先読みする
+// そうでなければ lhs の各要素で transpose_rhs の列を読みながら加算する（どちらも倍精度で集計する）
+template <class T>
+void sddmm_kernel(const BasicSparseMatrix<T>& A, const BasicMatrixView<T>& lhs, const BasicMatrixView<T>& transpose_rhs, T* result) {
+    if (lhs.rows() != A.rows() || lhs.cols() != transpose_rhs.cols() || transpose_rhs.rows() != A.cols()) {
+        std::cerr << "SparseMatrix::product(const MatrixView &, const MatrixView &): Size unmatched" << std::endl;
+        exit(1);
+    }
+    int rows = A.rows();
+    int nnz = A.nnz();
+    int inner = lhs.cols();
+    const int* row_pointers = A.get_row_pointers();
+    const int* col_indices = A.get_col_indices();
+    if (nnz == 0) return;
+
+    std::vector<int> part_rows;
+    std::vector<int> part_nzs;
+    int parts = merge_path_partition(row_pointers, rows, nnz, (long long)nnz * inner + rows, part_rows, part_nzs);
+    bool contiguous = transpose_rhs.col_stride() == 1;
+    const T* rhs_values = transpose_rhs.data();
+    int rhs_stride = transpose_rhs.row_stride();
+    parallel_for(0, parts, 1, [&](int begin, int end) {
+        std::vector<double> sums;
+        for (int p = begin; p < end; p++) {
+            int first_row = part_rows[p];
+            int last_row = part_rows[p + 1];
+            for (int i = first_row; i <= last_row && i < rows; i++) {
+                int first = i == first_row ? part_nzs[p] : row_pointers[i];
+                int last = i == last_row ? part_nzs[p + 1] : row_pointers[i + 1];
+                if (first >= last) continue;
+                BasicVectorView<T> lhs_row = lhs.row(i);
+                if (contiguous && inner <= kSddmmTile) {
+                    for (int j = first; j < last; j++) {
+                        if (j + kSddmmPrefetchDistance < last) {
+                            prefetch_range(rhs_values + (long long)col_indices[j + kSddmmPrefetchDistance] * rhs_stride, inner * (int)sizeof(T));
+                        }
+                        result[j] = dot(lhs_row, transpose_rhs.row(col_indices[j]));
+                    }
+                    continue;
+                }
+                sums.assign(last - first, 0.0);
+                if (contiguous) {
+                    for (int k0 = 0; k0 < inner; k0 += kSddmmTile) {
+                        int k1 = std::min(k0 + kSddmmTile, inner);
+                        BasicVectorView<T> lhs_tile = lhs_row.range(k0, k1);
+                        for (int j = first; j < last; j++) {
+                            if (j + kSddmmPrefetchDistance < last) {
+                                prefetch_range(rhs_values + (long long)col_indices[j + kSddmmPrefetchDistance] * rhs_stride + k0, (k1 - k0) * (int)sizeof(T));
+                            }
+                            sums[j - first] += dot(lhs_tile, transpose_rhs.row(col_indices[j]).range(k0, k1));
+                        }
+                    }
+                } else {
+                    for (int k = 0; k < inner; k++) {
+                        double a = lhs_row[k];
+                        BasicVectorView<T> rhs_col = transpose_rhs.col(k);
+                        for (int j = first; j < last; j++) {
+                            sums[j - first] += a * rhs_col[col_indices[j]];
+                        }
+                    }
+                }
+                for (int j = first; j < last; j++) {
+                    result[j] = sums[j - first];
+                }
+            }
+        }
+    });
+}
+
+// 1行の積の計算量（A の行の各非ゼロ要素に対応する B の行の非ゼロ要素数の和）が列数のこの割合以上の行は、密な作業配列に集計する
+// それより小さい行はハッシュ表に集計し、列数に比例する作業配列に触れないようにする
+const int kSpgemmDenseFraction = 16;
+
+// SpGEMM の行ごとの集計に使うスレッドごとの作業領域
+struct SpgemmAccumulator {
+    std::vector<int> dense_marks;     // 密な作業配列で、列に最後に書き込んだ行（未使用は -1）
+    std::vector<double> dense_values; // 密な作業配列の値
+    std::vector<int> touched;         // 密な作業配列で書き込んだ列
+    std::vector<int> hash_keys;       // ハッシュ表の列（空は -1）
+    std::vector<double> hash_values;  // ハッシュ表の値
+    std::vector<std::pair<int, double> > entries; // 集計した行の（列, 値）
+};
+
+// A の i 行と B の積の行を集計する（kNumeric が false なら列だけを数え、値は計算しない）
+// 計算量 flops の行のうち、列数に対して重い行は密な作業配列、軽い行はハッシュ表を使う
+// 集計した列の数を返し、kNumeric が true なら acc.entries に（列, 値）を入れる
+template <bool kNumeric, class T>
+int spgemm_row(const BasicSparseMatrix<T>& A, const BasicSparseMatrix<T>& B, int i, long long flops, SpgemmAccumulator& acc) {
+    const int* a_row_pointers = A.get_row_pointers();
+    const int* a_col_indices = A.get_col_indices();
+    const T* a_values = A.get_values();
+    const int* b_row_pointers = B.get_row_pointers();
+    const int* b_col_indices = B.get_col_indices();
+    const T* b_values = B.get_values();
+    int cols = B.cols();
+    if (kNumeric) acc.entries.clear();
+    if (flops == 0) return 0;
+
+    if (flops * kSpgemmDenseFraction >= cols) {
+        if ((int)acc.dense_marks.size() < cols) {
+            acc.dense_marks.assign(cols, -1);
+            if (kNumeric) acc.dense_values.resize(cols);
+        }
+        acc.touched.clear();
+        for (int a = a_row_pointers[i]; a < a_row_pointers[i + 1]; a++) {
+            int k = a_col_indices[a];
+            double a_value = kNumeric ? (double)a_values[a] : 0.0;
+            for (int b = b_row_pointers[k]; b < b_row_pointers[k + 1]; b++) {
+                int col = b_col_indices[b];
+                if (acc.dense_marks[col] != i) {
+                    acc.dense_marks[col] = i;
+                    acc.touched.push_back(col);
+                    if (kNumeric) acc.dense_values[col] = a_value * b_values[b];
+                } else if (kNumeric) {
+                    acc.dense_values[col] += a_value * b_values[b];
+                }
+            }
+        }
+        if (kNumeric) {
+            for (size_t t = 0; t < acc.touched.size(); t++) {
+                acc.entries.push_back(std::make_pair(acc.touched[t], acc.dense_values[acc.touched[t]]));
+            }
+        }
+        return (int)acc.touched.size();
+    }
+
+    // 計算量の2倍以上の2の冪の大きさの表を線形探索で使う
+    int size = 16;
+    while (size < 2 * flops) size *= 2;
+    unsigned mask = size - 1;
+    if ((int)acc.hash_keys.size() < size) {
+        acc.hash_keys.resize(size);
+        if (kNumeric) acc.hash_values.resize(size);
+    }
+    std::fill(acc.hash_keys.begin(), acc.hash_keys.begin() + size, -1);
+    int count = 0;
+    for (int a = a_row_pointers[i]; a < a_row_pointers[i + 1]; a++) {
+        int k = a_col_indices[a];
+        double a_value = kNumeric ? (double)a_values[a] : 0.0;
+        for (int b = b_row_pointers[k]; b < b_row_pointers[k + 1]; b++) {
+            int col = b_col_indices[b];
+            unsigned h = ((unsigned)col * 2654435761u) & mask;
+            while (acc.hash_keys[h] != -1 && acc.hash_keys[h] != col) {
+                h = (h + 1) & mask;
+            }
+            if (acc.hash_keys[h] == -1) {
+                acc.hash_keys[h] = col;
+                count++;
+                if (kNumeric) acc.hash_values[h] = a_value * b_values[b];
+            } else if (kNumeric) {
+                acc.hash_values[h] += a_value * b_values[b];
+            }
+        }
+    }
+    if (kNumeric) {
+        for (int h = 0; h < size; h++) {
+            if (acc.hash_keys[h] != -1) {
+                acc.entries.push_back(std::make_pair(acc.hash_keys[h], acc.hash_values[h]));
+            }
+        }
+    }
+    return count;
+}
+
+// A * B を計算する（top_k > 0 なら各行で絶対値の大きい top_k 個の要素だけを残す）
+// 行ごとの計算量の累積和で行を区間に分け、記号的な段階で各行の非ゼロ要素数を数えて結果の配列を正確に確保してから、数値的な段階で値を書き込む
+// 結果の各行の列インデックスは昇順に並ぶ
+template <class T>
+BasicSparseMatrix<T> spgemm_kernel(const BasicSparseMatrix<T>& A, const BasicSparseMatrix<T>& B, int top_k) {
+    if (A.cols() != B.rows()) {
+        std::cerr << "spgemm(const SparseMatrix &, const SparseMatrix &, int): Size unmatched" << std::endl;
+        exit(1);
+    }
+    int rows = A.rows();
+    const int* a_row_pointers = A.get_row_pointers();
+    const int* a_col_indices = A.get_col_indices();
+    const int* b_row_pointers = B.get_row_pointers();
+
+    // 行ごとの計算量と、その累積和
+    std::vector<long long> flops(rows + 1, 0);
+    parallel_for(0, rows, std::max(1, (int)((long long)kParallelGrain * rows / std::max(1, A.nnz()))), [&](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            long long sum = 0;
+            for (int a = a_row_pointers[i]; a < a_row_pointers[i + 1]; a++) {
+                int k = a_col_indices[a];
+                sum += b_row_pointers[k + 1] - b_row_pointers[k];
+            }
+            flops[i + 1] = sum;
+        }
+    });
+    for (int i = 0; i < rows; i++) {
+        flops[i + 1] += flops[i];
+    }
+
+    // 計算量と行数の和が等しくなるように行を区間に分ける
+    long long total = flops[rows] + rows;
+    int parts = (int)std::max(1LL, std::min<long long>(4 * get_num_threads(), total / kParallelGrain));
+    std::vector<int> part_rows(parts + 1, rows);
+    part_rows[0] = 0;
+    for (int p = 1; p < parts; p++) {
+        long long target = total * p / parts;
+        int low = part_rows[p - 1];
+        int high = rows;
+        while (low < high) {
+            int mid = low + (high - low) / 2;
+            if (flops[mid] + mid < target) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        part_rows[p] = low;
+    }
+
+    // 記号的な段階：各行の非ゼロ要素数を数える
+    std::vector<int> counts(rows + 1, 0);
+    parallel_for(0, parts, 1, [&](int begin, int end) {
+        SpgemmAccumulator acc;
+        for (int p = begin; p < end; p++) {
+            for (int i = part_rows[p]; i < part_rows[p + 1]; i++) {
+                int count = spgemm_row<false>(A, B, i, flops[i + 1] - flops[i], acc);
+                counts[i + 1] = top_k > 0 ? std::min(count, top_k) : count;
+            }
+        }
+    });
+    long long nnz = 0;
+    for (int i = 1; i <= rows; i++) {
+        nnz += counts[i];
+    }
+    if (nnz > INT_MAX) {
+        std::cerr << "spgemm(const SparseMatrix &, const SparseMatrix &, int): Too many non-zero elements (" << nnz << ")" << std::endl;
+        exit(1);
+    }
+    parallel_prefix_sum(counts.data() + 1, rows);
+
+    BasicSparseMatrix<T> result(rows, B.cols(), (int)nnz);
+    int* row_pointers = result.get_row_pointers();
+    int* col_indices = result.get_col_indices();
+    T* values = result.get_values();
+    std::copy(counts.begin(), counts.end(), row_pointers);
+
+    // 数値的な段階：各行を集計し、必要なら絶対値の大きい要素を選んでから、列の順に書き込む
+    parallel_for(0, parts, 1, [&](int begin, int end) {
+        SpgemmAccumulator acc;
+        for (int p = begin; p < end; p++) {
+            for (int i = part_rows[p]; i < part_rows[p + 1]; i++) {
+                spgemm_row<true>(A, B, i, flops[i + 1] - flops[i], acc);
+                std::vector<std::pair<int, double> >& entries = acc.entries;
+                int length = row_pointers[i + 1] - row_pointers[i];
+                if ((int)entries.size() > length) {
+                    std::nth_element(entries.begin(), entries.begin() + length, entries.end(), [](const std::pair<int, double>& lhs, const std::pair<int, double>& rhs) {
+                        double l = std::fabs(lhs.second);
+                        double r = std::fabs(rhs.second);
+                        return l > r || (l == r && lhs.first < rhs.first);
+                    });
+                    entries.resize(length);
+                }
+                std::sort(entries.begin(), entries.end());
+                for (int k = 0; k < length; k++) {
+                    col_indices[row_pointers[i] + k] = entries[k].first;
+                    values[row_pointers[i] + k] = entries[k].second;
+                }
+            }
+        }
+    });
+    return result;
+}
+
+}  // namespace
+
 // コンストラクタ
-SparseMatrix::SparseMatrix(int rows, int cols) : rows_(rows), cols_(cols) {
+template <class T>
+BasicSparseMatrix<T>::BasicSparseMatrix(int rows, int cols) : rows_(rows), cols_(cols) {
     // 行ポインタ、列インデックス、データを初期化
     row_pointers_ = new int[rows + 1]();
     col_indices_ = nullptr;  // サイズは後で設定する
@@ -10,15 +623,17 @@ SparseMatrix::SparseMatrix(int rows, int cols) : rows_(rows), cols_(cols) {
 }
 
 // コンストラクタ
-SparseMatrix::SparseMatrix(int rows, int cols, int nnz) : rows_(rows), cols_(cols), nnz_(nnz) {
+template <class T>
+BasicSparseMatrix<T>::BasicSparseMatrix(int rows, int cols, int nnz) : rows_(rows), cols_(cols), nnz_(nnz) {
     // 行ポインタ、列インデックス、データを初期化
     row_pointers_ = new int[rows + 1]();
     col_indices_ = new int[nnz];
-    values_ = new double[nnz];
+    values_ = new T[nnz];
 }
 
 // デフォルトコンストラクタ
-SparseMatrix::SparseMatrix() : rows_(0), cols_(0), nnz_(0) {
+template <class T>
+BasicSparseMatrix<T>::BasicSparseMatrix() : rows_(0), cols_(0), nnz_(0) {
     // 行ポインタ、列インデックス、データを初期化
     row_pointers_ = nullptr;
     col_indices_ = nullptr;
@@ -26,11 +641,12 @@ SparseMatrix::SparseMatrix() : rows_(0), cols_(0), nnz_(0) {
 }
 
 // コピーコンストラクタ
-SparseMatrix::SparseMatrix(const SparseMatrix& arg) : rows_(arg.rows_), cols_(arg.cols_), nnz_(arg.nnz_) {
+template <class T>
+BasicSparseMatrix<T>::BasicSparseMatrix(const BasicSparseMatrix<T>& arg) : rows_(arg.rows_), cols_(arg.cols_), nnz_(arg.nnz_) {
     // 行ポインタ、列インデックス、データをコピー
     row_pointers_ = new int[rows_ + 1];
     col_indices_ = new int[nnz_];
-    values_ = new double[nnz_];
+    values_ = new T[nnz_];
 
     for (int i = 0; i <= rows_; i++) {
         row_pointers_[i] = arg.row_pointers_[i];
@@ -42,8 +658,31 @@ SparseMatrix::SparseMatrix(const SparseMatrix& arg) : rows_(arg.rows_), cols_(ar
     }
 }
 
+// ムーブコンストラクタ
+template <class T>
+BasicSparseMatrix<T>::BasicSparseMatrix(BasicSparseMatrix<T>&& arg)
+    : rows_(arg.rows_),
+      cols_(arg.cols_),
+      nnz_(arg.nnz_),
+      row_pointers_(arg.row_pointers_),
+      col_indices_(arg.col_indices_),
+      values_(arg.values_),
+      mapping_(arg.mapping_),
+      mapping_size_(arg.mapping_size_) {
+    // 右辺値のリソースを無効化
+    arg.rows_ = 0;
+    arg.cols_ = 0;
+    arg.nnz_ = 0;
+    arg.row_pointers_ = nullptr;
+    arg.col_indices_ = nullptr;
+    arg.values_ = nullptr;
+    arg.mapping_ = nullptr;
+    arg.mapping_size_ = 0;
+}
+
 // 特殊なコンストラクタ（対角行列を生成）
-SparseMatrix::SparseMatrix(int size, const char* s) : rows_(size), cols_(size) {
+template <class T>
+BasicSparseMatrix<T>::BasicSparseMatrix(int size, const char* s) : rows_(size), cols_(size) {
     if (strcmp(s, "diag") != 0) return;
     // 対角行列の場合、非ゼロ要素の数は size となる
     nnz_ = size;
@@ -51,7 +690,7 @@ SparseMatrix::SparseMatrix(int size, const char* s) : rows_(size), cols_(size) {
     // 行ポインタ、列インデックス、データを初期化
     row_pointers_ = new int[size + 1];
     col_indices_ = new int[size];
-    values_ = new double[size];
+    values_ = new T[size];
 
     // 各要素の初期化
     for (int i = 0; i < size; i++) {
@@ -64,27 +703,64 @@ SparseMatrix::SparseMatrix(int size, const char* s) : rows_(size), cols_(size) {
 }
 
 // デストラクタ
-SparseMatrix::~SparseMatrix() {
+template <class T>
+BasicSparseMatrix<T>::~BasicSparseMatrix() {
     // データを解放
-    delete[] row_pointers_;
-    delete[] col_indices_;
-    delete[] values_;
+    release();
+}
+
+// 配列を解放する（マップした領域なら munmap する）
+template <class T>
+void BasicSparseMatrix<T>::release() {
+    if (mapping_ != nullptr) {
+        munmap(mapping_, mapping_size_);
+        mapping_ = nullptr;
+        mapping_size_ = 0;
+    } else {
+        delete[] row_pointers_;
+        delete[] col_indices_;
+        delete[] values_;
+    }
+    row_pointers_ = nullptr;
+    col_indices_ = nullptr;
+    values_ = nullptr;
+}
+
+// マップした配列を new[] で確保した配列に複製し、マップを解除する
+template <class T>
+void BasicSparseMatrix<T>::detach_mapping() {
+    if (mapping_ == nullptr) return;
+    int* new_row_pointers = new int[rows_ + 1];
+    int* new_col_indices = new int[nnz_];
+    T* new_values = new T[nnz_];
+    std::copy(row_pointers_, row_pointers_ + rows_ + 1, new_row_pointers);
+    std::copy(col_indices_, col_indices_ + nnz_, new_col_indices);
+    std::copy(values_, values_ + nnz_, new_values);
+    release();
+    row_pointers_ = new_row_pointers;
+    col_indices_ = new_col_indices;
+    values_ = new_values;
 }
 
 // 要素アクセス演算子（非const版）
-double& SparseMatrix::operator()(int row, int index) { return values_[row_pointers_[row] + index]; }
+template <class T>
+T& BasicSparseMatrix<T>::operator()(int row, int index) { return values_[row_pointers_[row] + index]; }
 
 // 要素アクセス演算子（const版）
-double SparseMatrix::operator()(int row, int index) const { return values_[row_pointers_[row] + index]; }
+template <class T>
+T BasicSparseMatrix<T>::operator()(int row, int index) const { return values_[row_pointers_[row] + index]; }
 
 // 非ゼロ要素の値を返す
-double& SparseMatrix::value(int row, int index) { return values_[row_pointers_[row] + index]; }
+template <class T>
+T& BasicSparseMatrix<T>::value(int row, int index) { return values_[row_pointers_[row] + index]; }
 
 // 非ゼロ要素のインデックスを返す
-int& SparseMatrix::dense_index(int row, int index) { return col_indices_[row_pointers_[row] + index]; }
+template <class T>
+int& BasicSparseMatrix<T>::dense_index(int row, int index) { return col_indices_[row_pointers_[row] + index]; }
 
 // インデックスアクセス演算子（非const版）
-int& SparseMatrix::operator()(int row, int index, const char* s) {
+template <class T>
+int& BasicSparseMatrix<T>::operator()(int row, int index, const char* s) {
     if (strcmp(s, "index") != 0) {
         std::cerr << "Invalid string parameter!" << std::endl;
         exit(1);
@@ -93,7 +769,8 @@ int& SparseMatrix::operator()(int row, int index, const char* s) {
 }
 
 // 行の要素数を返す演算子
-int SparseMatrix::operator()(int row, const char* s) const {
+template <class T>
+int BasicSparseMatrix<T>::operator()(int row, const char* s) const {
     if (strcmp(s, "row") != 0) {
         std::cerr << "Invalid string parameter!!" << std::endl;
         exit(1);
@@ -103,63 +780,116 @@ int SparseMatrix::operator()(int row, const char* s) const {
 }
 
 // 行数を返す
-int SparseMatrix::rows() const { return rows_; }
+template <class T>
+int BasicSparseMatrix<T>::rows() const { return rows_; }
 
 // 列数を返す
-int SparseMatrix::cols() const { return cols_; }
+template <class T>
+int BasicSparseMatrix<T>::cols() const { return cols_; }
 
 // 非ゼロ要素数を返す
-int SparseMatrix::nnz() const { return nnz_; }
+template <class T>
+int BasicSparseMatrix<T>::nnz() const { return nnz_; }
 
 // 特定の行の非ゼロ要素数を返す
-int SparseMatrix::nnz(int row) {
+template <class T>
+int BasicSparseMatrix<T>::nnz(int row) {
     int result = row_pointers_[row + 1] - row_pointers_[row];
     return result;
 }
 
 // ゼロ要素を削除した疎行列を返す
-SparseMatrix SparseMatrix::remove_zeros() {
-    // 非ゼロ要素の数を数える
-    int non_zero_count = 0;
-    for (int i = 0; i < nnz_; i++) {
-        if (values_[i] != 0.0) {
-            non_zero_count++;
-        }
-    }
+template <class T>
+BasicSparseMatrix<T> BasicSparseMatrix<T>::remove_zeros() {
+    BasicSparseMatrix<T> non_zero_matrix(*this);
+    non_zero_matrix.prune(0.0);
+    return non_zero_matrix;
+}
 
-    // 新しいスパースマトリクスを作成
-    SparseMatrix non_zero_matrix(rows_, cols_, non_zero_count);
+// 絶対値が threshold 以下の要素をその場で削除し、削除した要素数を返す（threshold が 0 ならゼロ要素を削除する）
+template <class T>
+int BasicSparseMatrix<T>::prune(double threshold) {
+    return prune_if([threshold](int, int, T value) { return std::fabs((double)value) <= threshold; });
+}
 
-    // 新しいスパースマトリクスの行ポインタ、列インデックス、データ
-    int* new_row_pointers = new int[rows_ + 1];
-    int* new_col_indices = new int[non_zero_count];
-    double* new_values = new double[non_zero_count];
-
-    int current_non_zero_index = 0;
-    new_row_pointers[0] = 0;
-
-    for (int i = 0; i < rows_; i++) {
-        for (int j = row_pointers_[i]; j < row_pointers_[i + 1]; j++) {
-            if (values_[j] != 0.0) {
-                new_col_indices[current_non_zero_index] = col_indices_[j];
-                new_values[current_non_zero_index] = values_[j];
-                current_non_zero_index++;
+// remove(行, 列, 値) が真の要素をその場で削除し、削除した要素数を返す
+template <class T>
+int BasicSparseMatrix<T>::prune(const std::function<bool(int, int, T)>& remove) { return prune_if(remove); }
+
+// remove(行, 列, 値) が真の要素をその場で詰めて削除し、削除した要素数を返す
+// 作業列を行の境界でスレッド数以下の区間に分け、区間ごとに残す要素を区間の先頭へ詰めて、行ポインタに区間内の位置を書く
+// 次に区間を順に前へ移動し（移動先と移動元が重ならなければ並列にコピーする）、行ポインタに区間の移動先を足す
+// 配列は確保し直さないので、削除した分の領域は配列の末尾に残る
+template <class T>
+template <class F>
+int BasicSparseMatrix<T>::prune_if(const F& remove) {
+    if (nnz_ == 0) return 0;
+    std::vector<int> part_rows;
+    std::vector<int> part_nzs;
+    int parts = merge_path_partition(row_pointers_, rows_, nnz_, (long long)nnz_ + rows_, part_rows, part_nzs, get_num_threads());
+    std::vector<int> part_starts(parts + 1);
+    for (int p = 0; p <= parts; p++) {
+        part_starts[p] = row_pointers_[part_rows[p]];
+    }
+
+    // 区間ごとに残す要素を区間の先頭へ詰める（区間の先頭の行ポインタは前の区間が書き換えるので part_starts から読む）
+    std::vector<int> kept(parts + 1, 0);
+    parallel_for(0, parts, 1, [&](int begin, int end) {
+        for (int p = begin; p < end; p++) {
+            int dest = part_starts[p];
+            int first = part_starts[p];
+            for (int i = part_rows[p]; i < part_rows[p + 1]; i++) {
+                int last = row_pointers_[i + 1];
+                for (int k = first; k < last; k++) {
+                    if (!remove(i, col_indices_[k], values_[k])) {
+                        col_indices_[dest] = col_indices_[k];
+                        values_[dest] = values_[k];
+                        dest++;
+                    }
+                }
+                row_pointers_[i + 1] = dest - part_starts[p];
+                first = last;
             }
+            kept[p + 1] = dest - part_starts[p];
         }
-        new_row_pointers[i + 1] = current_non_zero_index;
+    });
+    for (int p = 0; p < parts; p++) {
+        kept[p + 1] += kept[p];
     }
 
-    // 新しいスパースマトリクスに行ポインタ、列インデックス、データをセット
-    non_zero_matrix.set_row_pointers(new_row_pointers);
-    non_zero_matrix.set_col_indices(new_col_indices);
-    non_zero_matrix.set_values(new_values);
-    non_zero_matrix.set_nnz(non_zero_count);
+    // 区間を順に前へ移動する
+    for (int p = 1; p < parts; p++) {
+        int source = part_starts[p];
+        int dest = kept[p];
+        int length = kept[p + 1] - kept[p];
+        if (source == dest || length == 0) continue;
+        if (dest + length <= source) {
+            parallel_for(0, length, kParallelGrain, [&](int begin, int end) {
+                std::copy(col_indices_ + source + begin, col_indices_ + source + end, col_indices_ + dest + begin);
+                std::copy(values_ + source + begin, values_ + source + end, values_ + dest + begin);
+            });
+        } else {
+            std::copy(col_indices_ + source, col_indices_ + source + length, col_indices_ + dest);
+            std::copy(values_ + source, values_ + source + length, values_ + dest);
+        }
+    }
 
-    return non_zero_matrix;
+    // 行ポインタに区間の移動先を足す
+    parallel_for(0, parts, 1, [&](int begin, int end) {
+        for (int p = begin; p < end; p++) {
+            for (int i = part_rows[p]; i < part_rows[p + 1]; i++) {
+                row_pointers_[i + 1] += kept[p];
+            }
+        }
+    });
+    int removed = nnz_ - kept[parts];
+    nnz_ = kept[parts];
+    return removed;
 }
 
 // コピー代入演算子
-SparseMatrix& SparseMatrix::operator=(const SparseMatrix& arg) {
+template <class T>
+BasicSparseMatrix<T>& BasicSparseMatrix<T>::operator=(const BasicSparseMatrix<T>& arg) {
     if (this == &arg) {
         return *this; // 自己代入の場合、何もしない
     }
@@ -167,7 +897,7 @@ SparseMatrix& SparseMatrix::operator=(const SparseMatrix& arg) {
     // 新しいリソースを一時的に確保
     int* new_row_pointers = new int[arg.rows_ + 1];
     int* new_col_indices = new int[arg.nnz_];
-    double* new_values = new double[arg.nnz_];
+    T* new_values = new T[arg.nnz_];
 
     // メンバー変数をコピー
     for (int i = 0; i <= arg.rows_; i++) {
@@ -180,9 +910,7 @@ SparseMatrix& SparseMatrix::operator=(const SparseMatrix& arg) {
     }
 
     // 既存のリソースを解放
-    delete[] row_pointers_;
-    delete[] col_indices_;
-    delete[] values_;
+    release();
 
     // メンバー変数を新しいリソースに設定
     row_pointers_ = new_row_pointers;
@@ -196,15 +924,14 @@ SparseMatrix& SparseMatrix::operator=(const SparseMatrix& arg) {
 }
 
 // ムーブ代入演算子
-SparseMatrix& SparseMatrix::operator=(SparseMatrix&& arg) {
+template <class T>
+BasicSparseMatrix<T>& BasicSparseMatrix<T>::operator=(BasicSparseMatrix<T>&& arg) {
     if (this == &arg) {
         return *this; // 自己代入の場合、何もしない
     }
 
     // 既存のリソースを解放
-    delete[] row_pointers_;
-    delete[] col_indices_;
-    delete[] values_;
+    release();
 
     // メンバー変数をムーブ
     rows_ = arg.rows_;
@@ -213,6 +940,8 @@ SparseMatrix& SparseMatrix::operator=(SparseMatrix&& arg) {
     row_pointers_ = arg.row_pointers_;
     col_indices_ = arg.col_indices_;
     values_ = arg.values_;
+    mapping_ = arg.mapping_;
+    mapping_size_ = arg.mapping_size_;
 
     // 右辺値のリソースを無効化
     arg.rows_ = 0;
@@ -221,43 +950,56 @@ SparseMatrix& SparseMatrix::operator=(SparseMatrix&& arg) {
     arg.row_pointers_ = nullptr;
     arg.col_indices_ = nullptr;
     arg.values_ = nullptr;
+    arg.mapping_ = nullptr;
+    arg.mapping_size_ = 0;
 
     return *this;
 }
 
-// 行列の乗算演算子
-Matrix SparseMatrix::operator*(Matrix& arg) {
-    int numRowsResult = rows_;
-    int numColsResult = arg.cols();
-    Matrix result(numRowsResult, numColsResult, 0.0);
-    double* dataA = (*this).get_values();
-    int* dataArowpointers = (*this).get_row_pointers();
-    int* dataAcolindices = (*this).get_col_indices();
-    double* dataB = arg.get_values();
-    double* dataResult = result.get_values();
-
-    for (int i = 0; i < rows_; i++) {
-        for (int j = 0; j < numColsResult; j++) {
-            *(dataResult + j) = 0.0;
-        }
-        int tmp_nnz = (*this).nnz(i);
-        for (int k = 0; k < tmp_nnz; k++) {
-            double* tmp_dataB = dataB + *(dataAcolindices + k) * numColsResult;
-            for (int j = 0; j < numColsResult; j++) {
-                *(dataResult + j) += *(dataA + k) * *(tmp_dataB + j);
-            }
-        }
-        dataA += tmp_nnz;
-        dataResult += numColsResult;
-        dataAcolindices += tmp_nnz;
-    }
+// 行列（ビュー、転置行列を含む）との乗算演算子
+template <class T>
+BasicMatrix<T> BasicSparseMatrix<T>::operator*(const BasicMatrixView<T>& arg) const {
+    BasicMatrix<T> result(rows_, arg.cols());
+    spmm_kernel(1.0, *this, arg, 0.0, BasicMatrixView<T>(result));
+    return result;
+}
+
+// ベクトル（ビューを含む）との乗算演算子
+template <class T>
+BasicVector<T> BasicSparseMatrix<T>::operator*(const BasicVectorView<T>& arg) const {
+    BasicVector<T> result(rows_);
+    spmv_kernel(1.0, *this, arg, 0.0, BasicVectorView<T>(result));
+    return result;
+}
+
+// 疎行列との乗算演算子
+template <class T>
+BasicSparseMatrix<T> BasicSparseMatrix<T>::operator*(const BasicSparseMatrix<T>& arg) const { return spgemm_kernel(*this, arg, 0); }
+
+// y = alpha * A * x + beta * y（spmv と同じ）
+template <class T>
+void BasicSparseMatrix<T>::multiply(double alpha, const BasicVectorView<T>& x, double beta, const BasicVectorView<T>& y) const {
+    spmv_kernel(alpha, *this, x, beta, y);
+}
+
+// C = alpha * A * B + beta * C（spmm と同じ）
+template <class T>
+void BasicSparseMatrix<T>::multiply(double alpha, const BasicMatrixView<T>& B, double beta, const BasicMatrixView<T>& C) const {
+    spmm_kernel(alpha, *this, B, beta, C);
+}
+
+// 転置行列とベクトルの積 A^T * arg を計算する（転置行列は作らない）
+template <class T>
+BasicVector<T> BasicSparseMatrix<T>::transposed_product(const BasicVectorView<T>& arg) const {
+    BasicVector<T> result(cols_);
+    spmv_transposed_kernel(1.0, *this, arg, 0.0, BasicVectorView<T>(result));
     return result;
 }
 
 // 行列の値を表示する
-void SparseMatrix::print_values() {
+template <class T>
+void BasicSparseMatrix<T>::print_values() {
     int rows = (*this).rows();
-    int cols = (*this).cols();
 
     for (int i = 0; i < rows; ++i) {
         for (int j = 0; j < *((*this).get_row_pointers() + i + 1) - *((*this).get_row_pointers() + i); ++j) {
@@ -268,17 +1010,34 @@ void SparseMatrix::print_values() {
 }
 
 // 値のポインタを取得する
-double* SparseMatrix::get_values() { return values_; }
+template <class T>
+T* BasicSparseMatrix<T>::get_values() { return values_; }
 
 // 行ポインタのポインタを取得する
-int* SparseMatrix::get_row_pointers() { return row_pointers_; }
+template <class T>
+int* BasicSparseMatrix<T>::get_row_pointers() { return row_pointers_; }
 
 // 列インデックスのポインタを取得する
-int* SparseMatrix::get_col_indices() { return col_indices_; }
+template <class T>
+int* BasicSparseMatrix<T>::get_col_indices() { return col_indices_; }
+
+// 値のポインタを取得する（const版）
+template <class T>
+const T* BasicSparseMatrix<T>::get_values() const { return values_; }
+
+// 行ポインタのポインタを取得する（const版）
+template <class T>
+const int* BasicSparseMatrix<T>::get_row_pointers() const { return row_pointers_; }
+
+// 列インデックスのポインタを取得する（const版）
+template <class T>
+const int* BasicSparseMatrix<T>::get_col_indices() const { return col_indices_; }
 
 // 新しい行ポインタを設定する
-void SparseMatrix::set_row_pointers(int* new_row_pointers) {
-    // 以前のメモリを解放
+template <class T>
+void BasicSparseMatrix<T>::set_row_pointers(int* new_row_pointers) {
+    // 以前のメモリを解放（ファイルをマップしている場合は先に配列を複製して所有する）
+    detach_mapping();
     if (row_pointers_ != nullptr) delete[] row_pointers_;
 
     // 新しいポインタを設定
@@ -286,8 +1045,10 @@ void SparseMatrix::set_row_pointers(int* new_row_pointers) {
 }
 
 // 新しい列インデックスを設定するメンバ関数
-void SparseMatrix::set_col_indices(int* new_col_indices) {
-    // 以前のメモリを解放
+template <class T>
+void BasicSparseMatrix<T>::set_col_indices(int* new_col_indices) {
+    // 以前のメモリを解放（ファイルをマップしている場合は先に配列を複製して所有する）
+    detach_mapping();
     if (col_indices_ != nullptr) delete[] col_indices_;
 
     // 新しいポインタを設定
@@ -295,8 +1056,10 @@ void SparseMatrix::set_col_indices(int* new_col_indices) {
 }
 
 // 新しい値を設定するメンバ関数
-void SparseMatrix::set_values(double* new_values) {
-    // 以前のメモリを解放
+template <class T>
+void BasicSparseMatrix<T>::set_values(T* new_values) {
+    // 以前のメモリを解放（ファイルをマップしている場合は先に配列を複製して所有する）
+    detach_mapping();
     if (values_ != nullptr) delete[] values_;
 
     // 新しいポインタを設定
@@ -304,107 +1067,260 @@ void SparseMatrix::set_values(double* new_values) {
 }
 
 // 非ゼロ要素数を設定する
-void SparseMatrix::set_nnz(int nnz) { nnz_ = nnz; }
+template <class T>
+void BasicSparseMatrix<T>::set_nnz(int nnz) {
+    // ファイルをマップしている場合は、元の大きさのまま配列を複製してから変更する
+    detach_mapping();
+    nnz_ = nnz;
+}
 
 // 転置行列を返す
-SparseMatrix SparseMatrix::transpose() {
-    // 転置行列の行数と列数は元の行列の列数と行数になります
-    SparseMatrix transposed(cols_, rows_);
-
-    // 転置行列の行ポインタ
-    int* transposed_row_pointers = new int[cols_ + 1];
+template <class T>
+BasicSparseMatrix<T> BasicSparseMatrix<T>::transpose() const {
+    BasicSparseMatrix<T> transposed;
+    transpose(transposed);
+    return transposed;
+}
 
-    // 各列に含まれる非ゼロ要素の数を数える
-    int* count_non_zeros = new int[cols_];
-    for (int i = 0; i < cols_; i++) {
-        count_non_zeros[i] = 0;
+// 転置行列を result に書き込む（result の大きさと非ゼロ要素数が同じなら配列を再利用する）
+// 作業列をスレッド数以下の区間に分け、区間ごとの列ヒストグラム、列方向の累積和、区間ごとの書き込みを並列に行う
+// 各列の中では区間の順、区間の中では行の順に書き込むので、転置行列の列インデックスは昇順に並ぶ
+template <class T>
+void BasicSparseMatrix<T>::transpose(BasicSparseMatrix& result) const {
+    if (&result == this) {
+        BasicSparseMatrix<T> transposed;
+        transpose(transposed);
+        result = std::move(transposed);
+        return;
     }
-    for (int i = 0; i < nnz_; i++) {
-        count_non_zeros[col_indices_[i]]++;
+    if (result.mapping_ != nullptr) {
+        result.release();
     }
-
-    // 転置行列の行ポインタを設定
-    transposed_row_pointers[0] = 0;
-    for (int i = 1; i <= cols_; i++) {
-        transposed_row_pointers[i] = transposed_row_pointers[i - 1] + count_non_zeros[i - 1];
+    if (result.rows_ != cols_ || result.row_pointers_ == nullptr) {
+        delete[] result.row_pointers_;
+        result.row_pointers_ = new int[cols_ + 1];
     }
-
-    // 転置行列の列インデックスとデータ
-    int* transposed_col_indices = new int[nnz_];
-    double* transposed_values = new double[nnz_];
-
-    // 一時的な配列を用意して、各列に挿入される行の位置を管理します
-    int* current_row = new int[cols_];
-    for (int i = 0; i < cols_; i++) {
-        current_row[i] = transposed_row_pointers[i];
+    if (result.nnz_ != nnz_ || result.col_indices_ == nullptr || result.values_ == nullptr) {
+        delete[] result.col_indices_;
+        delete[] result.values_;
+        result.col_indices_ = new int[nnz_];
+        result.values_ = new T[nnz_];
     }
+    result.rows_ = cols_;
+    result.cols_ = rows_;
+    result.nnz_ = nnz_;
+
+    int rows = rows_;
+    int cols = cols_;
+    const int* row_pointers = row_pointers_;
+    const int* col_indices = col_indices_;
+    const T* values = values_;
+    int* transposed_row_pointers = result.row_pointers_;
+    int* transposed_col_indices = result.col_indices_;
+    T* transposed_values = result.values_;
+
+    std::vector<int> part_rows;
+    std::vector<int> part_nzs;
+    int parts = merge_path_partition(row_pointers, rows, nnz_, (long long)nnz_ + rows, part_rows, part_nzs, get_num_threads());
+
+    // 区間ごとに各列の非ゼロ要素数を数える
+    std::vector<std::vector<int> > counts(parts);
+    parallel_for(0, parts, 1, [&](int begin, int end) {
+        for (int p = begin; p < end; p++) {
+            std::vector<int>& count = counts[p];
+            count.assign(cols, 0);
+            for (int k = part_nzs[p]; k < part_nzs[p + 1]; k++) {
+                count[col_indices[k]]++;
+            }
+        }
+    });
+
+    // 列ごとに区間の順で累積し、各区間が書き込む列内の位置と列の非ゼロ要素数を求める
+    int column_grain = std::max(1, kParallelGrain / parts);
+    parallel_for(0, cols, column_grain, [&](int begin, int end) {
+        for (int j = begin; j < end; j++) {
+            int sum = 0;
+            for (int p = 0; p < parts; p++) {
+                int count = counts[p][j];
+                counts[p][j] = sum;
+                sum += count;
+            }
+            transposed_row_pointers[j + 1] = sum;
+        }
+    });
 
-    // 転置行列を生成
-    for (int i = 0; i < rows_; i++) {
-        for (int j = row_pointers_[i]; j < row_pointers_[i + 1]; j++) {
-            int col = col_indices_[j];
-            int dest = current_row[col];
+    // 列の非ゼロ要素数の累積和で行ポインタを作る
+    transposed_row_pointers[0] = 0;
+    parallel_prefix_sum(transposed_row_pointers + 1, cols);
+
+    // 区間ごとに非ゼロ要素を転置行列の位置に書き込む
+    parallel_for(0, parts, 1, [&](int begin, int end) {
+        for (int p = begin; p < end; p++) {
+            std::vector<int>& position = counts[p];
+            int first_row = part_rows[p];
+            int last_row = part_rows[p + 1];
+            for (int i = first_row; i <= last_row && i < rows; i++) {
+                int first = i == first_row ? part_nzs[p] : row_pointers[i];
+                int last = i == last_row ? part_nzs[p + 1] : row_pointers[i + 1];
+                for (int k = first; k < last; k++) {
+                    int col = col_indices[k];
+                    int dest = transposed_row_pointers[col] + position[col]++;
+                    transposed_col_indices[dest] = i;
+                    transposed_values[dest] = values[k];
+                }
+            }
+        }
+    });
+}
 
-            transposed_col_indices[dest] = i;
-            transposed_values[dest] = values_[j];
+// 行列の積を計算する
+template <class T>
+void BasicSparseMatrix<T>::product(BasicMatrix<T>& lhs, BasicMatrix<T>& transpose_rhs) { product(BasicMatrixView<T>(lhs), BasicMatrixView<T>(transpose_rhs)); }
 
-            current_row[col]++;
-        }
-    }
+// ビュー（転置行列を含む）との行列の積を計算する（非ゼロ要素の位置のみ、結果で値を上書きする）
+template <class T>
+void BasicSparseMatrix<T>::product(const BasicMatrixView<T>& lhs, const BasicMatrixView<T>& transpose_rhs) {
+    sddmm_kernel(*this, lhs, transpose_rhs, values_);
+}
 
-    // 転置行列に行ポインタ、列インデックス、データをセット
-    transposed.set_row_pointers(transposed_row_pointers);
-    transposed.set_col_indices(transposed_col_indices);
-    transposed.set_values(transposed_values);
-    transposed.set_nnz(nnz_);
+// ビュー（転置行列を含む）との行列の積を非ゼロ要素の位置について計算し、result に書き込む
+// result が同じ大きさで同じ非ゼロ要素数なら同じ非ゼロパターンを持つものとして値だけを書き込み、そうでなければこの行列をコピーする
+template <class T>
+void BasicSparseMatrix<T>::product(const BasicMatrixView<T>& lhs, const BasicMatrixView<T>& transpose_rhs, BasicSparseMatrix& result) const {
+    if (result.rows_ != rows_ || result.cols_ != cols_ || result.nnz_ != nnz_ || result.values_ == nullptr) {
+        result = *this;
+    }
+    sddmm_kernel(*this, lhs, transpose_rhs, result.values_);
+}
 
-    // 元の行列から作成したポインタを解放
-    delete[] count_non_zeros;
-    delete[] current_row;
+// バイナリ形式でファイルに保存する
+template <class T>
+void BasicSparseMatrix<T>::save_binary(const char* filename) const {
+    SparseMatrixFileHeader header = make_header(rows_, cols_, nnz_, sizeof(T));
+    FILE* file = fopen(filename, "wb");
+    if (file == nullptr) {
+        std::cerr << "SparseMatrix::save_binary(const char *): Cannot open " << filename << std::endl;
+        exit(1);
+    }
+    const int empty_row_pointers[1] = {0};
+    const char padding[kSparseMatrixAlignment] = {0};
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    uint64_t written = sizeof(header);
+    // 各配列の前に64バイト境界までの詰め物を書く
+    auto write_array = [&](uint64_t offset, const void* data, uint64_t bytes) {
+        ok = ok && fwrite(padding, 1, offset - written, file) == offset - written;
+        ok = ok && (bytes == 0 || fwrite(data, 1, bytes, file) == bytes);
+        written = offset + bytes;
+    };
+    write_array(header.row_pointers_offset, row_pointers_ != nullptr ? row_pointers_ : empty_row_pointers, (uint64_t)(rows_ + 1) * sizeof(int));
+    write_array(header.col_indices_offset, col_indices_, (uint64_t)nnz_ * sizeof(int));
+    write_array(header.values_offset, values_, (uint64_t)nnz_ * sizeof(T));
+    if (fclose(file) != 0 || !ok) {
+        std::cerr << "SparseMatrix::save_binary(const char *): Write failed " << filename << std::endl;
+        exit(1);
+    }
+}
 
-    return transposed;
+// バイナリ形式のファイルを読み込む（配列を確保してコピーする）
+// コピーした後で行ポインタと列インデックスをすべて検査し、壊れたファイルは範囲外のアクセスになる前に終了する
+template <class T>
+BasicSparseMatrix<T> BasicSparseMatrix<T>::load_binary(const char* filename) {
+    FILE* file = fopen(filename, "rb");
+    if (file == nullptr) {
+        std::cerr << "SparseMatrix::load_binary(const char *): Cannot open " << filename << std::endl;
+        exit(1);
+    }
+    SparseMatrixFileHeader header;
+    struct stat status;
+    if (fread(&header, sizeof(header), 1, file) != 1 || fstat(fileno(file), &status) != 0) {
+        std::cerr << "SparseMatrix::load_binary(const char *): Read failed " << filename << std::endl;
+        exit(1);
+    }
+    check_header(header, (uint64_t)status.st_size, sizeof(T), filename);
+
+    BasicSparseMatrix<T> result((int)header.rows, (int)header.cols, (int)header.nnz);
+    // 各配列の位置に移動して読み込む
+    auto read_array = [&](uint64_t offset, void* data, uint64_t bytes) {
+        return fseek(file, (long)offset, SEEK_SET) == 0 && (bytes == 0 || fread(data, 1, bytes, file) == bytes);
+    };
+    bool ok = read_array(header.row_pointers_offset, result.row_pointers_, (uint64_t)(result.rows_ + 1) * sizeof(int)) &&
+              read_array(header.col_indices_offset, result.col_indices_, (uint64_t)result.nnz_ * sizeof(int)) &&
+              read_array(header.values_offset, result.values_, (uint64_t)result.nnz_ * sizeof(T));
+    fclose(file);
+    if (!ok || !valid_structure(result.rows_, result.cols_, result.nnz_, result.row_pointers_, result.col_indices_)) {
+        std::cerr << "SparseMatrix::load_binary(const char *): Broken file " << filename << std::endl;
+        exit(1);
+    }
+    return result;
 }
 
-// 行列の積を計算する
-void SparseMatrix::product(Matrix& lhs, Matrix& transpose_rhs) {
-    int numrows_A = lhs.rows();
-    int numcols_A = lhs.cols();
-    int numrows_B = transpose_rhs.rows();
-    int numcols_B = transpose_rhs.cols();
-
-    for (int i = 0; i < rows_; i++) {
-        int tmp_nnz = (*this).nnz(i);
-        for (int j = 0; j < tmp_nnz; j++) {
-            double tmp_result = 0.0;
-            for (int k = 0; k < numcols_A; k++) {
-                tmp_result += lhs(i, k) * transpose_rhs((*this).dense_index(i, j), k);
-            }
-            (*this)(i, j) = tmp_result;
-        }
+// バイナリ形式のファイルをマップして、コピーせずに配列として使う
+// 書き込み可能なプライベートマップにするので、複数のプロセスが同じページキャッシュを共有し、値を書き換えたページだけが複製される
+// 読み込みの時点では行ポインタの末尾のみを確認し、配列全体には触れない
+// 行ポインタの単調性や列インデックスの範囲は検査せず、ファイルを信頼する（信頼できないファイルは load_binary で読む）
+template <class T>
+BasicSparseMatrix<T> BasicSparseMatrix<T>::map_binary(const char* filename) {
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "SparseMatrix::map_binary(const char *): Cannot open " << filename << std::endl;
+        exit(1);
+    }
+    struct stat status;
+    SparseMatrixFileHeader header;
+    if (fstat(fd, &status) != 0 || pread(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header)) {
+        std::cerr << "SparseMatrix::map_binary(const char *): Read failed " << filename << std::endl;
+        exit(1);
+    }
+    check_header(header, (uint64_t)status.st_size, sizeof(T), filename);
+    size_t size = (size_t)header.file_size;
+    void* mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        std::cerr << "SparseMatrix::map_binary(const char *): mmap failed " << filename << std::endl;
+        exit(1);
+    }
+
+    BasicSparseMatrix<T> result;
+    char* base = static_cast<char*>(mapping);
+    result.rows_ = (int)header.rows;
+    result.cols_ = (int)header.cols;
+    result.nnz_ = (int)header.nnz;
+    result.row_pointers_ = reinterpret_cast<int*>(base + header.row_pointers_offset);
+    result.col_indices_ = reinterpret_cast<int*>(base + header.col_indices_offset);
+    result.values_ = reinterpret_cast<T*>(base + header.values_offset);
+    result.mapping_ = mapping;
+    result.mapping_size_ = size;
+    if (result.row_pointers_[result.rows_] != result.nnz_) {
+        std::cerr << "SparseMatrix::map_binary(const char *): Broken file " << filename << std::endl;
+        exit(1);
     }
+    return result;
 }
 
+// 配列がファイルをマップした領域を指しているかを返す
+template <class T>
+bool BasicSparseMatrix<T>::mapped() const { return mapping_ != nullptr; }
+
 // ワンホットエンコードを行う
-SparseMatrix SparseMatrix::one_hot_encode() {
-    // 一時的な行列を作成する（要素が全てゼロの疎行列）
-    SparseMatrix encoded(nnz_, rows_ + cols_, nnz_ * 2);
-
-    double* encoded_values = encoded.get_values();
-    int* encoded_col_indices = encoded.get_col_indices();
-    int* encoded_row_pointers = encoded.get_row_pointers();
-    for (int i = 0; i <= nnz_; i++) {
-        encoded_row_pointers[i] = 2 * i;
-    }
-    int k = 0;
-    for (int i = 0; i < rows_; i++) {
-        for (int j = 0; j < (*this).nnz(i); j++) {
-            encoded_values[k] = i; // 1
-            encoded_col_indices[k] = i;
-            k++;
-            encoded_values[k] = i; // 1
-            encoded_col_indices[k] = rows_ + (*this).dense_index(i, j);
-            k++;
-        }
-    }
-    return encoded;
-}
\ No newline at end of file
+// 計画行列のビュー（FmDesignMatrix）を作って CSR 形式にする（r 番目の非ゼロ要素 (i, j) が列 i と列 rows + j の値 1 の行になる）
+template <class T>
+BasicSparseMatrix<T> BasicSparseMatrix<T>::one_hot_encode() { return BasicFmDesignMatrix<T>(*this).materialize(); }
+// C = alpha * A * B + beta * C を計算する関数
+void spmm(double alpha, const SparseMatrix& A, const MatrixView& B, double beta, const MatrixView& C) { spmm_kernel(alpha, A, B, beta, C); }
+void spmm(double alpha, const FloatSparseMatrix& A, const FloatMatrixView& B, double beta, const FloatMatrixView& C) { spmm_kernel(alpha, A, B, beta, C); }
+
+// A * B を計算する関数
+SparseMatrix spgemm(const SparseMatrix& A, const SparseMatrix& B, int top_k) { return spgemm_kernel(A, B, top_k); }
+FloatSparseMatrix spgemm(const FloatSparseMatrix& A, const FloatSparseMatrix& B, int top_k) { return spgemm_kernel(A, B, top_k); }
+
+// y = alpha * A * x + beta * y を計算する関数
+void spmv(double alpha, const SparseMatrix& A, const VectorView& x, double beta, const VectorView& y) { spmv_kernel(alpha, A, x, beta, y); }
+void spmv(double alpha, const FloatSparseMatrix& A, const FloatVectorView& x, double beta, const FloatVectorView& y) { spmv_kernel(alpha, A, x, beta, y); }
+
+// y = alpha * A^T * x + beta * y を計算する関数
+void spmv_transposed(double alpha, const SparseMatrix& A, const VectorView& x, double beta, const VectorView& y) { spmv_transposed_kernel(alpha, A, x, beta, y); }
+void spmv_transposed(double alpha, const FloatSparseMatrix& A, const FloatVectorView& x, double beta, const FloatVectorView& y) { spmv_transposed_kernel(alpha, A, x, beta, y); }
+
+// 倍精度と単精度で実体化する
+template class BasicSparseMatrix<double>;
+template class BasicSparseMatrix<float>;
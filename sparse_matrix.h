@@ -1,50 +1,105 @@
+#include <cstddef> // size_t の標準ライブラリ
+#include <functional> // 関数オブジェクトの標準ライブラリ
+
 #include "matrix.h"
 #ifndef __SPARSE_MATRIX__
 #define __SPARSE_MATRIX__
 
 //計算速度を向上させるために、直接アドレスを参照して計算を行っている
-class SparseMatrix {
+// 非ゼロ要素の型 T（float または double）を指定する
+// map_binary で読み込んだ行列はファイルのページキャッシュを共有し、値を書き換えたページだけがプロセスごとに複製される
+template <class T>
+class BasicSparseMatrix {
    private:
     int rows_;          // 行数
     int cols_;          // 列数
     int nnz_;           // 非ゼロ要素数
     int* row_pointers_; // 行ポインタ配列
     int* col_indices_;  // 列インデックス配列
-    double* values_;    // 非ゼロ要素の値
+    T* values_;         // 非ゼロ要素の値
+    void* mapping_ = nullptr; // ファイルをマップした領域（配列がこの中を指す場合は new[] で確保していない）
+    size_t mapping_size_ = 0; // マップした領域の大きさ
+
+    void release();                             // 配列を解放する（マップした領域なら munmap する）
+    void detach_mapping();                      // マップした配列を new[] で確保した配列に複製し、マップを解除する
+    template <class F>
+    int prune_if(const F& remove);              // remove(行, 列, 値) が真の要素をその場で詰めて削除し、削除した要素数を返す
 
    public:
-    SparseMatrix(int rows, int cols);           // コンストラクタ
-    SparseMatrix(int rows, int cols, int nnz);  // コンストラクタ
-    SparseMatrix();                             // デフォルトコンストラクタ
-    SparseMatrix(const SparseMatrix& arg);      // コピーコンストラクタ
-    SparseMatrix(int size, const char* s);      // 特殊なコンストラクタ
-    ~SparseMatrix();                            // デストラクタ
-    double& operator()(int row, int index);     // 要素アクセス演算子（非const版）
-    double operator()(int row, int index) const; // 要素アクセス演算子（const版）
+    BasicSparseMatrix(int rows, int cols);      // コンストラクタ
+    BasicSparseMatrix(int rows, int cols, int nnz); // コンストラクタ
+    BasicSparseMatrix();                        // デフォルトコンストラクタ
+    BasicSparseMatrix(const BasicSparseMatrix& arg); // コピーコンストラクタ
+    BasicSparseMatrix(BasicSparseMatrix&& arg); // ムーブコンストラクタ
+    BasicSparseMatrix(int size, const char* s); // 特殊なコンストラクタ
+    ~BasicSparseMatrix();                       // デストラクタ
+    T& operator()(int row, int index);          // 要素アクセス演算子（非const版）
+    T operator()(int row, int index) const;      // 要素アクセス演算子（const版）
     int& operator()(int row, int index, const char* s); // インデックスアクセス演算子（非const版）
     int operator()(int row, int index, const char* s) const; // インデックスアクセス演算子（const版）
     int operator()(int row, const char* s) const; // 行の要素数を返す演算子
-    double& value(int row, int index);          // 非ゼロ要素の値を返す
+    T& value(int row, int index);               // 非ゼロ要素の値を返す
     int& dense_index(int row, int index);       // 非ゼロ要素のインデックスを返す
     int rows() const;                           // 行数を返す
     int cols() const;                           // 列数を返す
     int nnz() const;                            // 非ゼロ要素数を返す
     int nnz(int row);                           // 特定の行の非ゼロ要素数を返す
-    SparseMatrix remove_zeros();                // ゼロ要素を削除した疎行列を返す
-    SparseMatrix& operator=(const SparseMatrix& arg); // コピー代入演算子
-    SparseMatrix& operator=(SparseMatrix&& arg); // ムーブ代入演算子
-    Matrix operator*(Matrix& arg);              // 行列の乗算演算子
+    BasicSparseMatrix remove_zeros();           // ゼロ要素を削除した疎行列を返す
+    int prune(double threshold = 0.0);          // 絶対値が threshold 以下の要素をその場で削除し、削除した要素数を返す
+    int prune(const std::function<bool(int, int, T)>& remove); // remove(行, 列, 値) が真の要素をその場で削除し、削除した要素数を返す（並列に呼ばれる）
+    BasicSparseMatrix& operator=(const BasicSparseMatrix& arg); // コピー代入演算子
+    BasicSparseMatrix& operator=(BasicSparseMatrix&& arg); // ムーブ代入演算子
+    BasicMatrix<T> operator*(const BasicMatrixView<T>& arg) const; // 行列（ビュー、転置行列を含む）との乗算演算子
+    BasicVector<T> operator*(const BasicVectorView<T>& arg) const; // ベクトル（ビューを含む）との乗算演算子
+    BasicSparseMatrix operator*(const BasicSparseMatrix& arg) const; // 疎行列との乗算演算子（spgemm と同じ）
+    void multiply(double alpha, const BasicVectorView<T>& x, double beta, const BasicVectorView<T>& y) const; // y = alpha * A * x + beta * y（spmv と同じ）
+    void multiply(double alpha, const BasicMatrixView<T>& B, double beta, const BasicMatrixView<T>& C) const; // C = alpha * A * B + beta * C（spmm と同じ）
+    BasicVector<T> transposed_product(const BasicVectorView<T>& arg) const; // 転置行列とベクトルの積を計算する（転置行列は作らない）
     void print_values();                        // 行列の値を表示する
-    double* get_values();                       // 値のポインタを取得する
+    T* get_values();                            // 値のポインタを取得する
     int* get_row_pointers();                    // 行ポインタのポインタを取得する
     int* get_col_indices();                     // 列インデックスのポインタを取得する
+    const T* get_values() const;                // 値のポインタを取得する（const版）
+    const int* get_row_pointers() const;        // 行ポインタのポインタを取得する（const版）
+    const int* get_col_indices() const;         // 列インデックスのポインタを取得する（const版）
     void set_row_pointers(int* new_row_pointers); // 新しい行ポインタを設定する
     void set_col_indices(int* new_col_indices); // 新しい列インデックスを設定する
-    void set_values(double* new_values);        // 新しい値を設定する
+    void set_values(T* new_values);             // 新しい値を設定する
     void set_nnz(int nnz);                      // 非ゼロ要素数を設定する
-    SparseMatrix transpose();                   // 転置行列を返す
-    void product(Matrix& lhs, Matrix& rhs);     // 行列の積を計算する
-    SparseMatrix one_hot_encode();              // ワンホットエンコードを行う(Factorization Machine用)
+    BasicSparseMatrix transpose() const;        // 転置行列を返す
+    void transpose(BasicSparseMatrix& result) const; // 転置行列を result に書き込む（同じ大きさなら配列を再利用する）
+    void product(BasicMatrix<T>& lhs, BasicMatrix<T>& rhs); // 行列の積を計算する
+    void product(const BasicMatrixView<T>& lhs, const BasicMatrixView<T>& transpose_rhs); // ビュー（転置行列を含む）との行列の積を計算する
+    void product(const BasicMatrixView<T>& lhs, const BasicMatrixView<T>& transpose_rhs, BasicSparseMatrix& result) const; // 積を result に書き込む（この行列の値は変更しない）
+    void save_binary(const char* filename) const; // バイナリ形式でファイルに保存する
+    static BasicSparseMatrix load_binary(const char* filename); // バイナリ形式のファイルを読み込む（配列を確保してコピーし、行ポインタと列インデックスを検査する）
+    static BasicSparseMatrix map_binary(const char* filename); // バイナリ形式のファイルをマップして、コピーせずに配列として使う（中身は検査せず、ファイルを信頼する）
+    bool mapped() const;                        // 配列がファイルをマップした領域を指しているかを返す
+    BasicSparseMatrix one_hot_encode();         // ワンホットエンコードを行う(Factorization Machine用)
 };
 
+typedef BasicSparseMatrix<double> SparseMatrix;
+typedef BasicSparseMatrix<float> FloatSparseMatrix;
+
+// C = alpha * A * B + beta * C を計算する関数（A は疎行列、B と C はビュー）
+// 行数と非ゼロ要素数の和で作業を均等に分割するため、非ゼロ要素が一部の行に偏っていても各スレッドの負荷が揃う
+// ビューへの変換を使うため、double 版と float 版をそれぞれ非テンプレートの関数として宣言する
+void spmm(double alpha, const SparseMatrix& A, const MatrixView& B, double beta, const MatrixView& C);
+void spmm(double alpha, const FloatSparseMatrix& A, const FloatMatrixView& B, double beta, const FloatMatrixView& C);
+
+// y = alpha * A * x + beta * y を計算する関数（x と y は重ならないこと）
+void spmv(double alpha, const SparseMatrix& A, const VectorView& x, double beta, const VectorView& y);
+void spmv(double alpha, const FloatSparseMatrix& A, const FloatVectorView& x, double beta, const FloatVectorView& y);
+
+// y = alpha * A^T * x + beta * y を CSR のまま計算する関数（x と y は重ならないこと）
+// スレッドごとの作業ベクトルに足し込んでから合計するため、同じ列への書き込みが競合しない
+void spmv_transposed(double alpha, const SparseMatrix& A, const VectorView& x, double beta, const VectorView& y);
+void spmv_transposed(double alpha, const FloatSparseMatrix& A, const FloatVectorView& x, double beta, const FloatVectorView& y);
+
+// A * B を計算する関数（A と B はどちらも疎行列）
+// 記号的な段階で結果の非ゼロ要素数を正確に数えてから値を計算し、行ごとに計算量に応じて密な作業配列かハッシュ表で集計する
+// top_k > 0 の場合は各行で絶対値の大きい top_k 個の要素だけを残す（共起行列などの結果をメモリに収めるため）
+SparseMatrix spgemm(const SparseMatrix& A, const SparseMatrix& B, int top_k = 0);
+FloatSparseMatrix spgemm(const FloatSparseMatrix& A, const FloatSparseMatrix& B, int top_k = 0);
+
 #endif // __SPARSE_MATRIX__
\ No newline at end of file
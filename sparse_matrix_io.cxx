@@ -0,0 +1,454 @@
+#include "sparse_matrix_io.h"
+
+#include <fcntl.h>
+#include <locale.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// 1つの塊として解析するバイト数
+const size_t kIoChunkBytes = 1 << 23;
+
+// 10 の累乗（double で正確に表せる範囲）
+const double kPow10[23] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                           1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+// 読み込み専用でマップしたファイル
+class MappedFile {
+   private:
+    const char* data_;  // ファイルの先頭
+    size_t size_;       // ファイルの大きさ
+
+   public:
+    // ファイルを開いてマップするコンストラクタ（開けなければ終了する）
+    MappedFile(const char* filename, const char* caller) : data_(nullptr), size_(0) {
+        int fd = open(filename, O_RDONLY);
+        struct stat status;
+        if (fd < 0 || fstat(fd, &status) != 0) {
+            std::cerr << caller << ": Cannot open " << filename << std::endl;
+            exit(1);
+        }
+        size_ = (size_t)status.st_size;
+        if (size_ > 0) {
+            void* mapping = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping == MAP_FAILED) {
+                std::cerr << caller << ": mmap failed " << filename << std::endl;
+                exit(1);
+            }
+            madvise(mapping, size_, MADV_SEQUENTIAL);
+            data_ = static_cast<const char*>(mapping);
+        }
+        close(fd);
+    }
+    // マップを解除するデストラクタ
+    ~MappedFile() {
+        if (data_ != nullptr) munmap(const_cast<char*>(data_), size_);
+    }
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+};
+
+// 行の書式
+struct LineFormat {
+    char delimiter;  // 区切り文字（' ' の場合は空白とタブの並び）
+    char comment;    // この文字で始まる行は読み飛ばす
+    int base;        // インデックスの始まり（0 または 1）
+    int mirror;      // 対角以外の要素を反対側に追加するか（0: しない、1: 対称、-1: 歪対称）
+    bool pattern;    // 値の列がなく、値をすべて 1 とするか
+    int rows;        // 行数（負の場合は行インデックスの上限を検査しない）
+    int cols;        // 列数（負の場合は列インデックスの上限を検査しない）
+};
+
+// 1つの塊の解析結果
+template <class T>
+struct ParsedChunk {
+    std::vector<int> rows;     // 行インデックス
+    std::vector<int> cols;     // 列インデックス
+    std::vector<T> values;     // 値
+    int max_row;               // 最大の行インデックス
+    int max_col;               // 最大の列インデックス
+    long long entries;         // 読み込んだ行の数（反対側に追加した要素は数えない）
+    long long error;           // 書式の誤りがあった行の先頭のバイト位置（誤りがなければ -1）
+    bool out_of_range;         // 誤りがインデックスの範囲外か
+};
+
+// 行内の空白（改行以外）かを返す
+inline bool is_blank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+// 空白を読み飛ばす
+inline void skip_blanks(const char*& p, const char* end) {
+    while (p < end && is_blank(*p)) p++;
+}
+
+// 10進数の整数を読む
+bool parse_index(const char*& p, const char* end, long long& result) {
+    const char* start = p;
+    long long value = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        value = value * 10 + (*p - '0');
+        if (value > INT_MAX) return false;
+        p++;
+    }
+    result = value;
+    return p != start;
+}
+
+// "C" ロケールを返す（最初に呼ばれたときに作る）
+locale_t c_locale(void) {
+    static locale_t locale = newlocale(LC_NUMERIC_MASK, "C", (locale_t)0);
+    return locale;
+}
+
+// 実数を読む（符号、小数点、指数を扱う）
+// 仮数が 2^53 以下で指数が小さければ double の1回の乗除算で正しく丸め、それ以外は語を "C" ロケールの strtod_l で正しく丸める
+bool parse_real(const char*& p, const char* end, double& result) {
+    const char* start = p;
+    bool negative = false;
+    if (p < end && (*p == '+' || *p == '-')) {
+        negative = *p == '-';
+        p++;
+    }
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    bool any = false;
+    bool truncated = false;
+    while (p < end && *p >= '0' && *p <= '9') {
+        if (digits < 19) {
+            mantissa = mantissa * 10 + (*p - '0');
+            if (mantissa != 0) digits++;
+        } else {
+            truncated = truncated || *p != '0';
+            exponent++;
+        }
+        any = true;
+        p++;
+    }
+    if (p < end && *p == '.') {
+        p++;
+        while (p < end && *p >= '0' && *p <= '9') {
+            if (digits < 19) {
+                mantissa = mantissa * 10 + (*p - '0');
+                if (mantissa != 0) digits++;
+                exponent--;
+            } else {
+                truncated = truncated || *p != '0';
+            }
+            any = true;
+            p++;
+        }
+    }
+    if (!any) return false;
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        p++;
+        bool negative_exponent = false;
+        if (p < end && (*p == '+' || *p == '-')) {
+            negative_exponent = *p == '-';
+            p++;
+        }
+        long long value;
+        if (!parse_index(p, end, value)) return false;
+        exponent += negative_exponent ? -(int)std::min(value, 100000LL) : (int)std::min(value, 100000LL);
+    }
+    if (mantissa == 0 && !truncated) {
+        result = negative ? -0.0 : 0.0;
+        return true;
+    }
+    if (!truncated && mantissa <= (1ULL << 53) && exponent >= -22 && exponent <= 22) {
+        double value = (double)mantissa;
+        value = exponent < 0 ? value / kPow10[-exponent] : value * kPow10[exponent];
+        result = negative ? -value : value;
+        return true;
+    }
+    // 語を終端文字付きで写して変換する（ロケールの小数点に依存しない）
+    char buffer[128];
+    std::string long_token;
+    size_t length = (size_t)(p - start);
+    const char* token = buffer;
+    if (length < sizeof(buffer)) {
+        memcpy(buffer, start, length);
+        buffer[length] = '\0';
+    } else {
+        long_token.assign(start, length);
+        token = long_token.c_str();
+    }
+    char* token_end;
+    result = strtod_l(token, &token_end, c_locale());
+    return token_end == token + length;
+}
+
+// 区切り文字を読み飛ばす
+bool skip_delimiter(const char*& p, const char* end, char delimiter) {
+    const char* start = p;
+    skip_blanks(p, end);
+    if (delimiter == ' ') return p != start;
+    if (p >= end || *p != delimiter) return false;
+    p++;
+    skip_blanks(p, end);
+    return true;
+}
+
+// 行インデックス row、列インデックス col が行列の大きさに収まるかを返す
+inline bool in_range(long long row, long long col, const LineFormat& format) {
+    return row >= 0 && col >= 0 && (format.rows < 0 || row < format.rows) && (format.cols < 0 || col < format.cols);
+}
+
+// [p, end) の1行を解析して chunk に追加する（空行と注釈行は何もしない）
+// インデックスが範囲外の場合は chunk.out_of_range を立てて false を返す
+template <class T>
+bool parse_line(const char* p, const char* end, const LineFormat& format, ParsedChunk<T>& chunk) {
+    skip_blanks(p, end);
+    if (p == end || *p == format.comment) return true;
+    long long row, col;
+    double value = 1.0;
+    if (!parse_index(p, end, row) || !skip_delimiter(p, end, format.delimiter) || !parse_index(p, end, col)) return false;
+    if (!format.pattern && (!skip_delimiter(p, end, format.delimiter) || !parse_real(p, end, value))) return false;
+    skip_blanks(p, end);
+    if (p != end) return false;
+    row -= format.base;
+    col -= format.base;
+    if (!in_range(row, col, format) || (format.mirror != 0 && !in_range(col, row, format))) {
+        chunk.out_of_range = true;
+        return false;
+    }
+    chunk.rows.push_back((int)row);
+    chunk.cols.push_back((int)col);
+    chunk.values.push_back((T)value);
+    chunk.max_row = std::max(chunk.max_row, (int)row);
+    chunk.max_col = std::max(chunk.max_col, (int)col);
+    chunk.entries++;
+    if (format.mirror != 0 && row != col) {
+        chunk.rows.push_back((int)col);
+        chunk.cols.push_back((int)row);
+        chunk.values.push_back((T)(format.mirror * value));
+        chunk.max_row = std::max(chunk.max_row, (int)col);
+        chunk.max_col = std::max(chunk.max_col, (int)row);
+    }
+    return true;
+}
+
+// [begin, end) に先頭がある行を解析する（begin が行の途中なら次の行から始める）
+template <class T>
+void parse_chunk(const char* data, size_t size, size_t body, size_t begin, size_t end, const LineFormat& format, ParsedChunk<T>& chunk) {
+    chunk.rows.clear();
+    chunk.cols.clear();
+    chunk.values.clear();
+    chunk.max_row = -1;
+    chunk.max_col = -1;
+    chunk.entries = 0;
+    chunk.error = -1;
+    chunk.out_of_range = false;
+    if (begin > body && data[begin - 1] != '\n') {
+        const char* newline = static_cast<const char*>(memchr(data + begin, '\n', size - begin));
+        begin = newline == nullptr ? size : (size_t)(newline - data) + 1;
+    }
+    size_t line = begin;
+    while (line < end) {
+        const char* newline = static_cast<const char*>(memchr(data + line, '\n', size - line));
+        size_t line_end = newline == nullptr ? size : (size_t)(newline - data);
+        if (!parse_line(data + line, data + line_end, format, chunk)) {
+            chunk.error = (long long)line;
+            return;
+        }
+        line = line_end + 1;
+    }
+}
+
+// data[body, size) を塊に分けて解析し、builder に追加する
+// 次の塊の並びを別のスレッドで並列に解析している間に、解析済みの塊を builder に追加する
+// infer_rows, infer_cols が true の場合は、読み込んだ最大のインデックスに合わせて builder を広げる
+template <class T>
+long long ingest(const char* data, size_t size, size_t body, const LineFormat& format, BasicCooBuilder<T>& builder, bool infer_rows, bool infer_cols, const char* caller) {
+    if (body >= size) return 0;
+    long long chunks = (long long)((size - body + kIoChunkBytes - 1) / kIoChunkBytes);
+    long long batch = 2LL * get_num_threads();
+    long long batches = (chunks + batch - 1) / batch;
+    // b 番目の塊の並びを解析する
+    auto parse_batch = [&](long long b, std::vector<ParsedChunk<T> >& parsed) {
+        long long first = b * batch;
+        int count = (int)std::min(batch, chunks - first);
+        parsed.resize(count);
+        parallel_for(0, count, 1, [&](int begin, int end) {
+            for (int c = begin; c < end; c++) {
+                size_t chunk_begin = body + (size_t)(first + c) * kIoChunkBytes;
+                size_t chunk_end = std::min(size, chunk_begin + kIoChunkBytes);
+                parse_chunk(data, size, body, chunk_begin, chunk_end, format, parsed[c]);
+            }
+        });
+    };
+
+    long long entries = 0;
+    std::vector<ParsedChunk<T> > current;
+    std::vector<ParsedChunk<T> > next;
+    parse_batch(0, current);
+    for (long long b = 0; b < batches; b++) {
+        std::thread producer;
+        if (b + 1 < batches) {
+            producer = std::thread([&parse_batch, &next, b]() { parse_batch(b + 1, next); });
+        }
+        for (size_t c = 0; c < current.size(); c++) {
+            ParsedChunk<T>& chunk = current[c];
+            if (chunk.error >= 0) {
+                if (producer.joinable()) producer.join();
+                std::cerr << caller << ": " << (chunk.out_of_range ? "Index out of range" : "Parse error") << " at byte " << chunk.error << std::endl;
+                exit(1);
+            }
+            builder.grow(infer_rows ? chunk.max_row + 1 : 0, infer_cols ? chunk.max_col + 1 : 0);
+            builder.add(chunk.rows.data(), chunk.cols.data(), chunk.values.data(), chunk.values.size());
+            entries += chunk.entries;
+            std::vector<int>().swap(chunk.rows);
+            std::vector<int>().swap(chunk.cols);
+            std::vector<T>().swap(chunk.values);
+        }
+        if (producer.joinable()) producer.join();
+        current.swap(next);
+    }
+    return entries;
+}
+
+// 空白で区切られた次の語を小文字にして返す
+std::string next_word(const char*& p, const char* end) {
+    skip_blanks(p, end);
+    std::string word;
+    while (p < end && !is_blank(*p) && *p != '\n') {
+        word += (char)std::tolower((unsigned char)*p);
+        p++;
+    }
+    return word;
+}
+
+// pos から始まる行の次の行の先頭を返す
+size_t next_line(const char* data, size_t size, size_t pos) {
+    const char* newline = static_cast<const char*>(memchr(data + pos, '\n', size - pos));
+    return newline == nullptr ? size : (size_t)(newline - data) + 1;
+}
+
+}  // namespace
+
+// Matrix Market の座標形式を読み込む
+template <class T>
+BasicSparseMatrix<T> read_matrix_market(const char* filename) {
+    const char* caller = "read_matrix_market(const char *)";
+    MappedFile file(filename, caller);
+    const char* data = file.data();
+    size_t size = file.size();
+
+    // 見出し行: %%MatrixMarket matrix coordinate <field> <symmetry>
+    size_t line_end = next_line(data, size, 0);
+    const char* p = data;
+    const char* end = data + line_end;
+    std::string banner = next_word(p, end);
+    std::string object = next_word(p, end);
+    std::string format = next_word(p, end);
+    std::string field = next_word(p, end);
+    std::string symmetry = next_word(p, end);
+    if (banner != "%%matrixmarket" || object != "matrix" || format != "coordinate") {
+        std::cerr << caller << ": Not a coordinate Matrix Market file: " << filename << std::endl;
+        exit(1);
+    }
+    LineFormat line_format;
+    line_format.delimiter = ' ';
+    line_format.comment = '%';
+    line_format.base = 1;
+    line_format.pattern = field == "pattern";
+    if (field != "real" && field != "integer" && field != "pattern") {
+        std::cerr << caller << ": Unsupported field " << field << std::endl;
+        exit(1);
+    }
+    if (symmetry == "general") {
+        line_format.mirror = 0;
+    } else if (symmetry == "symmetric") {
+        line_format.mirror = 1;
+    } else if (symmetry == "skew-symmetric") {
+        line_format.mirror = -1;
+    } else {
+        std::cerr << caller << ": Unsupported symmetry " << symmetry << std::endl;
+        exit(1);
+    }
+
+    // 注釈行を読み飛ばし、大きさの行 <rows> <cols> <nnz> を読む
+    size_t pos = line_end;
+    long long rows = -1, cols = -1, nnz = -1;
+    while (pos < size) {
+        line_end = next_line(data, size, pos);
+        p = data + pos;
+        end = data + line_end;
+        skip_blanks(p, end);
+        pos = line_end;
+        if (p == end || *p == '\n' || *p == '%') continue;
+        if (!parse_index(p, end, rows) || !skip_delimiter(p, end, ' ') || !parse_index(p, end, cols) || !skip_delimiter(p, end, ' ') || !parse_index(p, end, nnz)) {
+            std::cerr << caller << ": Broken size line" << std::endl;
+            exit(1);
+        }
+        break;
+    }
+    if (nnz < 0) {
+        std::cerr << caller << ": Missing size line" << std::endl;
+        exit(1);
+    }
+
+    line_format.rows = (int)rows;
+    line_format.cols = (int)cols;
+    BasicCooBuilder<T> builder((int)rows, (int)cols);
+    builder.reserve((size_t)nnz * (line_format.mirror != 0 ? 2 : 1));
+    long long entries = ingest(data, size, pos, line_format, builder, false, false, caller);
+    if (entries != nnz) {
+        std::cerr << caller << ": Entry count unmatched (" << entries << " / " << nnz << ")" << std::endl;
+        exit(1);
+    }
+    return builder.build("sum");
+}
+
+// 1行に「行 区切り文字 列 区切り文字 値」を並べたファイルを読み込む
+template <class T>
+BasicSparseMatrix<T> read_triplets(const char* filename, char delimiter, bool one_based, int rows, int cols, const char* reduction) {
+    const char* caller = "read_triplets(const char *, char, bool, int, int, const char *)";
+    MappedFile file(filename, caller);
+    const char* data = file.data();
+    size_t size = file.size();
+
+    // 最初の空行と注釈行以外の行が数値で始まらなければ見出しとして読み飛ばす
+    size_t body = 0;
+    while (body < size) {
+        size_t line_end = next_line(data, size, body);
+        const char* p = data + body;
+        skip_blanks(p, data + line_end);
+        if (p == data + line_end || *p == '\n' || *p == '#') {
+            body = line_end;
+            continue;
+        }
+        if (!(*p >= '0' && *p <= '9')) body = line_end;
+        break;
+    }
+
+    LineFormat line_format;
+    line_format.delimiter = delimiter;
+    line_format.comment = '#';
+    line_format.base = one_based ? 1 : 0;
+    line_format.mirror = 0;
+    line_format.pattern = false;
+    line_format.rows = rows > 0 ? rows : -1;
+    line_format.cols = cols > 0 ? cols : -1;
+    BasicCooBuilder<T> builder(rows, cols);
+    ingest(data, size, body, line_format, builder, rows <= 0, cols <= 0, caller);
+    return builder.build(reduction);
+}
+
+// 倍精度と単精度で実体化する
+template BasicSparseMatrix<double> read_matrix_market<double>(const char* filename);
+template BasicSparseMatrix<float> read_matrix_market<float>(const char* filename);
+template BasicSparseMatrix<double> read_triplets<double>(const char* filename, char delimiter, bool one_based, int rows, int cols, const char* reduction);
+template BasicSparseMatrix<float> read_triplets<float>(const char* filename, char delimiter, bool one_based, int rows, int cols, const char* reduction);
@@ -0,0 +1,24 @@
+#include "coo_builder.h"
+#include "sparse_matrix.h"
+
+#ifndef __SPARSE_MATRIX_IO__
+#define __SPARSE_MATRIX_IO__
+
+// テキスト形式の疎行列を読み込む関数
+// ファイルをマップして行の境界で区切った塊に分け、塊ごとに並列に数値を解析する（ロケールに依存しない独自の数値解析を使う）
+// 次の塊の並びを解析している間に、解析済みの組を CooBuilder に渡して、解析と構築を重ねて行う
+// 書式の誤りやインデックスの範囲外はバイト位置を表示して終了する
+
+// Matrix Market の座標形式（real / integer / pattern、general / symmetric / skew-symmetric）を読み込む
+// 対称行列は対角以外の要素を反対側にも追加し、重複した位置は足し合わせる
+template <class T>
+BasicSparseMatrix<T> read_matrix_market(const char* filename);
+
+// 1行に「行 区切り文字 列 区切り文字 値」を並べたファイル（CSV など）を読み込む
+// 空行と '#' で始まる行は読み飛ばし、先頭行が数値で始まらなければ見出しとして読み飛ばす
+// rows, cols が 0 の場合は最大のインデックスから大きさを決める。区切り文字が ' ' の場合は空白とタブの並びで区切る
+// one_based が true の場合はインデックスを1から数え、重複した位置は reduction（CooBuilder::build と同じ）でまとめる
+template <class T>
+BasicSparseMatrix<T> read_triplets(const char* filename, char delimiter = ',', bool one_based = false, int rows = 0, int cols = 0, const char* reduction = "sum");
+
+#endif // __SPARSE_MATRIX_IO__
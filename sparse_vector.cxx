@@ -4,19 +4,21 @@
 #include <cmath>
 
 // コンストラクタ
-SparseVector::SparseVector(int size, int nnz) try
-    : size_(size), nnz_(nnz), indices_(new int[nnz]), values_(new double[nnz]) {
+template <class T>
+BasicSparseVector<T>::BasicSparseVector(int size, int nnz) try
+    : size_(size), nnz_(nnz), indices_(new int[nnz]), values_(new T[nnz]) {
 } catch (std::bad_alloc) {
     std::cerr << "SparseVector::SparseVector(int nnz_): Out of Memory!" << std::endl;
     throw;
 }
 
 // コピーコンストラクタ
-SparseVector::SparseVector(const SparseVector &arg) try
+template <class T>
+BasicSparseVector<T>::BasicSparseVector(const BasicSparseVector<T> &arg) try
     : size_(arg.size_),
       nnz_(arg.nnz_),
       indices_(new int[nnz_]),
-      values_(new double[nnz_]) {
+      values_(new T[nnz_]) {
     for (int i = 0; i < nnz_; i++) {
         indices_[i] = arg.indices_[i];
         values_[i] = arg.values_[i];
@@ -27,7 +29,8 @@ SparseVector::SparseVector(const SparseVector &arg) try
 }
 
 // ムーブコンストラクタ
-SparseVector::SparseVector(SparseVector &&arg)
+template <class T>
+BasicSparseVector<T>::BasicSparseVector(BasicSparseVector<T> &&arg)
     : size_(arg.size_),
       nnz_(arg.nnz_),
       indices_(arg.indices_),
@@ -39,13 +42,15 @@ SparseVector::SparseVector(SparseVector &&arg)
 }
 
 // デストラクタ
-SparseVector::~SparseVector(void) {
+template <class T>
+BasicSparseVector<T>::~BasicSparseVector(void) {
     delete[] indices_;
     delete[] values_;
 }
 
 // コピー代入
-SparseVector &SparseVector::operator=(const SparseVector &arg) {
+template <class T>
+BasicSparseVector<T> &BasicSparseVector<T>::operator=(const BasicSparseVector<T> &arg) {
     if (this == &arg) return *this;
     if (this->nnz_ != arg.nnz_) {
         nnz_ = arg.nnz_;
@@ -53,7 +58,7 @@ SparseVector &SparseVector::operator=(const SparseVector &arg) {
         delete[] values_;
         try {
             indices_ = new int[nnz_];
-            values_ = new double[nnz_];
+            values_ = new T[nnz_];
         } catch (std::bad_alloc) {
             std::cerr << "Out of Memory" << std::endl;
             throw;
@@ -68,7 +73,8 @@ SparseVector &SparseVector::operator=(const SparseVector &arg) {
 }
 
 // ムーブ代入
-SparseVector &SparseVector::operator=(SparseVector &&arg) {
+template <class T>
+BasicSparseVector<T> &BasicSparseVector<T>::operator=(BasicSparseVector<T> &&arg) {
     if (this == &arg) return *this;
     size_ = arg.size_;
     nnz_ = arg.nnz_;
@@ -83,25 +89,32 @@ SparseVector &SparseVector::operator=(SparseVector &&arg) {
 }
 
 // 非ゼロ要素の値を返す
-double& SparseVector::value(int index) { return values_[index]; }
+template <class T>
+T& BasicSparseVector<T>::value(int index) { return values_[index]; }
 
 // 非ゼロ要素のインデックスを返す
-int& SparseVector::dense_index(int index) { return indices_[index]; }
+template <class T>
+int& BasicSparseVector<T>::dense_index(int index) { return indices_[index]; }
 
 // サイズを返す
-int SparseVector::size(void) const { return size_; }
+template <class T>
+int BasicSparseVector<T>::size(void) const { return size_; }
 
 // 非ゼロ要素数を返す
-int SparseVector::nnz(void) const { return nnz_; }
+template <class T>
+int BasicSparseVector<T>::nnz(void) const { return nnz_; }
 
 // 要素アクセス演算子（非const版）
-double &SparseVector::operator()(int index) { return values_[index]; }
+template <class T>
+T &BasicSparseVector<T>::operator()(int index) { return values_[index]; }
 
 // 要素アクセス演算子（const版）
-double SparseVector::operator()(int index) const { return values_[index]; }
+template <class T>
+T BasicSparseVector<T>::operator()(int index) const { return values_[index]; }
 
 // インデックスアクセス演算子（非const版）
-int &SparseVector::operator()(int index, const char *s) {
+template <class T>
+int &BasicSparseVector<T>::operator()(int index, const char *s) {
     if (strcmp(s, "index") != 0) {
         std::cerr << "Invalid string parameter" << std::endl;
         exit(1);
@@ -110,7 +123,8 @@ int &SparseVector::operator()(int index, const char *s) {
 }
 
 // インデックスアクセス演算子（const版）
-int SparseVector::operator()(int index, const char *s) const {
+template <class T>
+int BasicSparseVector<T>::operator()(int index, const char *s) const {
     if (strcmp(s, "index") != 0) {
         std::cerr << "Invalid string parameter" << std::endl;
         exit(1);
@@ -119,17 +133,20 @@ int SparseVector::operator()(int index, const char *s) const {
 }
 
 // 単項プラス演算子
-SparseVector SparseVector::operator+(void) const { return *this; }
+template <class T>
+BasicSparseVector<T> BasicSparseVector<T>::operator+(void) const { return *this; }
 
 // 単項マイナス演算子
-SparseVector SparseVector::operator-(void) const {
-    SparseVector result = *this;
+template <class T>
+BasicSparseVector<T> BasicSparseVector<T>::operator-(void) const {
+    BasicSparseVector<T> result = *this;
     for (int i = 0; i < result.nnz_; i++) result(i) *= -1.0;
     return result;
 }
 
 // 等価比較演算子
-bool SparseVector::operator==(const SparseVector &rhs) const {
+template <class T>
+bool BasicSparseVector<T>::operator==(const BasicSparseVector<T> &rhs) const {
     if (size_ != rhs.size_ || nnz_ != rhs.nnz()) return false;
     for (int i = 0; i < nnz_; i++) {
         if (values_[i] != rhs(i) || indices_[i] != rhs(i, "index"))
@@ -139,18 +156,21 @@ bool SparseVector::operator==(const SparseVector &rhs) const {
 }
 
 // 不等価比較演算子
-bool SparseVector::operator!=(const SparseVector &rhs) const {
+template <class T>
+bool BasicSparseVector<T>::operator!=(const BasicSparseVector<T> &rhs) const {
     return !(*this == rhs);
 }
 
 // 値を変更するメソッド
-void SparseVector::modifyvalues_(int n, int index, double value) {
+template <class T>
+void BasicSparseVector<T>::modifyvalues_(int n, int index, double value) {
     this->values_[n] = value;
     this->indices_[n] = index;
 }
 
 // 出力演算子
-std::ostream &operator<<(std::ostream &os, const SparseVector &rhs) {
+template <class T>
+std::ostream &operator<<(std::ostream &os, const BasicSparseVector<T> &rhs) {
     os << "(";
     if (rhs.nnz() > 0) {
         for (int i = 0;; i++) {
@@ -164,54 +184,76 @@ std::ostream &operator<<(std::ostream &os, const SparseVector &rhs) {
 }
 
 // 最大ノルムを計算する関数
-double max_norm(const SparseVector &arg) {
+template <class T>
+double max_norm(const BasicSparseVector<T> &arg) {
     if (arg.nnz() < 1) {
         std::cout << "Can't calculate norm for 0-sized vector" << std::endl;
         exit(1);
     }
-    double result = fabs(arg(0));
+    double result = fabs((double)arg(0));
     for (int i = 1; i < arg.nnz(); i++) {
-        double tmp = fabs(arg(i));
+        double tmp = fabs((double)arg(i));
         if (result < tmp) result = tmp;
     }
     return result;
 }
 
 // 2ノルムを計算する関数
-double squared_norm(const SparseVector &arg) { return sqrt(norm_square(arg)); }
+template <class T>
+double squared_norm(const BasicSparseVector<T> &arg) { return sqrt(norm_square(arg)); }
 
 // 2ノルムの二乗を計算する関数
-double norm_square(const SparseVector &arg) {
+template <class T>
+double norm_square(const BasicSparseVector<T> &arg) {
     double result = 0.0;
     for (int i = 0; i < arg.nnz(); i++) {
-        result += arg(i) * arg(i);
+        result += (double)arg(i) * arg(i);
     }
     return result;
 }
 
 // L1ノルムの二乗を計算する関数
-double L1norm_square(const SparseVector &arg) {
+template <class T>
+double L1norm_square(const BasicSparseVector<T> &arg) {
     double result = 0.0;
     for (int i = 0; i < arg.nnz(); i++) {
-        result += fabs(arg(i));
+        result += fabs((double)arg(i));
     }
     return result;
 }
 
 // SparseVectorとVectorの内積を計算する演算子
-double operator*(const SparseVector &lhs, const Vector &rhs) {
+template <class T>
+double operator*(const BasicSparseVector<T> &lhs, const BasicVector<T> &rhs) {
     double result = 0.0;
     for (int ell = 0; ell < lhs.nnz(); ell++) {
-        result += lhs(ell) * rhs[lhs(ell, "index")];
+        result += (double)lhs(ell) * rhs[lhs(ell, "index")];
     }
     return result;
 }
 
 // VectorとSparseVectorの内積を計算する演算子
-double operator*(const Vector &lhs, const SparseVector &rhs) {
+template <class T>
+double operator*(const BasicVector<T> &lhs, const BasicSparseVector<T> &rhs) {
     double result = 0.0;
     for (int ell = 0; ell < rhs.nnz(); ell++) {
-        result += rhs(ell) * lhs[rhs(ell, "index")];
+        result += (double)rhs(ell) * lhs[rhs(ell, "index")];
     }
     return result;
-}
\ No newline at end of file
+}
+
+// 倍精度と単精度で実体化する
+template class BasicSparseVector<double>;
+template class BasicSparseVector<float>;
+template std::ostream &operator<<(std::ostream &, const BasicSparseVector<double> &);
+template std::ostream &operator<<(std::ostream &, const BasicSparseVector<float> &);
+template double max_norm(const BasicSparseVector<double> &);
+template double max_norm(const BasicSparseVector<float> &);
+template double squared_norm(const BasicSparseVector<double> &);
+template double squared_norm(const BasicSparseVector<float> &);
+template double norm_square(const BasicSparseVector<double> &);
+template double norm_square(const BasicSparseVector<float> &);
+template double operator*(const BasicSparseVector<double> &, const BasicVector<double> &);
+template double operator*(const BasicSparseVector<float> &, const BasicVector<float> &);
+template double operator*(const BasicVector<double> &, const BasicSparseVector<double> &);
+template double operator*(const BasicVector<float> &, const BasicSparseVector<float> &);
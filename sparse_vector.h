@@ -5,42 +5,51 @@
 #ifndef __SPARSEVECTOR__
 #define __SPARSEVECTOR__
 
-class Vector;
-
-class SparseVector {
+// 非ゼロ成分の型 T（float または double）を指定する疎ベクトル
+template <class T>
+class BasicSparseVector {
    private:
     int size_;      // ベクトルの全体のサイズ
     int nnz_;       // 非ゼロ成分の数
     int *indices_;  // 非ゼロ成分のインデックス配列
-    double *values_; // 非ゼロ成分の値配列
+    T *values_;     // 非ゼロ成分の値配列
 
    public:
-    SparseVector(int size_ = 0, int nnz_ = 0);  // コンストラクタ
-    SparseVector(const SparseVector &arg);      // コピーコンストラクタ
-    SparseVector(SparseVector &&arg);           // ムーブコンストラクタ
-    ~SparseVector(void);                        // デストラクタ
-    SparseVector &operator=(const SparseVector &arg); // コピー代入演算子
-    SparseVector &operator=(SparseVector &&arg); // ムーブ代入演算子
+    BasicSparseVector(int size_ = 0, int nnz_ = 0); // コンストラクタ
+    BasicSparseVector(const BasicSparseVector &arg); // コピーコンストラクタ
+    BasicSparseVector(BasicSparseVector &&arg); // ムーブコンストラクタ
+    ~BasicSparseVector(void);                   // デストラクタ
+    BasicSparseVector &operator=(const BasicSparseVector &arg); // コピー代入演算子
+    BasicSparseVector &operator=(BasicSparseVector &&arg); // ムーブ代入演算子
     int size(void) const;                       // サイズを返すメソッド
     int nnz(void) const;                        // 非ゼロ成分の数を返すメソッド
-    double &operator()(int index);              // 非ゼロ成分の値にアクセスする演算子
-    double operator()(int index) const;         // 非ゼロ成分の値にアクセスする演算子（const版）
+    T &operator()(int index);                   // 非ゼロ成分の値にアクセスする演算子
+    T operator()(int index) const;              // 非ゼロ成分の値にアクセスする演算子（const版）
     int &operator()(int index, const char *s);  // 非ゼロ成分のインデックスにアクセスする演算子
     int operator()(int index, const char *s) const; // 非ゼロ成分のインデックスにアクセスする演算子（const版）
-    double& value(int index);                   // 非ゼロ成分の値を返すメソッド
+    T& value(int index);                        // 非ゼロ成分の値を返すメソッド
     int& dense_index(int index);                // 非ゼロ成分のインデックスを返すメソッド
-    SparseVector operator+(void) const;         // 単項プラス演算子
-    SparseVector operator-(void) const;         // 単項マイナス演算子
-    bool operator==(const SparseVector &rhs) const; // 等価比較演算子
-    bool operator!=(const SparseVector &rhs) const; // 不等価比較演算子
+    BasicSparseVector operator+(void) const;    // 単項プラス演算子
+    BasicSparseVector operator-(void) const;    // 単項マイナス演算子
+    bool operator==(const BasicSparseVector &rhs) const; // 等価比較演算子
+    bool operator!=(const BasicSparseVector &rhs) const; // 不等価比較演算子
     void modifyvalues_(int n, int index, double value); // 値を変更するメソッド
 };
 
-std::ostream &operator<<(std::ostream &os, const SparseVector &rhs); // 出力演算子
-double max_norm(const SparseVector &arg);       // 最大ノルムを計算する関数
-double squared_norm(const SparseVector &arg);   // 2ノルムを計算する関数
-double norm_square(const SparseVector &arg);    // 2ノルムの二乗を計算する関数
-double operator*(const SparseVector &lhs, const Vector &rhs); // スパースベクトルとベクトルの内積演算子
-double operator*(const Vector &lhs, const SparseVector &rhs); // ベクトルとスパースベクトルの内積演算子
+typedef BasicSparseVector<double> SparseVector;
+typedef BasicSparseVector<float> FloatSparseVector;
+
+template <class T>
+std::ostream &operator<<(std::ostream &os, const BasicSparseVector<T> &rhs); // 出力演算子
+template <class T>
+double max_norm(const BasicSparseVector<T> &arg); // 最大ノルムを計算する関数
+template <class T>
+double squared_norm(const BasicSparseVector<T> &arg); // 2ノルムを計算する関数
+template <class T>
+double norm_square(const BasicSparseVector<T> &arg); // 2ノルムの二乗を計算する関数
+template <class T>
+double operator*(const BasicSparseVector<T> &lhs, const BasicVector<T> &rhs); // スパースベクトルとベクトルの内積演算子
+template <class T>
+double operator*(const BasicVector<T> &lhs, const BasicSparseVector<T> &rhs); // ベクトルとスパースベクトルの内積演算子
 
 #endif
\ No newline at end of file
@@ -3,68 +3,82 @@
 #include <iostream>
 
 // コンストラクタ（高さ、行数、列数を指定）
-Tensor::Tensor(int heights, int rows, int cols) : heights_(heights), rows_(rows), cols_(cols) {
-    matrices_ = new Matrix[heights];
+// 各スライスは一時オブジェクトからムーブ代入されるため、値のコピーは発生しない
+template <class T>
+BasicTensor<T>::BasicTensor(int heights, int rows, int cols) : heights_(heights), rows_(rows), cols_(cols) {
+    matrices_ = new BasicMatrix<T>[heights];
     for (int i = 0; i < heights; i++) {
-        matrices_[i] = Matrix(rows, cols);
+        matrices_[i] = BasicMatrix<T>(rows, cols);
     }
 }
 
 // コンストラクタ（高さ、行数、列数、初期値を指定）
-Tensor::Tensor(int heights, int rows, int cols, double arg) : heights_(heights), rows_(rows), cols_(cols) {
-    matrices_ = new Matrix[heights];
+template <class T>
+BasicTensor<T>::BasicTensor(int heights, int rows, int cols, double arg) : heights_(heights), rows_(rows), cols_(cols) {
+    matrices_ = new BasicMatrix<T>[heights];
     for (int i = 0; i < heights; i++) {
-        matrices_[i] = Matrix(rows, cols, arg);
+        matrices_[i] = BasicMatrix<T>(rows, cols, arg);
     }
 }
 
 // コピーコンストラクタ（const版）
-Tensor::Tensor(const Tensor& arg) : heights_(arg.heights_), rows_(arg.rows_), cols_(arg.cols_) {
-    matrices_ = new Matrix[heights_];
+template <class T>
+BasicTensor<T>::BasicTensor(const BasicTensor<T>& arg) : heights_(arg.heights_), rows_(arg.rows_), cols_(arg.cols_) {
+    matrices_ = new BasicMatrix<T>[heights_];
     for (int h = 0; h < heights_; ++h) {
-        for (int i = 0; i < rows_; ++i) {
-            for (int j = 0; j < cols_; ++j) {
-                (*this)[h](i, j) = arg[h](i, j);
-            }
-        }
+        matrices_[h] = arg.matrices_[h];
     }
 }
 
 // コピーコンストラクタ（非const版）
-Tensor::Tensor(Tensor& arg) : heights_(arg.heights_), rows_(arg.rows_), cols_(arg.cols_) {
-    matrices_ = new Matrix[heights_];
+template <class T>
+BasicTensor<T>::BasicTensor(BasicTensor<T>& arg) : heights_(arg.heights_), rows_(arg.rows_), cols_(arg.cols_) {
+    matrices_ = new BasicMatrix<T>[heights_];
     for (int h = 0; h < heights_; ++h) {
-        for (int i = 0; i < rows_; ++i) {
-            for (int j = 0; j < cols_; ++j) {
-                (*this)[h](i, j) = arg[h](i, j);
-            }
-        }
+        matrices_[h] = arg.matrices_[h];
     }
 }
 
+// ムーブコンストラクタ
+template <class T>
+BasicTensor<T>::BasicTensor(BasicTensor<T>&& arg) : heights_(arg.heights_), rows_(arg.rows_), cols_(arg.cols_), matrices_(arg.matrices_) {
+    arg.heights_ = 0;
+    arg.rows_ = 0;
+    arg.cols_ = 0;
+    arg.matrices_ = nullptr;
+}
+
 // デフォルトコンストラクタ
-Tensor::Tensor() { matrices_ = nullptr; }
+template <class T>
+BasicTensor<T>::BasicTensor() : heights_(0), rows_(0), cols_(0) { matrices_ = nullptr; }
 
 // デストラクタ
-Tensor::~Tensor(void) { delete[] matrices_; }
+template <class T>
+BasicTensor<T>::~BasicTensor(void) { delete[] matrices_; }
 
 // 高さを返す
-int Tensor::heights(void) const { return heights_; }
+template <class T>
+int BasicTensor<T>::heights(void) const { return heights_; }
 
 // 行数を返す
-int Tensor::rows(void) const { return rows_; }
+template <class T>
+int BasicTensor<T>::rows(void) const { return rows_; }
 
 // 列数を返す
-int Tensor::cols(void) const { return cols_; }
+template <class T>
+int BasicTensor<T>::cols(void) const { return cols_; }
 
 // 要素アクセス演算子（const版）
-Matrix Tensor::operator[](int height) const { return matrices_[height]; }
+template <class T>
+const BasicMatrix<T>& BasicTensor<T>::operator[](int height) const { return matrices_[height]; }
 
 // 要素アクセス演算子（非const版）
-Matrix& Tensor::operator[](int height) { return matrices_[height]; }
+template <class T>
+BasicMatrix<T>& BasicTensor<T>::operator[](int height) { return matrices_[height]; }
 
 // コピー代入演算子
-Tensor& Tensor::operator=(const Tensor& arg) {
+template <class T>
+BasicTensor<T>& BasicTensor<T>::operator=(const BasicTensor<T>& arg) {
     if (this == &arg) {
         return *this;  // 自己代入の場合、何もしない
     }
@@ -78,7 +92,7 @@ Tensor& Tensor::operator=(const Tensor& arg) {
     delete[] matrices_;
 
     // 新しいリソースを確保
-    matrices_ = new Matrix[heights_];
+    matrices_ = new BasicMatrix<T>[heights_];
 
     // メンバー変数をコピー
     for (int i = 0; i < heights_; i++) {
@@ -89,7 +103,8 @@ Tensor& Tensor::operator=(const Tensor& arg) {
 }
 
 // ムーブ代入演算子
-Tensor& Tensor::operator=(Tensor&& arg) {
+template <class T>
+BasicTensor<T>& BasicTensor<T>::operator=(BasicTensor<T>&& arg) {
     if (this == &arg) {
         return *this;  // 自己代入の場合、何もしない
     }
@@ -113,16 +128,17 @@ Tensor& Tensor::operator=(Tensor&& arg) {
 }
 
 // テンソルの加算演算子
-Tensor operator+(Tensor& lhs, Tensor& rhs) {
+template <class T>
+BasicTensor<T> operator+(BasicTensor<T>& lhs, BasicTensor<T>& rhs) {
     int heights = lhs.heights();
     int rows = lhs.rows();
     int cols = lhs.cols();
 
-    Tensor result(heights, rows, cols);
+    BasicTensor<T> result(heights, rows, cols);
     for (int h = 0; h < heights; h++) {
-        double* values_A = lhs[h].get_values();
-        double* values_B = rhs[h].get_values();
-        double* values_Result = result[h].get_values();
+        T* values_A = lhs[h].get_values();
+        T* values_B = rhs[h].get_values();
+        T* values_Result = result[h].get_values();
 
         for (int i = 0; i < rows; ++i) {
             for (int j = 0; j < cols; ++j) {
@@ -134,16 +150,17 @@ Tensor operator+(Tensor& lhs, Tensor& rhs) {
 }
 
 // テンソルの減算演算子
-Tensor operator-(Tensor& lhs, Tensor& rhs) {
+template <class T>
+BasicTensor<T> operator-(BasicTensor<T>& lhs, BasicTensor<T>& rhs) {
     int heights = lhs.heights();
     int rows = lhs.rows();
     int cols = lhs.cols();
 
-    Tensor result(heights, rows, cols);
+    BasicTensor<T> result(heights, rows, cols);
     for (int h = 0; h < heights; h++) {
-        double* values_A = lhs[h].get_values();
-        double* values_B = rhs[h].get_values();
-        double* values_Result = result[h].get_values();
+        T* values_A = lhs[h].get_values();
+        T* values_B = rhs[h].get_values();
+        T* values_Result = result[h].get_values();
 
         for (int i = 0; i < rows; ++i) {
             for (int j = 0; j < cols; ++j) {
@@ -155,7 +172,8 @@ Tensor operator-(Tensor& lhs, Tensor& rhs) {
 }
 
 // テンソルの要素の平方和を計算する関数
-double squared_sum(const Tensor& arg) {
+template <class T>
+double squared_sum(const BasicTensor<T>& arg) {
     double result = 0.0;
     for (int i = 0; i < arg.heights(); i++) {
         result += squared_sum(arg[i]);
@@ -164,6 +182,19 @@ double squared_sum(const Tensor& arg) {
 }
 
 // フロベニウスノルムを計算する関数
-double frobenius_norm(const Tensor& arg) {
+template <class T>
+double frobenius_norm(const BasicTensor<T>& arg) {
     return sqrt(squared_sum(arg));
-}
\ No newline at end of file
+}
+
+// 倍精度と単精度で実体化する
+template class BasicTensor<double>;
+template class BasicTensor<float>;
+template BasicTensor<double> operator+(BasicTensor<double>&, BasicTensor<double>&);
+template BasicTensor<float> operator+(BasicTensor<float>&, BasicTensor<float>&);
+template BasicTensor<double> operator-(BasicTensor<double>&, BasicTensor<double>&);
+template BasicTensor<float> operator-(BasicTensor<float>&, BasicTensor<float>&);
+template double squared_sum(const BasicTensor<double>&);
+template double squared_sum(const BasicTensor<float>&);
+template double frobenius_norm(const BasicTensor<double>&);
+template double frobenius_norm(const BasicTensor<float>&);
@@ -2,32 +2,42 @@
 #ifndef __TENSOR__
 #define __TENSOR__
 
-class Tensor {
+// 要素の型 T（float または double）を指定するテンソル（行列のスライスを高さ方向に並べる）
+template <class T>
+class BasicTensor {
    private:
     int heights_; // 高さ（テンソルのスライス数）
     int rows_; // 行数
     int cols_; // 列数
-    Matrix* matrices_; // 行列の配列
+    BasicMatrix<T>* matrices_; // 行列の配列
 
    public:
-    Tensor(int heights, int rows, int cols); // コンストラクタ（高さ、行数、列数を指定）
-    Tensor(int heights, int rows, int cols, double arg); // コンストラクタ（高さ、行数、列数、初期値を指定）
-    Tensor(Tensor& arg);                    // コピーコンストラクタ（非const版）
-    Tensor(const Tensor& arg);              // コピーコンストラクタ（const版）
-    Tensor();                               // デフォルトコンストラクタ
-    ~Tensor(void);                          // デストラクタ
+    BasicTensor(int heights, int rows, int cols); // コンストラクタ（高さ、行数、列数を指定）
+    BasicTensor(int heights, int rows, int cols, double arg); // コンストラクタ（高さ、行数、列数、初期値を指定）
+    BasicTensor(BasicTensor& arg);          // コピーコンストラクタ（非const版）
+    BasicTensor(const BasicTensor& arg);    // コピーコンストラクタ（const版）
+    BasicTensor(BasicTensor&& arg);         // ムーブコンストラクタ
+    BasicTensor();                          // デフォルトコンストラクタ
+    ~BasicTensor(void);                     // デストラクタ
     int heights(void) const;                // 高さを返す
     int rows(void) const;                   // 行数を返す
     int cols(void) const;                   // 列数を返す
-    Matrix& operator[](int height);         // 要素アクセス演算子（非const版）
-    Matrix operator[](int height) const;    // 要素アクセス演算子（const版）
-    Tensor& operator=(const Tensor& arg);   // コピー代入演算子
-    Tensor& operator=(Tensor&& arg);        // ムーブ代入演算子
+    BasicMatrix<T>& operator[](int height); // 要素アクセス演算子（非const版）
+    const BasicMatrix<T>& operator[](int height) const; // 要素アクセス演算子（const版）
+    BasicTensor& operator=(const BasicTensor& arg); // コピー代入演算子
+    BasicTensor& operator=(BasicTensor&& arg); // ムーブ代入演算子
 };
 
-Tensor operator+(Tensor& lhs, Tensor& rhs); // テンソルの加算演算子
-Tensor operator-(Tensor& lhs, Tensor& rhs); // テンソルの減算演算子
-double squared_sum(const Tensor& arg);      // テンソルの要素の平方和を計算する関数
-double frobenius_norm(const Tensor& arg);   // フロベニウスノルムを計算する関数
+typedef BasicTensor<double> Tensor;
+typedef BasicTensor<float> FloatTensor;
+
+template <class T>
+BasicTensor<T> operator+(BasicTensor<T>& lhs, BasicTensor<T>& rhs); // テンソルの加算演算子
+template <class T>
+BasicTensor<T> operator-(BasicTensor<T>& lhs, BasicTensor<T>& rhs); // テンソルの減算演算子
+template <class T>
+double squared_sum(const BasicTensor<T>& arg); // テンソルの要素の平方和を計算する関数
+template <class T>
+double frobenius_norm(const BasicTensor<T>& arg); // フロベニウスノルムを計算する関数
 
 #endif
\ No newline at end of file
@@ -0,0 +1,214 @@
+// CSR 以外の疎行列の形式（SELL-C-σ, BCSR, AdaptiveSparseMatrix, CompressedSparseMatrix）の SpMV / SpMM を素朴な逐次計算と比べるテスト
+// 行列の値は2進の小数で、和の順番によらず丸め誤差が出ないので、結果は完全に一致するはず
+// 空の行列、0 × 0 の行列、ブロックやチャンクの大きさで割り切れない行列、1行だけ長い行列を、スレッド数 1 と 4 で確かめる
+// g++ -std=c++11 -O2 -pthread -I.. sparse_format_test.cxx ../*.cxx && ./a.out
+#include <cmath>     // 数学関数の標準ライブラリ
+#include <cstdlib>   // exit の標準ライブラリ
+#include <iostream>  // 入出力の標準ライブラリ
+#include <limits>    // 数値の上限の標準ライブラリ
+#include <random>    // 乱数の標準ライブラリ
+#include <string>    // 文字列の標準ライブラリ
+#include <vector>    // 可変長配列の標準ライブラリ
+
+#include "adaptive_sparse_matrix.h"
+#include "bcsr_matrix.h"
+#include "compressed_sparse_matrix.h"
+#include "coo_builder.h"
+#include "sell_matrix.h"
+
+namespace {
+
+int failures = 0;
+
+// 確かめる行列の種類
+struct Case {
+    int rows;         // 行数
+    int cols;         // 列数
+    const char* kind; // "empty"（非ゼロ要素なし）、"random"（行ごとに乱数の個数）、"skewed"（1行だけ全列が非ゼロ）
+};
+
+const Case kCases[] = {{0, 0, "empty"}, {6, 9, "empty"}, {301, 203, "random"}, {3001, 2002, "random"}, {65, 300000, "skewed"}};
+
+// 1/4 刻みの小さな値を返す
+double small_value(std::mt19937& generator) { return ((int)(generator() % 9) - 4) / 4.0; }
+
+// 種類に応じた疎行列を作る（空の行を含む）
+template <class T>
+BasicSparseMatrix<T> make_matrix(const Case& c, unsigned seed) {
+    std::mt19937 generator(seed);
+    BasicCooBuilder<T> builder(c.rows, c.cols);
+    std::string kind = c.kind;
+    for (int i = 0; i < c.rows && kind != "empty"; i++) {
+        if (i % 7 == 3) continue;
+        if (kind == "skewed" && i == 17) {
+            for (int j = 0; j < c.cols; j++) builder.add(i, j, (T)(small_value(generator) + 2.0));
+            continue;
+        }
+        int length = kind == "skewed" ? 3 : (int)(generator() % 80);
+        for (int k = 0; k < length; k++) builder.add(i, (int)(generator() % c.cols), (T)small_value(generator));
+    }
+    return builder.build();
+}
+
+// 1/2 刻みの小さな値の密行列を作る
+template <class T>
+BasicMatrix<T> make_dense(int rows, int cols, unsigned seed) {
+    std::mt19937 generator(seed);
+    BasicMatrix<T> result(rows, cols);
+    for (int i = 0; i < rows; i++) {
+        for (int j = 0; j < cols; j++) result(i, j) = (T)(((int)(generator() % 7) - 3) / 2.0);
+    }
+    return result;
+}
+
+// 1/2 刻みの小さな値のベクトルを作る
+template <class T>
+BasicVector<T> make_vector(int size, unsigned seed) {
+    std::mt19937 generator(seed);
+    BasicVector<T> result(size);
+    for (int i = 0; i < size; i++) result[i] = (T)(((int)(generator() % 7) - 3) / 2.0);
+    return result;
+}
+
+// 値が一致しなければ失敗として数える（最初の数件だけ表示する）
+void expect_equal(double actual, double expected, const std::string& name) {
+    if (actual != expected) {
+        if (failures < 20) std::cerr << name << ": " << actual << ", expected " << expected << std::endl;
+        failures++;
+    }
+}
+
+// 形式 M の y = alpha * M * x + beta * y と C = alpha * M * B + beta * C を CSR の逐次計算と比べる
+template <class T, class M>
+void test_format(const M& matrix, const BasicSparseMatrix<T>& A, const std::string& name) {
+    const int width = 3;
+    const int* row_pointers = A.get_row_pointers();
+    const int* col_indices = A.get_col_indices();
+    const T* values = A.get_values();
+    BasicVector<T> x = make_vector<T>(A.cols(), 31);
+    BasicMatrix<T> B = make_dense<T>(A.cols(), width, 32);
+    const double betas[] = {0.0, 1.0, -1.5};
+    for (int b = 0; b < 3; b++) {
+        BasicVector<T> y = make_vector<T>(A.rows(), 33);
+        BasicMatrix<T> C = make_dense<T>(A.rows(), width, 34);
+        std::vector<double> expected(A.rows());
+        std::vector<double> expected_matrix((size_t)A.rows() * width);
+        for (int i = 0; i < A.rows(); i++) {
+            double sum = 0.0;
+            for (int k = row_pointers[i]; k < row_pointers[i + 1]; k++) sum += (double)values[k] * x[col_indices[k]];
+            expected[i] = (T)(0.5 * sum + betas[b] * y[i]);
+            for (int j = 0; j < width; j++) {
+                double matrix_sum = 0.0;
+                for (int k = row_pointers[i]; k < row_pointers[i + 1]; k++) matrix_sum += (double)values[k] * B(col_indices[k], j);
+                expected_matrix[(size_t)i * width + j] = (T)(0.5 * matrix_sum + betas[b] * C(i, j));
+            }
+        }
+        matrix.multiply(0.5, BasicVectorView<T>(x), betas[b], BasicVectorView<T>(y));
+        matrix.multiply(0.5, BasicMatrixView<T>(B), betas[b], BasicMatrixView<T>(C));
+        std::string label = name + " beta " + std::to_string(betas[b]);
+        for (int i = 0; i < A.rows(); i++) expect_equal(y[i], expected[i], label + " spmv");
+        for (int i = 0; i < A.rows(); i++) {
+            for (int j = 0; j < width; j++) expect_equal(C(i, j), expected_matrix[(size_t)i * width + j], label + " spmm");
+        }
+    }
+    BasicVector<T> product = matrix * BasicVectorView<T>(x);
+    BasicVector<T> expected = A * BasicVectorView<T>(x);
+    for (int i = 0; i < A.rows(); i++) expect_equal(product[i], expected[i], name + " operator*(Vector)");
+}
+
+// x の値が有限でなくても、その列を読まない行の結果が有限のままであることを確かめる（SELL-C-σ の埋めた位置）
+template <class T>
+void test_sell_padding(const BasicSparseMatrix<T>& A, const std::string& name) {
+    BasicSellMatrix<T> sell(A, 8);
+    BasicVector<T> x = make_vector<T>(A.cols(), 41);
+    if (A.cols() > 0) x[0] = std::numeric_limits<T>::infinity();
+    BasicVector<T> y = sell * BasicVectorView<T>(x);
+    for (int i = 0; i < A.rows(); i++) {
+        bool reads_first = false;
+        for (int k = A.get_row_pointers()[i]; k < A.get_row_pointers()[i + 1]; k++) reads_first = reads_first || A.get_col_indices()[k] == 0;
+        if (!reads_first && !std::isfinite((double)y[i])) {
+            if (failures < 20) std::cerr << name << " sell padding: row " << i << " is " << y[i] << std::endl;
+            failures++;
+        }
+    }
+}
+
+// 列インデックスを圧縮した行列を戻した結果と SDDMM を CSR と比べる
+template <class T>
+void test_compressed(const BasicCompressedSparseMatrix<T>& compressed, const BasicSparseMatrix<T>& A, const std::string& name) {
+    BasicSparseMatrix<T> restored = compressed.decompress();
+    for (int i = 0; i <= A.rows(); i++) expect_equal(restored.get_row_pointers()[i], A.get_row_pointers()[i], name + " decompress row pointer");
+    for (int k = 0; k < A.nnz(); k++) {
+        expect_equal(restored.get_col_indices()[k], A.get_col_indices()[k], name + " decompress column");
+        expect_equal(restored.get_values()[k], A.get_values()[k], name + " decompress value");
+    }
+    const int inner = 4;
+    BasicMatrix<T> lhs = make_dense<T>(A.rows(), inner, 51);
+    BasicMatrix<T> rhs = make_dense<T>(A.cols(), inner, 52);
+    BasicSparseMatrix<T> expected;
+    A.product(BasicMatrixView<T>(lhs), BasicMatrixView<T>(rhs), expected);
+    BasicCompressedSparseMatrix<T> product = compressed;
+    product.product(BasicMatrixView<T>(lhs), BasicMatrixView<T>(rhs));
+    for (int k = 0; k < A.nnz(); k++) expect_equal(product.get_values()[k], expected.get_values()[k], name + " sddmm");
+}
+
+// 差分で圧縮しても小さくならない行列（列の差がほぼすべて 2^28 以上）は圧縮せずに持ち、元に戻せることを確かめる
+template <class T>
+void test_uncompressed(void) {
+    const int rows = 1000;
+    const int cols = 1 << 30;
+    BasicCooBuilder<T> builder(rows, cols);
+    for (int i = 0; i < rows; i++) builder.add(i, cols - 1 - i, (T)(i % 5 + 1));
+    BasicSparseMatrix<T> A = builder.build();
+    BasicCompressedSparseMatrix<T> compressed(A);
+    if (compressed.compressed() || compressed.index_bytes() != compressed.csr_index_bytes()) {
+        std::cerr << "uncompressed: compressed " << compressed.compressed() << ", " << compressed.index_bytes() << " bytes, CSR " << compressed.csr_index_bytes() << " bytes" << std::endl;
+        failures++;
+    }
+    BasicSparseMatrix<T> restored = compressed.decompress();
+    for (int k = 0; k < A.nnz(); k++) expect_equal(restored.get_col_indices()[k], A.get_col_indices()[k], "uncompressed decompress column");
+}
+
+template <class T>
+void run(const Case& c) {
+    BasicSparseMatrix<T> A = make_matrix<T>(c, 5);
+    std::string name = std::string(c.kind) + " " + std::to_string(c.rows) + " x " + std::to_string(c.cols) + " threads " + std::to_string(get_num_threads());
+    const int sigmas[] = {8, 256};
+    for (int s = 0; s < 2; s++) {
+        test_format(BasicSellMatrix<T>(A, sigmas[s]), A, name + " sell sigma " + std::to_string(sigmas[s]));
+    }
+    test_sell_padding(A, name);
+    const int blocks[][2] = {{1, 1}, {2, 2}, {4, 1}, {1, 4}, {4, 4}};
+    for (int b = 0; b < 5; b++) {
+        test_format(BasicBcsrMatrix<T>(A, blocks[b][0], blocks[b][1]), A, name + " bcsr " + std::to_string(blocks[b][0]) + " x " + std::to_string(blocks[b][1]));
+    }
+    const char* modes[] = {"csr", "sell", "bcsr", "heuristic", "tune"};
+    for (int m = 0; m < 5; m++) {
+        BasicAdaptiveSparseMatrix<T> adaptive(A, modes[m]);
+        test_format(adaptive, A, name + " adaptive " + modes[m] + " (" + adaptive.format() + ")");
+    }
+    BasicCompressedSparseMatrix<T> compressed(A);
+    test_format(compressed, A, name + " compressed");
+    test_compressed(compressed, A, name + " compressed");
+}
+
+}  // namespace
+
+int main(void) {
+    const int threads[] = {1, 4};
+    for (int t = 0; t < 2; t++) {
+        set_num_threads(threads[t]);
+        for (size_t c = 0; c < sizeof(kCases) / sizeof(kCases[0]); c++) {
+            run<double>(kCases[c]);
+            run<float>(kCases[c]);
+        }
+        test_uncompressed<double>();
+        test_uncompressed<float>();
+    }
+    if (failures > 0) {
+        std::cerr << failures << " failures" << std::endl;
+        exit(1);
+    }
+    std::cout << "sparse_format_test: OK" << std::endl;
+    return 0;
+}
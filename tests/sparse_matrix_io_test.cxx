@@ -0,0 +1,179 @@
+// テキスト形式の疎行列の読み込み（read_matrix_market, read_triplets）を確かめるテスト
+// g++ -std=c++11 -O2 -pthread -I.. sparse_matrix_io_test.cxx ../*.cxx && ./a.out
+#include <cmath>     // 数学関数の標準ライブラリ
+#include <cstdint>   // 固定幅の整数型の標準ライブラリ
+#include <cstdio>    // ファイル操作の標準ライブラリ
+#include <cstdlib>   // exit, strtod の標準ライブラリ
+#include <cstring>   // memcmp の標準ライブラリ
+#include <fstream>   // ファイル入出力の標準ライブラリ
+#include <iostream>  // 入出力の標準ライブラリ
+#include <random>    // 乱数の標準ライブラリ
+#include <string>    // 文字列の標準ライブラリ
+#include <vector>    // 可変長配列の標準ライブラリ
+
+#include "sparse_matrix_io.h"
+
+namespace {
+
+int failures = 0;
+
+const char* kFilename = "sparse_matrix_io_test.tmp";
+
+// ファイルに内容をそのまま書き込む
+void write_file(const std::string& contents) {
+    std::ofstream file(kFilename, std::ios::binary);
+    file << contents;
+}
+
+// (i, j) の値を返す（要素がなければ 0）
+double value_at(const SparseMatrix& m, int i, int j) {
+    for (int k = m.get_row_pointers()[i]; k < m.get_row_pointers()[i + 1]; k++) {
+        if (m.get_col_indices()[k] == j) return m.get_values()[k];
+    }
+    return 0.0;
+}
+
+// 行列が dense（行優先）と一致することを確かめる
+void check_dense(const SparseMatrix& m, int rows, int cols, const double* dense, const char* name) {
+    if (m.rows() != rows || m.cols() != cols) {
+        std::cerr << name << ": size " << m.rows() << " x " << m.cols() << ", expected " << rows << " x " << cols << std::endl;
+        failures++;
+        return;
+    }
+    for (int i = 0; i < rows; i++) {
+        for (int j = 0; j < cols; j++) {
+            if (value_at(m, i, j) != dense[i * cols + j]) {
+                std::cerr << name << ": (" << i << ", " << j << ") = " << value_at(m, i, j) << ", expected " << dense[i * cols + j] << std::endl;
+                failures++;
+            }
+        }
+    }
+}
+
+// 読み込んだ値が strtod とビット単位で一致することを確かめる
+void check_bits(double value, const char* text, const char* name) {
+    double expected = strtod(text, nullptr);
+    if (memcmp(&value, &expected, sizeof(double)) != 0) {
+        std::cerr << name << ": " << text << " read as " << value << std::endl;
+        failures++;
+    }
+}
+
+// %.17g で書いた乱数の double を読み戻して strtod と比べる
+void test_round_trip(void) {
+    const int count = 20000;
+    std::mt19937_64 generator(7);
+    std::vector<std::string> texts;
+    std::string contents;
+    char text[64];
+    while ((int)texts.size() < count) {
+        uint64_t bits = generator();
+        double value;
+        memcpy(&value, &bits, sizeof(double));
+        if (!std::isfinite(value) || value == 0.0) continue;
+        snprintf(text, sizeof(text), "%.17g", value);
+        contents += std::to_string(texts.size()) + ",0," + text + "\n";
+        texts.push_back(text);
+    }
+    write_file(contents);
+    SparseMatrix m = read_triplets<double>(kFilename);
+    if (m.nnz() != count) {
+        std::cerr << "round trip: nnz " << m.nnz() << ", expected " << count << std::endl;
+        failures++;
+        return;
+    }
+    for (int i = 0; i < count; i++) {
+        check_bits(m.get_values()[i], texts[i].c_str(), "round trip");
+    }
+}
+
+// 非正規化数、指数の大きい値、桁の多い値を読む
+void test_extreme_values(void) {
+    const char* texts[] = {"2.2250738585072014e-308", "2.2250738585072011e-308", "5e-324", "4.9406564584124654e-324", "1e-400",
+                           "1.7976931348623157e308", "1e400", "-1e-310", "123456789012345678901234567890e-10", "0.000000000000000000000000000001",
+                           "9007199254740993", "1.00000000000000011102230246251565404236316680908203125", "+.5", "7."};
+    int count = sizeof(texts) / sizeof(texts[0]);
+    std::string contents;
+    for (int i = 0; i < count; i++) {
+        contents += std::to_string(i) + " 0 " + texts[i] + "\n";
+    }
+    write_file(contents);
+    SparseMatrix m = read_triplets<double>(kFilename, ' ', false, count, 1);
+    for (int i = 0; i < count; i++) {
+        check_bits(value_at(m, i, 0), texts[i], "extreme values");
+    }
+}
+
+// 対称行列と歪対称行列の Matrix Market 形式を読む
+void test_symmetric(void) {
+    write_file("%%MatrixMarket matrix coordinate real symmetric\n% comment\n3 3 3\n1 1 2\n2 1 -1.5\n3 2 4\n");
+    const double symmetric[] = {2, -1.5, 0, -1.5, 0, 4, 0, 4, 0};
+    check_dense(read_matrix_market<double>(kFilename), 3, 3, symmetric, "symmetric");
+
+    write_file("%%MatrixMarket matrix coordinate real skew-symmetric\n3 3 2\n2 1 1.5\n3 1 -2\n");
+    const double skew[] = {0, -1.5, 2, 1.5, 0, 0, -2, 0, 0};
+    check_dense(read_matrix_market<double>(kFilename), 3, 3, skew, "skew-symmetric");
+
+    write_file("%%MatrixMarket matrix coordinate pattern general\n2 3 2\n1 3\n2 2\n");
+    const double pattern[] = {0, 0, 1, 0, 1, 0};
+    check_dense(read_matrix_market<double>(kFilename), 2, 3, pattern, "pattern");
+}
+
+// 最後の行に改行がないファイルと、見出しと \r\n の改行がある CSV を読む
+void test_line_endings(void) {
+    write_file("%%MatrixMarket matrix coordinate real general\n2 2 2\n1 1 3\n2 2 0.25");
+    const double diagonal[] = {3, 0, 0, 0.25};
+    check_dense(read_matrix_market<double>(kFilename), 2, 2, diagonal, "no trailing newline");
+
+    write_file("row,col,value\r\n0,1,2.5\r\n\r\n# comment\r\n1,0,-1\r\n1,2,1e2\r\n");
+    const double csv[] = {0, 2.5, 0, -1, 0, 100};
+    check_dense(read_triplets<double>(kFilename), 2, 3, csv, "csv with header and CRLF");
+
+    write_file("row\tcol\tvalue\n1\t2\t5\n2\t1\t6\n2\t1\t1\n");
+    const double tsv[] = {0, 5, 7, 0};
+    check_dense(read_triplets<double>(kFilename, ' ', true), 2, 2, tsv, "one-based with duplicates");
+}
+
+// 解析の塊（8MiB）より大きいファイルを読み、塊の境界をまたぐ行も正しく読めることを確かめる
+void test_large_file(void) {
+    const int rows = 1200000;
+    std::string contents = "%%MatrixMarket matrix coordinate real general\n" + std::to_string(rows) + " 3 " + std::to_string(rows) + "\n";
+    for (int i = 0; i < rows; i++) {
+        contents += std::to_string(i + 1) + " " + std::to_string(i % 3 + 1) + " " + std::to_string(i) + ".5\n";
+    }
+    if (contents.size() <= 2u * (1u << 23)) {
+        std::cerr << "large file: only " << contents.size() << " bytes" << std::endl;
+        failures++;
+    }
+    write_file(contents);
+    SparseMatrix m = read_matrix_market<double>(kFilename);
+    if (m.rows() != rows || m.cols() != 3 || m.nnz() != rows) {
+        std::cerr << "large file: " << m.rows() << " x " << m.cols() << " with " << m.nnz() << " elements" << std::endl;
+        failures++;
+        return;
+    }
+    for (int i = 0; i < rows; i++) {
+        if (m.get_row_pointers()[i] != i || m.get_col_indices()[i] != i % 3 || m.get_values()[i] != i + 0.5) {
+            std::cerr << "large file: row " << i << " wrong" << std::endl;
+            failures++;
+            return;
+        }
+    }
+}
+
+}  // namespace
+
+int main(void) {
+    test_round_trip();
+    test_extreme_values();
+    test_symmetric();
+    test_line_endings();
+    test_large_file();
+    remove(kFilename);
+    if (failures > 0) {
+        std::cerr << failures << " failures" << std::endl;
+        exit(1);
+    }
+    std::cout << "sparse_matrix_io_test: OK" << std::endl;
+    return 0;
+}
@@ -0,0 +1,352 @@
+// 疎行列の並列カーネル（SpMM, SDDMM, SpMV, 転置, SpGEMM, 削除）を素朴な逐次計算と比べるテスト
+// 行列の値は2進の小数で、和の順番によらず丸め誤差が出ないので、結果は完全に一致するはず
+// 非ゼロ要素で作業を分割するカーネルの、空の行列、0 × 0 の行列、区間の境界で分かれる長い行を含む行列を、スレッド数 1 と 4 で確かめる
+// g++ -std=c++11 -O2 -pthread -I.. sparse_matrix_test.cxx ../*.cxx && ./a.out
+#include <algorithm>  // ソートの標準ライブラリ
+#include <cmath>      // 数学関数の標準ライブラリ
+#include <cstdlib>    // exit の標準ライブラリ
+#include <iostream>   // 入出力の標準ライブラリ
+#include <random>     // 乱数の標準ライブラリ
+#include <string>     // 文字列の標準ライブラリ
+#include <utility>    // pair の標準ライブラリ
+#include <vector>     // 可変長配列の標準ライブラリ
+
+#include "coo_builder.h"
+#include "sparse_matrix.h"
+
+namespace {
+
+int failures = 0;
+
+// 確かめる行列の種類
+struct Case {
+    int rows;         // 行数
+    int cols;         // 列数
+    const char* kind; // "empty"（非ゼロ要素なし）、"random"（行ごとに乱数の個数）、"skewed"（1行だけ全列が非ゼロ）
+};
+
+const Case kCases[] = {{0, 0, "empty"}, {6, 9, "empty"}, {300, 200, "random"}, {3000, 2000, "random"}, {64, 300000, "skewed"}};
+
+// 1/4 刻みの小さな値を返す
+double small_value(std::mt19937& generator) { return ((int)(generator() % 9) - 4) / 4.0; }
+
+// 種類に応じた疎行列を作る（空の行を含む）
+template <class T>
+BasicSparseMatrix<T> make_matrix(const Case& c, unsigned seed) {
+    std::mt19937 generator(seed);
+    BasicCooBuilder<T> builder(c.rows, c.cols);
+    std::string kind = c.kind;
+    for (int i = 0; i < c.rows && kind != "empty"; i++) {
+        if (i % 7 == 3) continue;
+        if (kind == "skewed" && i == 17) {
+            for (int j = 0; j < c.cols; j++) builder.add(i, j, (T)(small_value(generator) + 2.0));
+            continue;
+        }
+        int length = kind == "skewed" ? 3 : (int)(generator() % 80);
+        for (int k = 0; k < length; k++) builder.add(i, (int)(generator() % c.cols), (T)small_value(generator));
+    }
+    return builder.build();
+}
+
+// 1/2 刻みの小さな値の密行列を作る
+template <class T>
+BasicMatrix<T> make_dense(int rows, int cols, unsigned seed) {
+    std::mt19937 generator(seed);
+    BasicMatrix<T> result(rows, cols);
+    for (int i = 0; i < rows; i++) {
+        for (int j = 0; j < cols; j++) result(i, j) = (T)(((int)(generator() % 7) - 3) / 2.0);
+    }
+    return result;
+}
+
+// 1/2 刻みの小さな値のベクトルを作る
+template <class T>
+BasicVector<T> make_vector(int size, unsigned seed) {
+    std::mt19937 generator(seed);
+    BasicVector<T> result(size);
+    for (int i = 0; i < size; i++) result[i] = (T)(((int)(generator() % 7) - 3) / 2.0);
+    return result;
+}
+
+// 値が一致しなければ失敗として数える（最初の数件だけ表示する）
+void expect_equal(double actual, double expected, const std::string& name) {
+    if (actual != expected) {
+        if (failures < 20) std::cerr << name << ": " << actual << ", expected " << expected << std::endl;
+        failures++;
+    }
+}
+
+// 2つの疎行列の大きさ、行ポインタ、列インデックス、値が一致することを確かめる
+template <class T>
+void expect_same(const BasicSparseMatrix<T>& actual, const BasicSparseMatrix<T>& expected, const std::string& name) {
+    if (actual.rows() != expected.rows() || actual.cols() != expected.cols() || actual.nnz() != expected.nnz()) {
+        std::cerr << name << ": " << actual.rows() << " x " << actual.cols() << " with " << actual.nnz() << " elements, expected " << expected.rows() << " x " << expected.cols()
+                  << " with " << expected.nnz() << std::endl;
+        failures++;
+        return;
+    }
+    std::string row_pointer_label = name + " row pointer";
+    std::string column_label = name + " column";
+    std::string value_label = name + " value";
+    for (int i = 0; i <= expected.rows(); i++) expect_equal(actual.get_row_pointers()[i], expected.get_row_pointers()[i], row_pointer_label);
+    for (int k = 0; k < expected.nnz(); k++) {
+        expect_equal(actual.get_col_indices()[k], expected.get_col_indices()[k], column_label);
+        expect_equal(actual.get_values()[k], expected.get_values()[k], value_label);
+    }
+}
+
+// 行ごとの (列, 値) の組から疎行列を作る
+template <class T>
+BasicSparseMatrix<T> from_rows(int rows, int cols, const std::vector<std::vector<std::pair<int, double> > >& entries) {
+    int nnz = 0;
+    for (int i = 0; i < rows; i++) nnz += (int)entries[i].size();
+    BasicSparseMatrix<T> result(rows, cols, nnz);
+    int position = 0;
+    for (int i = 0; i < rows; i++) {
+        result.get_row_pointers()[i] = position;
+        for (size_t k = 0; k < entries[i].size(); k++) {
+            result.get_col_indices()[position] = entries[i][k].first;
+            result.get_values()[position] = (T)entries[i][k].second;
+            position++;
+        }
+    }
+    result.get_row_pointers()[rows] = position;
+    return result;
+}
+
+// C = alpha * A * B + beta * C を SpMM（行列の演算子、転置したビューを含む）と逐次計算で比べる
+template <class T>
+void test_spmm(const BasicSparseMatrix<T>& A, const std::string& name) {
+    const int width = 5;
+    BasicMatrix<T> B = make_dense<T>(A.cols(), width, 11);
+    BasicMatrix<T> B_transposed = make_dense<T>(width, A.cols(), 12);
+    const double betas[] = {0.0, 1.0, -1.5};
+    for (int b = 0; b < 3; b++) {
+        for (int transposed = 0; transposed < 2; transposed++) {
+            BasicMatrixView<T> view = transposed ? BasicMatrixView<T>(B_transposed).transposed() : BasicMatrixView<T>(B);
+            BasicMatrix<T> C = make_dense<T>(A.rows(), width, 13);
+            BasicMatrix<T> expected = C;
+            for (int i = 0; i < A.rows(); i++) {
+                for (int j = 0; j < width; j++) {
+                    double sum = 0.0;
+                    for (int k = A.get_row_pointers()[i]; k < A.get_row_pointers()[i + 1]; k++) sum += (double)A.get_values()[k] * view(A.get_col_indices()[k], j);
+                    expected(i, j) = (T)(0.5 * sum + betas[b] * expected(i, j));
+                }
+            }
+            spmm(0.5, A, view, betas[b], BasicMatrixView<T>(C));
+            std::string label = name + " spmm beta " + std::to_string(betas[b]) + (transposed ? " transposed" : "");
+            for (int i = 0; i < A.rows(); i++) {
+                for (int j = 0; j < width; j++) expect_equal(C(i, j), expected(i, j), label);
+            }
+        }
+    }
+    BasicMatrix<T> product = A * BasicMatrixView<T>(B);
+    for (int i = 0; i < A.rows(); i++) {
+        for (int j = 0; j < width; j++) {
+            double sum = 0.0;
+            for (int k = A.get_row_pointers()[i]; k < A.get_row_pointers()[i + 1]; k++) sum += (double)A.get_values()[k] * B(A.get_col_indices()[k], j);
+            expect_equal(product(i, j), (T)sum, name + " operator*(Matrix)");
+        }
+    }
+}
+
+// 非ゼロ要素の位置の lhs * transpose_rhs^T を SDDMM（その場、結果の行列、転置したビュー）と逐次計算で比べる
+template <class T>
+void test_sddmm(const BasicSparseMatrix<T>& A, const std::string& name) {
+    const int inner = 6;
+    BasicMatrix<T> lhs = make_dense<T>(A.rows(), inner, 21);
+    BasicMatrix<T> rhs = make_dense<T>(A.cols(), inner, 22);
+    BasicMatrix<T> rhs_transposed = make_dense<T>(inner, A.cols(), 23);
+    for (int transposed = 0; transposed < 2; transposed++) {
+        BasicMatrixView<T> view = transposed ? BasicMatrixView<T>(rhs_transposed).transposed() : BasicMatrixView<T>(rhs);
+        std::vector<double> expected(A.nnz());
+        for (int i = 0; i < A.rows(); i++) {
+            for (int k = A.get_row_pointers()[i]; k < A.get_row_pointers()[i + 1]; k++) {
+                double sum = 0.0;
+                for (int j = 0; j < inner; j++) sum += (double)lhs(i, j) * view(A.get_col_indices()[k], j);
+                expected[k] = (T)sum;
+            }
+        }
+        std::string label = name + " sddmm" + (transposed ? " transposed" : "");
+        BasicSparseMatrix<T> result;
+        A.product(BasicMatrixView<T>(lhs), view, result);
+        BasicSparseMatrix<T> in_place = A;
+        in_place.product(BasicMatrixView<T>(lhs), view);
+        for (int k = 0; k < A.nnz(); k++) {
+            expect_equal(result.get_values()[k], expected[k], label);
+            expect_equal(in_place.get_values()[k], expected[k], label + " in place");
+            expect_equal(result.get_col_indices()[k], A.get_col_indices()[k], label + " column");
+        }
+        // 同じ非ゼロパターンの結果の行列を使い回す
+        A.product(BasicMatrixView<T>(lhs), view, result);
+        for (int k = 0; k < A.nnz(); k++) expect_equal(result.get_values()[k], expected[k], label + " reused");
+    }
+}
+
+// y = alpha * A * x + beta * y と y = alpha * A^T * x + beta * y を SpMV と逐次計算で比べる
+template <class T>
+void test_spmv(const BasicSparseMatrix<T>& A, const std::string& name) {
+    BasicVector<T> x = make_vector<T>(A.cols(), 31);
+    BasicVector<T> x_transposed = make_vector<T>(A.rows(), 32);
+    const double betas[] = {0.0, 1.0, -1.5};
+    for (int b = 0; b < 3; b++) {
+        BasicVector<T> y = make_vector<T>(A.rows(), 33);
+        BasicVector<T> y_transposed = make_vector<T>(A.cols(), 34);
+        std::vector<double> expected(A.rows(), 0.0);
+        std::vector<double> expected_transposed(A.cols(), 0.0);
+        for (int i = 0; i < A.rows(); i++) {
+            for (int k = A.get_row_pointers()[i]; k < A.get_row_pointers()[i + 1]; k++) {
+                expected[i] += (double)A.get_values()[k] * x[A.get_col_indices()[k]];
+                expected_transposed[A.get_col_indices()[k]] += (double)A.get_values()[k] * x_transposed[i];
+            }
+        }
+        std::string label = name + " beta " + std::to_string(betas[b]);
+        for (int i = 0; i < A.rows(); i++) expected[i] = (T)(0.5 * expected[i] + betas[b] * y[i]);
+        for (int j = 0; j < A.cols(); j++) expected_transposed[j] = (T)(0.5 * expected_transposed[j] + betas[b] * y_transposed[j]);
+        spmv(0.5, A, BasicVectorView<T>(x), betas[b], BasicVectorView<T>(y));
+        spmv_transposed(0.5, A, BasicVectorView<T>(x_transposed), betas[b], BasicVectorView<T>(y_transposed));
+        for (int i = 0; i < A.rows(); i++) expect_equal(y[i], expected[i], label + " spmv");
+        for (int j = 0; j < A.cols(); j++) expect_equal(y_transposed[j], expected_transposed[j], label + " spmv_transposed");
+    }
+    BasicVector<T> product = A * BasicVectorView<T>(x);
+    BasicVector<T> transposed_product = A.transposed_product(BasicVectorView<T>(x_transposed));
+    std::vector<double> expected(A.rows(), 0.0);
+    std::vector<double> expected_transposed(A.cols(), 0.0);
+    for (int i = 0; i < A.rows(); i++) {
+        for (int k = A.get_row_pointers()[i]; k < A.get_row_pointers()[i + 1]; k++) {
+            expected[i] += (double)A.get_values()[k] * x[A.get_col_indices()[k]];
+            expected_transposed[A.get_col_indices()[k]] += (double)A.get_values()[k] * x_transposed[i];
+        }
+    }
+    for (int i = 0; i < A.rows(); i++) expect_equal(product[i], (T)expected[i], name + " operator*(Vector)");
+    for (int j = 0; j < A.cols(); j++) expect_equal(transposed_product[j], (T)expected_transposed[j], name + " transposed_product");
+}
+
+// 転置行列を逐次の数え上げで作ったものと比べる（結果の行列を使い回す場合を含む）
+template <class T>
+void test_transpose(const BasicSparseMatrix<T>& A, const std::string& name) {
+    std::vector<std::vector<std::pair<int, double> > > entries(A.cols());
+    for (int i = 0; i < A.rows(); i++) {
+        for (int k = A.get_row_pointers()[i]; k < A.get_row_pointers()[i + 1]; k++) entries[A.get_col_indices()[k]].push_back(std::make_pair(i, (double)A.get_values()[k]));
+    }
+    BasicSparseMatrix<T> expected = from_rows<T>(A.cols(), A.rows(), entries);
+    expect_same(A.transpose(), expected, name + " transpose");
+    BasicSparseMatrix<T> result = A.transpose();
+    A.transpose(result);
+    expect_same(result, expected, name + " transpose reused");
+    expect_same(expected.transpose(), A, name + " transpose twice");
+}
+
+// A * B を行ごとに密な作業配列で集計したものと比べる（top_k > 0 なら絶対値の大きい順、同じなら列の小さい順に top_k 個を残す）
+template <class T>
+void test_spgemm(const BasicSparseMatrix<T>& A, const BasicSparseMatrix<T>& B, const std::string& name) {
+    std::vector<std::vector<std::pair<int, double> > > all_entries(A.rows());
+    std::vector<double> sums(B.cols(), 0.0);
+    std::vector<bool> touched(B.cols(), false);
+    for (int i = 0; i < A.rows(); i++) {
+        for (int a = A.get_row_pointers()[i]; a < A.get_row_pointers()[i + 1]; a++) {
+            int k = A.get_col_indices()[a];
+            for (int b = B.get_row_pointers()[k]; b < B.get_row_pointers()[k + 1]; b++) {
+                int col = B.get_col_indices()[b];
+                if (!touched[col]) all_entries[i].push_back(std::make_pair(col, 0.0));
+                touched[col] = true;
+                sums[col] += (double)A.get_values()[a] * B.get_values()[b];
+            }
+        }
+        for (size_t e = 0; e < all_entries[i].size(); e++) {
+            int col = all_entries[i][e].first;
+            all_entries[i][e].second = sums[col];
+            sums[col] = 0.0;
+            touched[col] = false;
+        }
+        std::sort(all_entries[i].begin(), all_entries[i].end());
+    }
+    const int top_ks[] = {0, 1, 3};
+    for (int t = 0; t < 3; t++) {
+        std::vector<std::vector<std::pair<int, double> > > entries = all_entries;
+        for (int i = 0; i < A.rows(); i++) {
+            if (top_ks[t] > 0 && (int)entries[i].size() > top_ks[t]) {
+                std::sort(entries[i].begin(), entries[i].end(), [](const std::pair<int, double>& lhs, const std::pair<int, double>& rhs) {
+                    return std::fabs(lhs.second) > std::fabs(rhs.second) || (std::fabs(lhs.second) == std::fabs(rhs.second) && lhs.first < rhs.first);
+                });
+                entries[i].resize(top_ks[t]);
+                std::sort(entries[i].begin(), entries[i].end());
+            }
+        }
+        BasicSparseMatrix<T> expected = from_rows<T>(A.rows(), B.cols(), entries);
+        expect_same(spgemm(A, B, top_ks[t]), expected, name + " spgemm top_k " + std::to_string(top_ks[t]));
+        if (top_ks[t] == 0) expect_same(A * B, expected, name + " operator*(SparseMatrix)");
+    }
+}
+
+// 条件に合う要素を逐次に取り除いたものと prune, remove_zeros を比べる
+template <class T>
+void test_prune(const BasicSparseMatrix<T>& A, const std::string& name) {
+    for (int mode = 0; mode < 3; mode++) {
+        std::vector<std::vector<std::pair<int, double> > > entries(A.rows());
+        int removed = 0;
+        for (int i = 0; i < A.rows(); i++) {
+            for (int k = A.get_row_pointers()[i]; k < A.get_row_pointers()[i + 1]; k++) {
+                int col = A.get_col_indices()[k];
+                double value = A.get_values()[k];
+                bool remove = mode == 0 ? value == 0.0 : mode == 1 ? std::fabs(value) <= 0.5 : (i + col) % 3 == 0;
+                if (remove) {
+                    removed++;
+                } else {
+                    entries[i].push_back(std::make_pair(col, value));
+                }
+            }
+        }
+        BasicSparseMatrix<T> expected = from_rows<T>(A.rows(), A.cols(), entries);
+        BasicSparseMatrix<T> pruned = A;
+        int count;
+        std::string label = name + " prune";
+        if (mode == 0) {
+            count = pruned.prune();
+            BasicSparseMatrix<T> copy = A;
+            expect_same(copy.remove_zeros(), expected, name + " remove_zeros");
+        } else if (mode == 1) {
+            count = pruned.prune(0.5);
+            label += " threshold";
+        } else {
+            count = pruned.prune([](int row, int col, T) { return (row + col) % 3 == 0; });
+            label += " predicate";
+        }
+        expect_equal(count, removed, label + " count");
+        expect_same(pruned, expected, label);
+    }
+}
+
+template <class T>
+void run(const Case& c) {
+    BasicSparseMatrix<T> A = make_matrix<T>(c, 5);
+    std::string name = std::string(c.kind) + " " + std::to_string(c.rows) + " x " + std::to_string(c.cols) + " threads " + std::to_string(get_num_threads());
+    test_spmm(A, name);
+    test_sddmm(A, name);
+    test_spmv(A, name);
+    test_transpose(A, name);
+    // 大きな乱数の行列の A * A^T は結果が密になるので、右側を列の少ない行列にする
+    Case right = {c.cols, 250, c.kind};
+    if (std::string(c.kind) != "random" || c.rows <= 300) test_spgemm(A, A.transpose(), name + " A * A^T");
+    if (std::string(c.kind) == "random") test_spgemm(A, make_matrix<T>(right, 6), name + " A * B");
+    test_prune(A, name);
+}
+
+}  // namespace
+
+int main(void) {
+    const int threads[] = {1, 4};
+    for (int t = 0; t < 2; t++) {
+        set_num_threads(threads[t]);
+        for (size_t c = 0; c < sizeof(kCases) / sizeof(kCases[0]); c++) {
+            run<double>(kCases[c]);
+            run<float>(kCases[c]);
+        }
+    }
+    if (failures > 0) {
+        std::cerr << failures << " failures" << std::endl;
+        exit(1);
+    }
+    std::cout << "sparse_matrix_test: OK" << std::endl;
+    return 0;
+}
@@ -0,0 +1,90 @@
+// 右辺値のベクトルの演算子が Matrix::operator[] の戻り値（行列の行を参照するベクトル）を書き換えないことを確かめるテスト
+// g++ -std=c++11 -O2 -pthread -I.. vector_rvalue_test.cxx ../*.cxx && ./a.out
+#include <cstdlib>   // exit の標準ライブラリ
+#include <iostream>  // 入出力の標準ライブラリ
+
+#include "matrix.h"
+
+namespace {
+
+int failures = 0;
+
+// 行列が初期値（m(i, j) = 3i + j + 1）のままであることを確かめる
+template <class T>
+void check_unchanged(const BasicMatrix<T>& m, const char* name) {
+    for (int i = 0; i < m.rows(); i++) {
+        for (int j = 0; j < m.cols(); j++) {
+            if (m(i, j) != 3 * i + j + 1) {
+                std::cerr << name << ": m(" << i << ", " << j << ") changed to " << m(i, j) << std::endl;
+                failures++;
+            }
+        }
+    }
+}
+
+// 行列の行の値に対して結果を確かめる
+template <class T>
+void check_result(const BasicVector<T>& result, const double* expected, const char* name) {
+    for (int j = 0; j < result.size(); j++) {
+        if (result[j] != expected[j]) {
+            std::cerr << name << ": result[" << j << "] = " << result[j] << ", expected " << expected[j] << std::endl;
+            failures++;
+        }
+    }
+}
+
+template <class T>
+void run(void) {
+    BasicMatrix<T> m(2, 3);
+    for (int i = 0; i < 2; i++) {
+        for (int j = 0; j < 3; j++) {
+            m(i, j) = 3 * i + j + 1;
+        }
+    }
+    BasicVector<T> v(3, 1.0, "all");
+
+    const double scaled[] = {2, 4, 6};
+    check_result(BasicVector<T>(2.0 * m[0]), scaled, "2.0 * m[0]");
+    check_unchanged(m, "2.0 * m[0]");
+
+    const double halved[] = {2, 2.5, 3};
+    check_result(BasicVector<T>(m[1] / 2.0), halved, "m[1] / 2.0");
+    check_unchanged(m, "m[1] / 2.0");
+
+    const double negated[] = {-4, -5, -6};
+    check_result(BasicVector<T>(-m[1]), negated, "-m[1]");
+    check_unchanged(m, "-m[1]");
+
+    const double added[] = {5, 6, 7};
+    check_result(BasicVector<T>(m[1] + v), added, "m[1] + v");
+    check_unchanged(m, "m[1] + v");
+    check_result(BasicVector<T>(v + m[1]), added, "v + m[1]");
+    check_unchanged(m, "v + m[1]");
+
+    const double subtracted[] = {3, 4, 5};
+    check_result(BasicVector<T>(m[1] - v), subtracted, "m[1] - v");
+    check_unchanged(m, "m[1] - v");
+    const double reversed[] = {-3, -4, -5};
+    check_result(BasicVector<T>(v - m[1]), reversed, "v - m[1]");
+    check_unchanged(m, "v - m[1]");
+
+    const double rows_added[] = {5, 7, 9};
+    check_result(BasicVector<T>(m[0] + m[1]), rows_added, "m[0] + m[1]");
+    check_unchanged(m, "m[0] + m[1]");
+    const double rows_subtracted[] = {-3, -3, -3};
+    check_result(BasicVector<T>(m[0] - m[1]), rows_subtracted, "m[0] - m[1]");
+    check_unchanged(m, "m[0] - m[1]");
+}
+
+}  // namespace
+
+int main(void) {
+    run<double>();
+    run<float>();
+    if (failures > 0) {
+        std::cerr << failures << " failures" << std::endl;
+        exit(1);
+    }
+    std::cout << "vector_rvalue_test: OK" << std::endl;
+    return 0;
+}
@@ -0,0 +1,270 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+
+namespace {
+
+thread_local int current_worker = -1;     // 実行中のワーカー番号（ワーカー以外は-1）
+thread_local int thread_limit = 0;        // ScopedThreadLimit による上限（0は制限なし）
+std::atomic<int> global_num_threads(-1);  // set_num_threads による上限（-1は未初期化）
+
+// ハードウェアのスレッド数を返す
+int hardware_threads() {
+    int n = (int)std::thread::hardware_concurrency();
+    return n > 0 ? n : 1;
+}
+
+// 環境変数 MATH_UTILS_NUM_THREADS を考慮した既定のスレッド数を返す
+int default_threads() {
+    const char* env = std::getenv("MATH_UTILS_NUM_THREADS");
+    if (env != nullptr) {
+        int n = std::atoi(env);
+        if (n > 0) return n;
+    }
+    return hardware_threads();
+}
+
+// 上限を考慮して、この呼び出しで使うスレッド数を返す
+int effective_threads(int max_threads) {
+    int n = global_num_threads.load();
+    if (n < 0) {
+        n = default_threads();
+        global_num_threads.store(n);
+    }
+    if (thread_limit > 0 && thread_limit < n) n = thread_limit;
+    if (max_threads > 0 && max_threads < n) n = max_threads;
+    return n > 0 ? n : 1;
+}
+
+// parallel_for の1回の呼び出しで共有する状態
+struct ParallelJob {
+    const std::function<void(int, int)>* body; // 実行する処理
+    int begin;                                 // 区間の先頭
+    int size;                                  // 区間の大きさ
+    int chunks;                                // 分割数
+    std::atomic<int> next;                     // 次に取り出す分割の番号
+    std::atomic<int> done;                     // 完了した分割数
+    std::mutex mutex;                          // 完了待ち用の排他制御
+    std::condition_variable finished;          // 完了待ち用の条件変数
+
+    // 分割を1つ取り出して実行する（残りがなければfalseを返す）
+    bool run_one() {
+        int chunk = next.fetch_add(1);
+        if (chunk >= chunks) return false;
+        int first = begin + (int)((long long)size * chunk / chunks);
+        int last = begin + (int)((long long)size * (chunk + 1) / chunks);
+        (*body)(first, last);
+        if (done.fetch_add(1) + 1 == chunks) {
+            std::lock_guard<std::mutex> lock(mutex);
+            finished.notify_all();
+        }
+        return true;
+    }
+};
+
+}  // namespace
+
+// ワーカー数を指定するコンストラクタ
+ThreadPool::ThreadPool(int num_workers) : pending_(0), next_queue_(0), stop_(false) {
+    for (int i = 0; i < num_workers; i++) {
+        workers_.push_back(new Worker);
+    }
+    for (int i = 0; i < num_workers; i++) {
+        threads_.push_back(std::thread(&ThreadPool::run, this, i));
+    }
+}
+
+// デストラクタ
+ThreadPool::~ThreadPool(void) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    condition_.notify_all();
+    for (size_t i = 0; i < threads_.size(); i++) {
+        threads_[i].join();
+    }
+    for (size_t i = 0; i < workers_.size(); i++) {
+        delete workers_[i];
+    }
+}
+
+// ワーカー数を返す
+int ThreadPool::size(void) const { return (int)workers_.size(); }
+
+// タスクを投入する
+void ThreadPool::submit(std::function<void()> task) {
+    int queue;
+    if (current_worker >= 0) {
+        queue = current_worker;  // ワーカーからの投入は自分のキューに積む
+    } else {
+        queue = (int)(next_queue_.fetch_add(1) % workers_.size());
+    }
+    {
+        std::lock_guard<std::mutex> lock(workers_[queue]->mutex);
+        workers_[queue]->tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_++;
+    }
+    condition_.notify_one();
+}
+
+// 自分のキューの末尾から取り出し、空なら他のワーカーのキューの先頭から盗む
+bool ThreadPool::pop(int id, std::function<void()>& task) {
+    int n = (int)workers_.size();
+    for (int i = 0; i < n; i++) {
+        Worker* worker = workers_[(id + i) % n];
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        if (worker->tasks.empty()) continue;
+        if (i == 0) {
+            task = std::move(worker->tasks.back());
+            worker->tasks.pop_back();
+        } else {
+            task = std::move(worker->tasks.front());
+            worker->tasks.pop_front();
+        }
+        pending_--;
+        return true;
+    }
+    return false;
+}
+
+// ワーカースレッドの本体
+void ThreadPool::run(int id) {
+    current_worker = id;
+    while (true) {
+        std::function<void()> task;
+        if (pop(id, task)) {
+            task();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(mutex_);
+        condition_.wait(lock, [this] { return stop_ || pending_.load() > 0; });
+        if (stop_ && pending_.load() == 0) return;
+    }
+}
+
+// ライブラリ共通のスレッドプールを返す（呼び出しスレッドも計算に加わるため、ワーカー数はスレッド数-1）
+ThreadPool& ThreadPool::instance(void) {
+    static ThreadPool pool(default_threads() - 1);
+    return pool;
+}
+
+// 呼び出し元がワーカースレッドかを返す
+bool ThreadPool::in_worker(void) { return current_worker >= 0; }
+
+// 上限を設定するコンストラクタ
+ScopedThreadLimit::ScopedThreadLimit(int max_threads) : previous_(thread_limit) { thread_limit = max_threads; }
+
+// 以前の上限に戻すデストラクタ
+ScopedThreadLimit::~ScopedThreadLimit(void) { thread_limit = previous_; }
+
+// ライブラリ全体で使うスレッド数の上限を設定する関数
+void set_num_threads(int n) { global_num_threads.store(n > 0 ? n : default_threads()); }
+
+// 現在の呼び出しで使われるスレッド数を返す関数
+int get_num_threads(void) {
+    int n = effective_threads(0);
+    int available = ThreadPool::instance().size() + 1;
+    return n < available ? n : available;
+}
+
+// 区間を分割して並列に実行する関数
+void parallel_for(int begin, int end, int grain, const std::function<void(int, int)>& body, int max_threads) {
+    int size = end - begin;
+    if (size <= 0) return;
+    if (grain < 1) grain = 1;
+    int threads = effective_threads(max_threads);
+    if (threads <= 1 || size <= grain || ThreadPool::in_worker()) {
+        body(begin, end);
+        return;
+    }
+    ThreadPool& pool = ThreadPool::instance();
+    if (threads > pool.size() + 1) threads = pool.size() + 1;
+    long long chunks = ((long long)size + grain - 1) / grain;
+    if (chunks > 4LL * threads) chunks = 4LL * threads;
+    if (threads <= 1 || chunks <= 1) {
+        body(begin, end);
+        return;
+    }
+    if (threads > chunks) threads = (int)chunks;
+
+    std::shared_ptr<ParallelJob> job(new ParallelJob);
+    job->body = &body;
+    job->begin = begin;
+    job->size = size;
+    job->chunks = (int)chunks;
+    job->next.store(0);
+    job->done.store(0);
+
+    // 呼び出しスレッド以外の threads-1 個のワーカーが分割を取り合う
+    for (int i = 0; i < threads - 1; i++) {
+        pool.submit([job] {
+            while (job->run_one()) {
+            }
+        });
+    }
+    while (job->run_one()) {
+    }
+    std::unique_lock<std::mutex> lock(job->mutex);
+    job->finished.wait(lock, [&job] { return job->done.load() == job->chunks; });
+}
+
+// 区間を分割して並列に実行し、戻り値の総和を返す関数
+double parallel_sum(int begin, int end, int grain, const std::function<double(int, int)>& body, int max_threads) {
+    int size = end - begin;
+    if (size <= 0) return 0.0;
+    if (grain < 1) grain = 1;
+    // 分割数は区間の大きさだけで決める
+    long long blocks = ((long long)size + grain - 1) / grain;
+    if (blocks > 1024) blocks = 1024;
+    if (blocks <= 1) return body(begin, end);
+
+    std::vector<double> partial((size_t)blocks, 0.0);
+    int num_blocks = (int)blocks;
+    parallel_for(0, num_blocks, 1, [&](int first, int last) {
+        for (int b = first; b < last; b++) {
+            int block_begin = begin + (int)((long long)size * b / num_blocks);
+            int block_end = begin + (int)((long long)size * (b + 1) / num_blocks);
+            partial[b] = body(block_begin, block_end);
+        }
+    }, max_threads);
+
+    double result = 0.0;
+    for (int b = 0; b < num_blocks; b++) {
+        result += partial[b];
+    }
+    return result;
+}
+
+// values[0, size) をその位置までの総和（包括的な累積和）に置き換える関数
+void parallel_prefix_sum(int* values, int size) {
+    if (size <= 0) return;
+    int blocks = std::max(1, std::min(4 * get_num_threads(), size / kParallelGrain));
+    std::vector<int> block_offsets(blocks + 1, 0);
+    parallel_for(0, blocks, 1, [&](int first, int last) {
+        for (int b = first; b < last; b++) {
+            int sum = 0;
+            for (int i = (int)((long long)size * b / blocks); i < (int)((long long)size * (b + 1) / blocks); i++) {
+                sum += values[i];
+            }
+            block_offsets[b + 1] = sum;
+        }
+    });
+    for (int b = 0; b < blocks; b++) {
+        block_offsets[b + 1] += block_offsets[b];
+    }
+    parallel_for(0, blocks, 1, [&](int first, int last) {
+        for (int b = first; b < last; b++) {
+            int sum = block_offsets[b];
+            for (int i = (int)((long long)size * b / blocks); i < (int)((long long)size * (b + 1) / blocks); i++) {
+                sum += values[i];
+                values[i] = sum;
+            }
+        }
+    });
+}
@@ -0,0 +1,69 @@
+#include <atomic>              // アトミック操作の標準ライブラリ
+#include <condition_variable>  // 条件変数の標準ライブラリ
+#include <deque>               // 両端キューの標準ライブラリ
+#include <functional>          // 関数オブジェクトの標準ライブラリ
+#include <mutex>               // 排他制御の標準ライブラリ
+#include <thread>              // スレッドの標準ライブラリ
+#include <vector>              // 可変長配列の標準ライブラリ
+
+#ifndef __THREAD_POOL__
+#define __THREAD_POOL__
+
+// ライブラリ全体で共有するワークスティーリング型のスレッドプール
+// 各ワーカーは自分のキューの末尾からタスクを取り出し、空になると他のワーカーのキューの先頭から盗む
+class ThreadPool {
+   private:
+    struct Worker {
+        std::deque<std::function<void()>> tasks; // ワーカーごとのタスクキュー
+        std::mutex mutex;                        // タスクキューの排他制御
+    };
+    std::vector<Worker*> workers_;         // ワーカーの配列
+    std::vector<std::thread> threads_;     // ワーカースレッドの配列
+    std::mutex mutex_;                     // 待機用の排他制御
+    std::condition_variable condition_;    // 待機用の条件変数
+    std::atomic<int> pending_;             // キューに積まれているタスク数
+    std::atomic<unsigned> next_queue_;     // 外部から投入する際のキューの順番
+    bool stop_;                            // 終了フラグ
+
+    void run(int id);                                  // ワーカースレッドの本体
+    bool pop(int id, std::function<void()>& task);     // 自分のキューから取り出すか他から盗む
+
+   public:
+    explicit ThreadPool(int num_workers);  // ワーカー数を指定するコンストラクタ
+    ~ThreadPool(void);                     // デストラクタ
+    int size(void) const;                  // ワーカー数を返す
+    void submit(std::function<void()> task); // タスクを投入する
+    static ThreadPool& instance(void);     // ライブラリ共通のスレッドプールを返す
+    static bool in_worker(void);           // 呼び出し元がワーカースレッドかを返す
+};
+
+// スレッド数の上限をスコープ内（呼び出しスレッドのみ）で設定するクラス
+class ScopedThreadLimit {
+   private:
+    int previous_;  // 以前の上限
+
+   public:
+    explicit ScopedThreadLimit(int max_threads); // 上限を設定するコンストラクタ
+    ~ScopedThreadLimit(void);                    // 以前の上限に戻すデストラクタ
+};
+
+// この要素数以下の要素ごとの処理は並列化しない
+const int kParallelGrain = 1 << 15;
+
+void set_num_threads(int n); // ライブラリ全体で使うスレッド数の上限を設定する関数（0で既定値）
+int get_num_threads(void);   // 現在の呼び出しで使われるスレッド数を返す関数
+
+// [begin, end) を grain 以上の大きさの区間に分割して並列に body(区間の先頭, 区間の末尾) を実行する関数
+// 区間全体が grain 以下の場合やワーカースレッド内から呼ばれた場合は呼び出しスレッドで逐次実行する
+// max_threads > 0 の場合、この呼び出しで使うスレッド数をさらに制限する
+void parallel_for(int begin, int end, int grain, const std::function<void(int, int)>& body, int max_threads = 0);
+
+// parallel_for と同様に分割し、各区間の body の戻り値の総和を返す関数
+// 区間の分割はスレッド数に依存しないため、結果は実行ごとに一致する
+double parallel_sum(int begin, int end, int grain, const std::function<double(int, int)>& body, int max_threads = 0);
+
+// values[0, size) をその位置までの総和（包括的な累積和）に置き換える関数
+// ブロックごとの総和を並列に求めてから、各ブロックを並列に累積する
+void parallel_prefix_sum(int* values, int size);
+
+#endif
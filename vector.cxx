@@ -1,13 +1,18 @@
 #include "vector.h"
 
+#include <algorithm>
+
 // デフォルトコンストラクタ
-Vector::Vector(void) : size_(0), values_(nullptr), part_of_matrix_(false) {}
+template <class T>
+BasicVector<T>::BasicVector(void) : size_(0), values_(nullptr), part_of_matrix_(false) {}
 
 // 値とサイズを指定するコンストラクタ
-Vector::Vector(double* values, int size) : values_(values), size_(size) { part_of_matrix_ = true; }
+template <class T>
+BasicVector<T>::BasicVector(T* values, int size) : values_(values), size_(size) { part_of_matrix_ = true; }
 
 // サイズを指定するコンストラクタ
-Vector::Vector(int n) try : size_(n), values_(new double[n]), part_of_matrix_(false) {
+template <class T>
+BasicVector<T>::BasicVector(int n) try : size_(n), values_(simd_alloc<T>(n)), part_of_matrix_(false) {
 } catch (std::bad_alloc) {
     std::cerr << "Vector::Vector(int n) : Out of Memory" << std::endl;
     std::cerr << "n:" << n << std::endl;
@@ -15,7 +20,8 @@ Vector::Vector(int n) try : size_(n), values_(new double[n]), part_of_matrix_(fa
 }
 
 // サイズ、値、およびフラグを指定するコンストラクタ
-Vector::Vector(int n, double value, const char* flag) try : size_(n), values_(new double[n]), part_of_matrix_(false) {
+template <class T>
+BasicVector<T>::BasicVector(int n, double value, const char* flag) try : size_(n), values_(simd_alloc<T>(n)), part_of_matrix_(false) {
     if (strcmp(flag, "all") != 0) {
         std::cerr << "Unknown option: \"" << flag << "\"" << std::endl;
         throw;
@@ -30,7 +36,8 @@ Vector::Vector(int n, double value, const char* flag) try : size_(n), values_(ne
 }
 
 // コピーコンストラクタ
-Vector::Vector(const Vector& arg) try : size_(arg.size()), values_(new double[arg.size()]), part_of_matrix_(false) {
+template <class T>
+BasicVector<T>::BasicVector(const BasicVector& arg) try : size_(arg.size()), values_(simd_alloc<T>(arg.size())), part_of_matrix_(false) {
     int arg_size = arg.size();
     for (int i = 0; i < arg_size; i++) {
         values_[i] = arg.values_[i];
@@ -40,15 +47,35 @@ Vector::Vector(const Vector& arg) try : size_(arg.size()), values_(new double[ar
     throw;
 }
 
+// ビューの要素をコピーするコンストラクタ
+template <class T>
+BasicVector<T>::BasicVector(const BasicVectorView<T>& arg) try : size_(arg.size()), values_(simd_alloc<T>(arg.size())), part_of_matrix_(false) {
+    for (int i = 0; i < size_; i++) {
+        values_[i] = arg[i];
+    }
+} catch (std::bad_alloc) {
+    std::cerr << "Vector::Vector(const VectorView& arg) : Out of Memory" << std::endl;
+    throw;
+}
+
+// ムーブコンストラクタ
+template <class T>
+BasicVector<T>::BasicVector(BasicVector&& arg) : values_(arg.values_), size_(arg.size_), part_of_matrix_(arg.part_of_matrix_) {
+    arg.values_ = nullptr;
+    arg.size_ = 0;
+    arg.part_of_matrix_ = false;
+}
+
 // 代入演算子
-Vector& Vector::operator=(const Vector& rhs) {
+template <class T>
+BasicVector<T>& BasicVector<T>::operator=(const BasicVector& rhs) {
     if (this != &rhs) {
         int rhs_size = rhs.size();
         if (size_ != rhs_size) {
             size_ = rhs_size;
-            delete[] values_;
+            simd_free(values_);
             try {
-                values_ = new double[size_];
+                values_ = simd_alloc<T>(size_);
             } catch (std::bad_alloc) {
                 std::cerr << "Vector::operator=: Out of Memory" << std::endl;
                 throw;
@@ -61,48 +88,65 @@ Vector& Vector::operator=(const Vector& rhs) {
     return *this;
 }
 
+// ムーブ代入演算子
+template <class T>
+BasicVector<T>& BasicVector<T>::operator=(BasicVector&& rhs) {
+    if (this == &rhs) return *this;
+    // 行列の行を参照している場合は、どちらも値のコピーで代入する
+    if (part_of_matrix_ || rhs.part_of_matrix_) {
+        return *this = static_cast<const BasicVector&>(rhs);
+    }
+    simd_free(values_);
+    values_ = rhs.values_;
+    size_ = rhs.size_;
+    rhs.values_ = nullptr;
+    rhs.size_ = 0;
+    return *this;
+}
+
 // デストラクタ
-Vector::~Vector(void) {
-    if (part_of_matrix_ == false) delete[] values_;
+template <class T>
+BasicVector<T>::~BasicVector(void) {
+    if (part_of_matrix_ == false) simd_free(values_);
 }
 
 // サイズを取得するメソッド
-int Vector::size(void) const { return size_; }
+template <class T>
+int BasicVector<T>::size(void) const { return size_; }
 
 // インデックスで要素にアクセスするためのconstメソッド
-double Vector::operator[](int index) const { return values_[index]; }
+template <class T>
+T BasicVector<T>::operator[](int index) const { return values_[index]; }
 
 // インデックスで要素にアクセスするための非constメソッド
-double& Vector::operator[](int index) { return values_[index]; }
+template <class T>
+T& BasicVector<T>::operator[](int index) { return values_[index]; }
 
 // 加算代入演算子
-Vector& Vector::operator+=(const Vector& rhs) {
+template <class T>
+BasicVector<T>& BasicVector<T>::operator+=(const BasicVector& rhs) {
     if (size_ != rhs.size()) {
         std::cerr << "Vector::operator+=: Size Unmatched" << std::endl;
         exit(1);
     }
-    int size = size_;
-    for (int i = 0; i < size; i++) {
-        values_[i] += rhs[i];
-    }
+    simd_add(values_, rhs.values_, size_);
     return *this;
 }
 
 // 減算代入演算子
-Vector& Vector::operator-=(const Vector& rhs) {
+template <class T>
+BasicVector<T>& BasicVector<T>::operator-=(const BasicVector& rhs) {
     if (size_ != rhs.size()) {
         std::cerr << "Vector::operator-=: Size Unmatched!" << std::endl;
         exit(1);
     }
-    int size = size_;
-    for (int i = 0; i < size; i++) {
-        values_[i] -= rhs[i];
-    }
+    simd_sub(values_, rhs.values_, size_);
     return *this;
 }
 
 // ベクトルを出力するメソッド
-std::ostream& Vector::print(std::ostream& lhs) const {
+template <class T>
+std::ostream& BasicVector<T>::print(std::ostream& lhs) const {
     lhs << "(";
     int size = size_;
     for (int i = 0; i < size; i++) {
@@ -112,73 +156,74 @@ std::ostream& Vector::print(std::ostream& lhs) const {
     return lhs;
 }
 
-// 単項プラス演算子
-Vector Vector::operator+(void) const { return *this; }
+// データへのポインタを取得するメソッド
+template <class T>
+T* BasicVector<T>::get_values() { return values_; }
 
-// 単項マイナス演算子
-Vector Vector::operator-(void) const {
-    Vector result(*this);
-    int size = size_;
-    for (int i = 0; i < size; i++) {
-        result[i] = -result[i];
-    }
-    return result;
-}
+// データへのポインタを取得するメソッド（const版）
+template <class T>
+const T* BasicVector<T>::get_values() const { return values_; }
 
-// データへのポインタを取得するメソッド
-double* Vector::get_values() { return values_; }
+// 行列の行を参照しているかを返すメソッド
+template <class T>
+bool BasicVector<T>::part_of_matrix(void) const { return part_of_matrix_; }
 
 // ベクトルの出力演算子
-std::ostream& operator<<(std::ostream& lhs, const Vector& rhs) { return rhs.print(lhs); }
+template <class T>
+std::ostream& operator<<(std::ostream& lhs, const BasicVector<T>& rhs) { return rhs.print(lhs); }
 
-// ベクトルの加算演算子
-Vector operator+(const Vector& lhs, const Vector& rhs) {
-    Vector result(lhs);
-    return result += rhs;
+// ベクトルの加算演算子（右辺値同士）
+template <class T>
+BasicVector<T> operator+(BasicVector<T>&& lhs, BasicVector<T>&& rhs) {
+    BasicVector<T> result = reusable(std::move(lhs));
+    result += rhs;
+    return result;
 }
 
-// ベクトルの減算演算子
-Vector operator-(const Vector& lhs, const Vector& rhs) {
-    Vector result(lhs);
-    return result -= rhs;
+// ベクトルの減算演算子（右辺値同士）
+template <class T>
+BasicVector<T> operator-(BasicVector<T>&& lhs, BasicVector<T>&& rhs) {
+    BasicVector<T> result = reusable(std::move(lhs));
+    result -= rhs;
+    return result;
 }
 
-// ベクトルの内積演算子
-double operator*(const Vector& lhs, const Vector& rhs) {
-    if (lhs.size() != rhs.size()) {
-        std::cerr << "operator*(const Vector &, const Vector &): Size Unmatched" << std::endl;
-        exit(1);
-    }
-    double result = 0.0;
-    int size = lhs.size();
+// ベクトルとスカラーの乗算演算子（右辺値）
+template <class T>
+BasicVector<T> operator*(double lhs, BasicVector<T>&& rhs) {
+    BasicVector<T> result = reusable(std::move(rhs));
+    int size = result.size();
     for (int i = 0; i < size; i++) {
-        result += lhs[i] * rhs[i];
+        result[i] = lhs * result[i];
     }
     return result;
 }
 
-// ベクトルとスカラーの乗算演算子
-Vector operator*(double lhs, const Vector& rhs) {
-    Vector result(rhs);
+// ベクトルとスカラーの除算演算子（右辺値）
+template <class T>
+BasicVector<T> operator/(BasicVector<T>&& lhs, double rhs) {
+    BasicVector<T> result = reusable(std::move(lhs));
     int size = result.size();
     for (int i = 0; i < size; i++) {
-        result[i] = lhs * rhs[i];
+        result[i] = result[i] / rhs;
     }
     return result;
 }
 
-// ベクトルとスカラーの除算演算子
-Vector operator/(const Vector& lhs, double rhs) {
-    Vector result(lhs);
+// 単項マイナス演算子（右辺値）
+template <class T>
+BasicVector<T> operator-(BasicVector<T>&& arg) {
+    BasicVector<T> result = reusable(std::move(arg));
     int size = result.size();
     for (int i = 0; i < size; i++) {
-        result[i] = lhs[i] / rhs;
+        result[i] = -result[i];
     }
     return result;
 }
 
 // ベクトルの等価比較演算子
-bool operator==(const Vector& lhs, const Vector& rhs) {
+template <class T>
+bool operator==(const BasicVector<T>& lhs, const BasicVector<T>& rhs) {
     if (lhs.size() != rhs.size()) {
         return false;
     }
@@ -192,54 +237,251 @@ bool operator==(const Vector& lhs, const Vector& rhs) {
 }
 
 // ベクトルの不等価比較演算子
-bool operator!=(const Vector& lhs, const Vector& rhs) {
+template <class T>
+bool operator!=(const BasicVector<T>& lhs, const BasicVector<T>& rhs) {
+    return !(lhs == rhs);
+}
+
+// ビューのカーネルは要素の型ごとに実体化し、非テンプレートの関数から呼び出す
+namespace {
+
+// 内積を計算する関数
+template <class T>
+double dot_kernel(const BasicVectorView<T>& lhs, const BasicVectorView<T>& rhs) {
     if (lhs.size() != rhs.size()) {
-        return true;
+        std::cerr << "dot(const VectorView &, const VectorView &): Size Unmatched" << std::endl;
+        exit(1);
+    }
+    if (lhs.contiguous() && rhs.contiguous()) {
+        return simd_dot(lhs.data(), rhs.data(), lhs.size());
     }
+    double result = 0.0;
     int size = lhs.size();
     for (int i = 0; i < size; i++) {
-        if (lhs[i] != rhs[i]) {
-            return true;
-        }
+        result += (double)lhs[i] * rhs[i];
     }
-    return false;
+    return result;
 }
 
-// ベクトルの平方和を計算する関数
-double squared_sum(const Vector& arg) {
+// 平方和を計算する関数
+template <class T>
+double squared_sum_kernel(const BasicVectorView<T>& arg) {
+    if (arg.contiguous()) {
+        return simd_sum_squares(arg.data(), arg.size());
+    }
     double result = 0.0;
     int size = arg.size();
     for (int i = 0; i < size; i++) {
-        result += arg[i] * arg[i];
+        result += (double)arg[i] * arg[i];
     }
     return result;
 }
 
-// ベクトルのpノルムを計算する関数
-double norm(const Vector& arg, int p) {
+// 最大ノルムを計算する関数
+template <class T>
+double max_norm_kernel(const BasicVectorView<T>& arg) {
+    if (arg.contiguous()) {
+        return simd_max_abs(arg.data(), arg.size());
+    }
     double result = 0.0;
     int size = arg.size();
     for (int i = 0; i < size; i++) {
-        result += pow(fabs(arg[i]), p);
+        result = std::max(result, fabs((double)arg[i]));
     }
-    result = pow(result, 1.0 / (double)p);
     return result;
 }
 
-// ベクトルの最大ノルムを計算する関数
-double max_norm(const Vector& arg) {
-    double result = fabs(arg[0]);
+// pノルムを計算する関数
+template <class T>
+double norm_kernel(const BasicVectorView<T>& arg, int p) {
+    if (arg.contiguous()) {
+        if (p == 1) return simd_sum_abs(arg.data(), arg.size());
+        if (p == 2) return sqrt(simd_sum_squares(arg.data(), arg.size()));
+    }
+    if (p == 2) return sqrt(squared_sum_kernel(arg));
+    if (p == kInfinityNorm) return max_norm_kernel(arg);
+    double result = 0.0;
     int size = arg.size();
-    for (int i = 1; i < size; i++) {
-        double tmp = fabs(arg[i]);
-        if (result < tmp) {
-            result = tmp;
-        }
+    for (int i = 0; i < size; i++) {
+        result += p == 1 ? fabs((double)arg[i]) : pow(fabs((double)arg[i]), p);
     }
-    return result;
+    return p == 1 ? result : pow(result, 1.0 / (double)p);
 }
 
-// ベクトルの平方ノルムを計算する関数
-double squared_norm(const Vector& arg) {
-    return sqrt(squared_sum(arg));
+// 平方ノルムを計算する関数
+template <class T>
+double squared_norm_kernel(const BasicVectorView<T>& arg) { return sqrt(squared_sum_kernel(arg)); }
+
+// y += alpha * x
+template <class T>
+void axpy_kernel(double alpha, const BasicVectorView<T>& x, const BasicVectorView<T>& y) {
+    if (x.size() != y.size()) {
+        std::cerr << "axpy(double, const VectorView &, const VectorView &): Size Unmatched" << std::endl;
+        exit(1);
+    }
+    if (x.contiguous() && y.contiguous()) {
+        simd_axpy(alpha, x.data(), y.data(), y.size());
+        return;
+    }
+    int size = y.size();
+    for (int i = 0; i < size; i++) {
+        y[i] += alpha * x[i];
+    }
+}
+
+// y = alpha * x + beta * y
+template <class T>
+void axpby_kernel(double alpha, const BasicVectorView<T>& x, double beta, const BasicVectorView<T>& y) {
+    if (x.size() != y.size()) {
+        std::cerr << "axpby(double, const VectorView &, double, const VectorView &): Size Unmatched" << std::endl;
+        exit(1);
+    }
+    if (x.contiguous() && y.contiguous()) {
+        simd_axpby(alpha, x.data(), beta, y.data(), y.size());
+        return;
+    }
+    int size = y.size();
+    for (int i = 0; i < size; i++) {
+        y[i] = alpha * x[i] + beta * y[i];
+    }
+}
+
+// x *= alpha
+template <class T>
+void scal_kernel(double alpha, const BasicVectorView<T>& x) {
+    if (x.contiguous()) {
+        simd_scal(alpha, x.data(), x.size());
+        return;
+    }
+    int size = x.size();
+    for (int i = 0; i < size; i++) {
+        x[i] *= alpha;
+    }
+}
+
+// z += alpha * x * y（要素ごとの積）
+template <class T>
+void fmadd_kernel(double alpha, const BasicVectorView<T>& x, const BasicVectorView<T>& y, const BasicVectorView<T>& z) {
+    if (x.size() != z.size() || y.size() != z.size()) {
+        std::cerr << "fmadd(double, const VectorView &, const VectorView &, const VectorView &): Size Unmatched" << std::endl;
+        exit(1);
+    }
+    if (x.contiguous() && y.contiguous() && z.contiguous()) {
+        simd_fmadd(alpha, x.data(), y.data(), z.data(), z.size());
+        return;
+    }
+    int size = z.size();
+    for (int i = 0; i < size; i++) {
+        z[i] += alpha * x[i] * y[i];
+    }
+}
+
+// 内積と両方の平方和を同時に計算する関数
+template <class T>
+void dot_and_norms_kernel(const BasicVectorView<T>& x, const BasicVectorView<T>& y, double& xy, double& xx, double& yy) {
+    if (x.size() != y.size()) {
+        std::cerr << "dot_and_norms(const VectorView &, const VectorView &, double &, double &, double &): Size Unmatched" << std::endl;
+        exit(1);
+    }
+    if (x.contiguous() && y.contiguous()) {
+        simd_dot_norms(x.data(), y.data(), x.size(), &xy, &xx, &yy);
+        return;
+    }
+    xy = xx = yy = 0.0;
+    int size = x.size();
+    for (int i = 0; i < size; i++) {
+        double x_i = x[i];
+        double y_i = y[i];
+        xy += x_i * y_i;
+        xx += x_i * x_i;
+        yy += y_i * y_i;
+    }
+}
+
+// 行列分解のSGD更新を u と v に同時に行う関数（どちらも更新前の値を使う）
+template <class T>
+void sgd_update_kernel(double lr, double err, double reg, const BasicVectorView<T>& u, const BasicVectorView<T>& v) {
+    if (u.size() != v.size()) {
+        std::cerr << "sgd_update(double, double, double, const VectorView &, const VectorView &): Size Unmatched" << std::endl;
+        exit(1);
+    }
+    double alpha = 1.0 - lr * reg;
+    double beta = lr * err;
+    if (u.contiguous() && v.contiguous()) {
+        simd_coupled_axpby(alpha, beta, u.data(), v.data(), u.size());
+        return;
+    }
+    int size = u.size();
+    for (int i = 0; i < size; i++) {
+        double u_i = u[i];
+        double v_i = v[i];
+        u[i] = alpha * u_i + beta * v_i;
+        v[i] = alpha * v_i + beta * u_i;
+    }
 }
+
+}  // namespace
+
+// 内積を計算する関数
+double dot(const VectorView& lhs, const VectorView& rhs) { return dot_kernel(lhs, rhs); }
+double dot(const FloatVectorView& lhs, const FloatVectorView& rhs) { return dot_kernel(lhs, rhs); }
+
+// 平方和を計算する関数
+double squared_sum(const VectorView& arg) { return squared_sum_kernel(arg); }
+double squared_sum(const FloatVectorView& arg) { return squared_sum_kernel(arg); }
+
+// pノルムを計算する関数
+double norm(const VectorView& arg, int p) { return norm_kernel(arg, p); }
+double norm(const FloatVectorView& arg, int p) { return norm_kernel(arg, p); }
+
+// 最大ノルムを計算する関数
+double max_norm(const VectorView& arg) { return max_norm_kernel(arg); }
+double max_norm(const FloatVectorView& arg) { return max_norm_kernel(arg); }
+
+// 平方ノルムを計算する関数
+double squared_norm(const VectorView& arg) { return squared_norm_kernel(arg); }
+double squared_norm(const FloatVectorView& arg) { return squared_norm_kernel(arg); }
+
+// y += alpha * x
+void axpy(double alpha, const VectorView& x, const VectorView& y) { axpy_kernel(alpha, x, y); }
+void axpy(double alpha, const FloatVectorView& x, const FloatVectorView& y) { axpy_kernel(alpha, x, y); }
+
+// y = alpha * x + beta * y
+void axpby(double alpha, const VectorView& x, double beta, const VectorView& y) { axpby_kernel(alpha, x, beta, y); }
+void axpby(double alpha, const FloatVectorView& x, double beta, const FloatVectorView& y) { axpby_kernel(alpha, x, beta, y); }
+
+// x *= alpha
+void scal(double alpha, const VectorView& x) { scal_kernel(alpha, x); }
+void scal(double alpha, const FloatVectorView& x) { scal_kernel(alpha, x); }
+
+// z += alpha * x * y（要素ごとの積）
+void fmadd(double alpha, const VectorView& x, const VectorView& y, const VectorView& z) { fmadd_kernel(alpha, x, y, z); }
+void fmadd(double alpha, const FloatVectorView& x, const FloatVectorView& y, const FloatVectorView& z) { fmadd_kernel(alpha, x, y, z); }
+
+// 内積と両方の平方和を同時に計算する関数
+void dot_and_norms(const VectorView& x, const VectorView& y, double& xy, double& xx, double& yy) { dot_and_norms_kernel(x, y, xy, xx, yy); }
+void dot_and_norms(const FloatVectorView& x, const FloatVectorView& y, double& xy, double& xx, double& yy) { dot_and_norms_kernel(x, y, xy, xx, yy); }
+
+// 行列分解のSGD更新を u と v に同時に行う関数
+void sgd_update(double lr, double err, double reg, const VectorView& u, const VectorView& v) { sgd_update_kernel(lr, err, reg, u, v); }
+void sgd_update(double lr, double err, double reg, const FloatVectorView& u, const FloatVectorView& v) { sgd_update_kernel(lr, err, reg, u, v); }
+
+// 倍精度と単精度で実体化する
+template class BasicVector<double>;
+template class BasicVector<float>;
+template std::ostream& operator<<(std::ostream&, const BasicVector<double>&);
+template std::ostream& operator<<(std::ostream&, const BasicVector<float>&);
+template BasicVector<double> operator+(BasicVector<double>&&, BasicVector<double>&&);
+template BasicVector<float> operator+(BasicVector<float>&&, BasicVector<float>&&);
+template BasicVector<double> operator-(BasicVector<double>&&, BasicVector<double>&&);
+template BasicVector<float> operator-(BasicVector<float>&&, BasicVector<float>&&);
+template BasicVector<double> operator*(double, BasicVector<double>&&);
+template BasicVector<float> operator*(double, BasicVector<float>&&);
+template BasicVector<double> operator/(BasicVector<double>&&, double);
+template BasicVector<float> operator/(BasicVector<float>&&, double);
+template BasicVector<double> operator-(BasicVector<double>&&);
+template BasicVector<float> operator-(BasicVector<float>&&);
+template bool operator==(const BasicVector<double>&, const BasicVector<double>&);
+template bool operator==(const BasicVector<float>&, const BasicVector<float>&);
+template bool operator!=(const BasicVector<double>&, const BasicVector<double>&);
+template bool operator!=(const BasicVector<float>&, const BasicVector<float>&);
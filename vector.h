@@ -3,49 +3,266 @@
 #include <cstring>   // 文字列関数の標準ライブラリ
 #include <iostream>  // 入出力ストリームの標準ライブラリ
 #include <new>       // メモリ割り当ての標準ライブラリ
+#include <type_traits> // 型特性の標準ライブラリ
+#include <utility>   // ムーブの標準ライブラリ
+
+#include "simd.h"
+#include "vector_expression.h"
+#include "vector_view.h"
 
 #ifndef __VECTOR__
 #define __VECTOR__
 
-class Vector {
+// norm(arg, p) で最大ノルムを指定する値
+const int kInfinityNorm = 0x7fffffff;
+
+// 要素の型 T（float または double）を指定するベクトル
+// float の場合も内積やノルムなどの累積は倍精度で計算する
+template <class T>
+class BasicVector : public VectorExpression<BasicVector<T> > {
    private:
-    double* values_;       // ベクトルの値を保持するポインタ
+    T* values_;            // ベクトルの値を保持するポインタ（64バイト境界に揃えて確保する）
     int size_;             // ベクトルのサイズを保持する整数
     bool part_of_matrix_;  // ベクトルが行列の一部であるかを示すブール値
 
    public:
-    Vector(void);                               // デフォルトコンストラクタ
-    explicit Vector(int n);                     // サイズを指定するコンストラクタ
-    Vector(double* values, int size);           // 値とサイズを指定するコンストラクタ
-    Vector(int n, double value, const char* flag); // サイズ、値、およびフラグを指定するコンストラクタ
-    Vector(const Vector& arg);                  // コピーコンストラクタ
-    Vector& operator=(const Vector& rhs);       // 代入演算子
-    ~Vector(void);                              // デストラクタ
+    BasicVector(void);                          // デフォルトコンストラクタ
+    explicit BasicVector(int n);                // サイズを指定するコンストラクタ
+    BasicVector(T* values, int size);           // 値とサイズを指定するコンストラクタ
+    BasicVector(int n, double value, const char* flag); // サイズ、値、およびフラグを指定するコンストラクタ
+    BasicVector(const BasicVector& arg);        // コピーコンストラクタ
+    BasicVector(BasicVector&& arg);             // ムーブコンストラクタ
+    explicit BasicVector(const BasicVectorView<T>& arg); // ビューの要素をコピーするコンストラクタ（暗黙にはコピーしない）
+    template <class E, class = typename std::enable_if<!ExplicitVectorCopy<E>::value>::type>
+    BasicVector(const VectorExpression<E>& expr); // 式を評価して構築するコンストラクタ
+    BasicVector& operator=(const BasicVector& rhs); // 代入演算子
+    BasicVector& operator=(BasicVector&& rhs);  // ムーブ代入演算子
+    template <class E>
+    BasicVector& operator=(const VectorExpression<E>& rhs); // 式を評価して代入する演算子
+    ~BasicVector(void);                         // デストラクタ
 
     int size(void) const;                       // サイズを取得するメソッド
-    double operator[](int index) const;         // インデックスで要素にアクセスするためのconstメソッド
-    double& operator[](int index);              // インデックスで要素にアクセスするための非constメソッド
+    T operator[](int index) const;              // インデックスで要素にアクセスするためのconstメソッド
+    T& operator[](int index);                   // インデックスで要素にアクセスするための非constメソッド
+    double eval(int index) const { return values_[index]; } // 式テンプレートから要素を読み出すメソッド
     std::ostream& print(std::ostream& lhs) const; // ベクトルを出力するメソッド
-    Vector& operator+=(const Vector& rhs);      // 加算代入演算子
-    Vector& operator-=(const Vector& rhs);      // 減算代入演算子
-    Vector operator+(void) const;               // 単項プラス演算子
-    Vector operator-(void) const;               // 単項マイナス演算子
-    double* get_values();                       // データへのポインタを取得するメソッド
+    BasicVector& operator+=(const BasicVector& rhs); // 加算代入演算子
+    BasicVector& operator-=(const BasicVector& rhs); // 減算代入演算子
+    template <class E>
+    BasicVector& operator+=(const VectorExpression<E>& rhs); // 式の加算代入演算子
+    template <class E>
+    BasicVector& operator-=(const VectorExpression<E>& rhs); // 式の減算代入演算子
+    T* get_values();                            // データへのポインタを取得するメソッド
+    const T* get_values() const;                // データへのポインタを取得するメソッド（const版）
+    bool part_of_matrix(void) const;            // 行列の行を参照しているかを返すメソッド
 };
 
+typedef BasicVector<double> Vector;
+typedef BasicVector<float> FloatVector;
+
 // 非メンバー関数の宣言
-std::ostream& operator<<(std::ostream& lhs, const Vector& rhs); // ベクトルの出力演算子
-Vector operator+(const Vector& lhs, const Vector& rhs); // ベクトルの加算演算子
-Vector operator-(const Vector& lhs, const Vector& rhs); // ベクトルの減算演算子
-double operator*(const Vector& lhs, const Vector& rhs); // ベクトルの内積演算子
-Vector operator*(double lhs, const Vector& rhs);        // ベクトルとスカラーの乗算演算子
-Vector operator/(const Vector& lhs, double rhs);        // ベクトルとスカラーの除算演算子
-bool operator==(const Vector& lhs, const Vector& rhs);  // ベクトルの等価比較演算子
-bool operator!=(const Vector& lhs, const Vector& rhs);  // ベクトルの不等価比較演算子
-double squared_sum(const Vector& arg);                  // ベクトルの平方和を計算する関数
-double norm(const Vector& arg, int p);                  // ベクトルのpノルムを計算する関数
-double max_norm(const Vector& arg);                     // ベクトルの最大ノルムを計算する関数
-double squared_norm(const Vector& arg);                 // ベクトルの平方ノルムを計算する関数
+// 加算、減算、スカラー倍、スカラー除算、内積の演算子は vector_expression.h の式テンプレートで定義する
+template <class T>
+std::ostream& operator<<(std::ostream& lhs, const BasicVector<T>& rhs); // ベクトルの出力演算子
+template <class T>
+BasicVector<T> operator+(BasicVector<T>&& lhs, BasicVector<T>&& rhs); // ベクトルの加算演算子（右辺値同士）
+template <class T>
+BasicVector<T> operator-(BasicVector<T>&& lhs, BasicVector<T>&& rhs); // ベクトルの減算演算子（右辺値同士）
+template <class T>
+BasicVector<T> operator*(double lhs, BasicVector<T>&& rhs); // ベクトルとスカラーの乗算演算子（右辺値）
+template <class T>
+BasicVector<T> operator/(BasicVector<T>&& lhs, double rhs); // ベクトルとスカラーの除算演算子（右辺値）
+template <class T>
+BasicVector<T> operator-(BasicVector<T>&& arg);      // 単項マイナス演算子（右辺値）
+template <class T>
+bool operator==(const BasicVector<T>& lhs, const BasicVector<T>& rhs); // ベクトルの等価比較演算子
+template <class T>
+bool operator!=(const BasicVector<T>& lhs, const BasicVector<T>& rhs); // ベクトルの不等価比較演算子
+
+// ベクトルのカーネルはビューを受け取る（Vector、Matrix の行、固定長ベクトルはビューに暗黙に変換される）
+// 連続したビュー同士はSIMDカーネルで、それ以外は間隔を考慮して計算する
+// ビューへの変換を使うため、double 版と float 版をそれぞれ非テンプレートの関数として宣言する
+double dot(const VectorView& lhs, const VectorView& rhs);       // ベクトルの内積を計算する関数
+double dot(const FloatVectorView& lhs, const FloatVectorView& rhs);
+double squared_sum(const VectorView& arg);                      // ベクトルの平方和を計算する関数
+double squared_sum(const FloatVectorView& arg);
+double norm(const VectorView& arg, int p);                      // ベクトルのpノルムを計算する関数（p = kInfinityNorm で最大ノルム）
+double norm(const FloatVectorView& arg, int p);
+double max_norm(const VectorView& arg);                         // ベクトルの最大ノルムを計算する関数
+double max_norm(const FloatVectorView& arg);
+double squared_norm(const VectorView& arg);                     // ベクトルの平方ノルムを計算する関数
+double squared_norm(const FloatVectorView& arg);
+
+// BLASスタイルの融合演算（結果を書き込むベクトル以外は読み出すだけで、各要素を1回だけ走査する）
+// 書き込み先もビューで受け取るので、Matrix::operator[] や Matrix::row が返す行を直接更新できる
+void axpy(double alpha, const VectorView& x, const VectorView& y);              // y += alpha * x
+void axpy(double alpha, const FloatVectorView& x, const FloatVectorView& y);
+void axpby(double alpha, const VectorView& x, double beta, const VectorView& y); // y = alpha * x + beta * y
+void axpby(double alpha, const FloatVectorView& x, double beta, const FloatVectorView& y);
+void scal(double alpha, const VectorView& x);                                   // x *= alpha
+void scal(double alpha, const FloatVectorView& x);
+void fmadd(double alpha, const VectorView& x, const VectorView& y, const VectorView& z); // z += alpha * x * y（要素ごとの積）
+void fmadd(double alpha, const FloatVectorView& x, const FloatVectorView& y, const FloatVectorView& z);
+void dot_and_norms(const VectorView& x, const VectorView& y, double& xy, double& xx, double& yy); // 内積と両方の平方和を同時に計算する関数
+void dot_and_norms(const FloatVectorView& x, const FloatVectorView& y, double& xy, double& xx, double& yy);
+void sgd_update(double lr, double err, double reg, const VectorView& u, const VectorView& v); // 行列分解のSGD更新 u += lr * (err * v - reg * u), v += lr * (err * u - reg * v) を同時に行う関数
+void sgd_update(double lr, double err, double reg, const FloatVectorView& u, const FloatVectorView& v);
+
+// 評価が必要な式のノード（Vector、ビュー、固定長ベクトル以外）かどうか
+template <class E>
+struct IsVectorNode {
+    static const bool value = !ExplicitVectorCopy<E>::value;
+};
+template <class T>
+struct IsVectorNode<BasicVector<T> > {
+    static const bool value = false;
+};
+
+// 式を受け取る版（倍精度の Vector に評価してから計算する）
+template <class E, class = typename std::enable_if<IsVectorNode<E>::value>::type>
+double squared_sum(const VectorExpression<E>& arg) {
+    return squared_sum(Vector(arg));
+}
+template <class E, class = typename std::enable_if<IsVectorNode<E>::value>::type>
+double norm(const VectorExpression<E>& arg, int p) {
+    return norm(Vector(arg), p);
+}
+template <class E, class = typename std::enable_if<IsVectorNode<E>::value>::type>
+double max_norm(const VectorExpression<E>& arg) {
+    return max_norm(Vector(arg));
+}
+template <class E, class = typename std::enable_if<IsVectorNode<E>::value>::type>
+double squared_norm(const VectorExpression<E>& arg) {
+    return squared_norm(Vector(arg));
+}
+
+// Vector同士、ビュー同士の内積は dot を使う
+template <class T>
+double expression_dot(const BasicVector<T>& lhs, const BasicVector<T>& rhs) {
+    return dot(lhs, rhs);
+}
+template <class T>
+double expression_dot(const BasicVectorView<T>& lhs, const BasicVectorView<T>& rhs) {
+    return dot(lhs, rhs);
+}
+
+// 右辺値のベクトルの領域を結果に使えるならムーブし、行列の行を参照している場合（Matrix::operator[] の戻り値）は値をコピーする
+template <class T>
+BasicVector<T> reusable(BasicVector<T>&& arg) {
+    if (arg.part_of_matrix()) return BasicVector<T>(static_cast<const BasicVector<T>&>(arg));
+    return std::move(arg);
+}
+
+// 右辺値のベクトルとの演算は、その領域を再利用して結果を書き込む（行列の行は書き換えない）
+// ベクトルの加算演算子（左辺が右辺値）
+template <class T, class R>
+BasicVector<T> operator+(BasicVector<T>&& lhs, const VectorExpression<R>& rhs) {
+    BasicVector<T> result = reusable(std::move(lhs));
+    result += rhs;
+    return result;
+}
+
+// ベクトルの加算演算子（右辺が右辺値）
+template <class L, class T>
+BasicVector<T> operator+(const VectorExpression<L>& lhs, BasicVector<T>&& rhs) {
+    BasicVector<T> result = reusable(std::move(rhs));
+    result += lhs;
+    return result;
+}
+
+// ベクトルの減算演算子（左辺が右辺値）
+template <class T, class R>
+BasicVector<T> operator-(BasicVector<T>&& lhs, const VectorExpression<R>& rhs) {
+    BasicVector<T> result = reusable(std::move(lhs));
+    result -= rhs;
+    return result;
+}
+
+// ベクトルの減算演算子（右辺が右辺値）
+template <class L, class T>
+BasicVector<T> operator-(const VectorExpression<L>& lhs, BasicVector<T>&& rhs) {
+    if (lhs.size() != rhs.size()) {
+        std::cerr << "operator-(const Vector &, Vector &&): Size Unmatched" << std::endl;
+        exit(1);
+    }
+    const L& arg = lhs.self();
+    BasicVector<T> result = reusable(std::move(rhs));
+    int size = result.size();
+    for (int i = 0; i < size; i++) {
+        result[i] = arg.eval(i) - result[i];
+    }
+    return result;
+}
+
+// 式を評価して構築するコンストラクタ
+template <class T>
+template <class E, class>
+BasicVector<T>::BasicVector(const VectorExpression<E>& expr) try : values_(simd_alloc<T>(expr.size())), size_(expr.size()), part_of_matrix_(false) {
+    const E& arg = expr.self();
+    int size = size_;
+    for (int i = 0; i < size; i++) {
+        values_[i] = arg.eval(i);
+    }
+} catch (std::bad_alloc) {
+    std::cerr << "Vector::Vector(const VectorExpression<E>& expr) : Out of Memory" << std::endl;
+    throw;
+}
+
+// 式を評価して代入する演算子
+template <class T>
+template <class E>
+BasicVector<T>& BasicVector<T>::operator=(const VectorExpression<E>& rhs) {
+    const E& arg = rhs.self();
+    int rhs_size = arg.size();
+    if (size_ != rhs_size) {
+        size_ = rhs_size;
+        simd_free(values_);
+        try {
+            values_ = simd_alloc<T>(size_);
+        } catch (std::bad_alloc) {
+            std::cerr << "Vector::operator=: Out of Memory" << std::endl;
+            throw;
+        }
+    }
+    // 要素ごとの演算なので、右辺が自分自身を参照していても1回のループで評価できる
+    int size = size_;
+    for (int i = 0; i < size; i++) {
+        values_[i] = arg.eval(i);
+    }
+    return *this;
+}
+
+// 式の加算代入演算子
+template <class T>
+template <class E>
+BasicVector<T>& BasicVector<T>::operator+=(const VectorExpression<E>& rhs) {
+    const E& arg = rhs.self();
+    if (size_ != arg.size()) {
+        std::cerr << "Vector::operator+=: Size Unmatched" << std::endl;
+        exit(1);
+    }
+    int size = size_;
+    for (int i = 0; i < size; i++) {
+        values_[i] += arg.eval(i);
+    }
+    return *this;
+}
+
+// 式の減算代入演算子
+template <class T>
+template <class E>
+BasicVector<T>& BasicVector<T>::operator-=(const VectorExpression<E>& rhs) {
+    const E& arg = rhs.self();
+    if (size_ != arg.size()) {
+        std::cerr << "Vector::operator-=: Size Unmatched!" << std::endl;
+        exit(1);
+    }
+    int size = size_;
+    for (int i = 0; i < size; i++) {
+        values_[i] -= arg.eval(i);
+    }
+    return *this;
+}
 
 
 #endif
\ No newline at end of file
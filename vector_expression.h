@@ -0,0 +1,154 @@
+#include <cstdlib>   // 一般的な目的の関数の標準ライブラリ
+#include <iostream>  // 入出力ストリームの標準ライブラリ
+
+#ifndef __VECTOR_EXPRESSION__
+#define __VECTOR_EXPRESSION__
+
+template <class T>
+class BasicVector;
+
+// 要素ごとの演算
+struct AddOp {
+    static double apply(double lhs, double rhs) { return lhs + rhs; }
+};
+struct SubtractOp {
+    static double apply(double lhs, double rhs) { return lhs - rhs; }
+};
+struct ScaleOp {  // スカラー倍（scalar * element）
+    static double apply(double element, double scalar) { return scalar * element; }
+};
+struct DivideOp {  // スカラー除算（element / scalar）
+    static double apply(double element, double scalar) { return element / scalar; }
+};
+
+// ベクトルの式テンプレートの基底クラス（CRTP）
+// 式は代入されるまで評価されず、代入時に1回のループで全体を計算する
+// 要素の型に関わらず、式の中の計算は倍精度で行う
+template <class E>
+class VectorExpression {
+   public:
+    const E& self(void) const { return static_cast<const E&>(*this); }
+    int size(void) const { return self().size(); }
+    double eval(int index) const { return self().eval(index); }
+};
+
+// Vector への変換（要素のコピー）を明示的に書かせる式（ビューや固定長ベクトル）
+template <class E>
+struct ExplicitVectorCopy {
+    static const bool value = false;
+};
+
+// 式のオペランドの保持方法（Vectorは参照で、式は値で保持する）
+template <class E>
+struct VectorOperand {
+    typedef const E type;
+};
+template <class T>
+struct VectorOperand<BasicVector<T> > {
+    typedef const BasicVector<T>& type;
+};
+
+// 二項演算の式
+template <class L, class R, class Op>
+class VectorBinary : public VectorExpression<VectorBinary<L, R, Op> > {
+   private:
+    typename VectorOperand<L>::type lhs_;  // 左辺
+    typename VectorOperand<R>::type rhs_;  // 右辺
+
+   public:
+    VectorBinary(const L& lhs, const R& rhs) : lhs_(lhs), rhs_(rhs) {}
+    int size(void) const { return lhs_.size(); }
+    double eval(int index) const { return Op::apply(lhs_.eval(index), rhs_.eval(index)); }
+};
+
+// スカラーとの演算の式
+template <class E, class Op>
+class VectorScalar : public VectorExpression<VectorScalar<E, Op> > {
+   private:
+    typename VectorOperand<E>::type arg_;  // ベクトル側の式
+    double scalar_;                        // スカラー
+
+   public:
+    VectorScalar(const E& arg, double scalar) : arg_(arg), scalar_(scalar) {}
+    int size(void) const { return arg_.size(); }
+    double eval(int index) const { return Op::apply(arg_.eval(index), scalar_); }
+};
+
+// 符号反転の式
+template <class E>
+class VectorNegate : public VectorExpression<VectorNegate<E> > {
+   private:
+    typename VectorOperand<E>::type arg_;  // 反転する式
+
+   public:
+    explicit VectorNegate(const E& arg) : arg_(arg) {}
+    int size(void) const { return arg_.size(); }
+    double eval(int index) const { return -arg_.eval(index); }
+};
+
+// ベクトルの加算演算子
+template <class L, class R>
+VectorBinary<L, R, AddOp> operator+(const VectorExpression<L>& lhs, const VectorExpression<R>& rhs) {
+    if (lhs.size() != rhs.size()) {
+        std::cerr << "operator+(const Vector &, const Vector &): Size Unmatched" << std::endl;
+        exit(1);
+    }
+    return VectorBinary<L, R, AddOp>(lhs.self(), rhs.self());
+}
+
+// ベクトルの減算演算子
+template <class L, class R>
+VectorBinary<L, R, SubtractOp> operator-(const VectorExpression<L>& lhs, const VectorExpression<R>& rhs) {
+    if (lhs.size() != rhs.size()) {
+        std::cerr << "operator-(const Vector &, const Vector &): Size Unmatched" << std::endl;
+        exit(1);
+    }
+    return VectorBinary<L, R, SubtractOp>(lhs.self(), rhs.self());
+}
+
+// ベクトルとスカラーの乗算演算子
+template <class E>
+VectorScalar<E, ScaleOp> operator*(double lhs, const VectorExpression<E>& rhs) {
+    return VectorScalar<E, ScaleOp>(rhs.self(), lhs);
+}
+
+// ベクトルとスカラーの除算演算子
+template <class E>
+VectorScalar<E, DivideOp> operator/(const VectorExpression<E>& lhs, double rhs) {
+    return VectorScalar<E, DivideOp>(lhs.self(), rhs);
+}
+
+// 単項プラス演算子
+template <class E>
+const E& operator+(const VectorExpression<E>& arg) {
+    return arg.self();
+}
+
+// 単項マイナス演算子
+template <class E>
+VectorNegate<E> operator-(const VectorExpression<E>& arg) {
+    return VectorNegate<E>(arg.self());
+}
+
+// 式同士の内積（Vector同士の場合は vector.h の dot を使う）
+template <class L, class R>
+double expression_dot(const L& lhs, const R& rhs) {
+    double result = 0.0;
+    int size = lhs.size();
+    for (int i = 0; i < size; i++) {
+        result += lhs.eval(i) * rhs.eval(i);
+    }
+    return result;
+}
+
+// ベクトルの内積演算子
+template <class L, class R>
+double operator*(const VectorExpression<L>& lhs, const VectorExpression<R>& rhs) {
+    if (lhs.size() != rhs.size()) {
+        std::cerr << "operator*(const Vector &, const Vector &): Size Unmatched" << std::endl;
+        exit(1);
+    }
+    return expression_dot(lhs.self(), rhs.self());
+}
+
+#endif
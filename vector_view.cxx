@@ -0,0 +1,55 @@
+#include "vector_view.h"
+
+#include "vector.h"
+
+// 先頭のポインタ、要素数、間隔を指定するコンストラクタ
+template <class T>
+BasicVectorView<T>::BasicVectorView(T* values, int size, int stride) : values_(values), size_(size), stride_(stride) {}
+
+// ベクトル全体を指すコンストラクタ
+template <class T>
+BasicVectorView<T>::BasicVectorView(const BasicVector<T>& arg) : values_(const_cast<T*>(arg.get_values())), size_(arg.size()), stride_(1) {}
+
+// 参照先に要素をコピーする代入演算子
+template <class T>
+BasicVectorView<T>& BasicVectorView<T>::operator=(const BasicVectorView& rhs) {
+    if (size_ != rhs.size_) {
+        std::cerr << "VectorView::operator=: Size Unmatched" << std::endl;
+        exit(1);
+    }
+    int size = size_;
+    for (int i = 0; i < size; i++) {
+        values_[i * stride_] = rhs.values_[i * rhs.stride_];
+    }
+    return *this;
+}
+
+// 要素数を取得するメソッド
+template <class T>
+int BasicVectorView<T>::size(void) const { return size_; }
+
+// 要素の間隔を取得するメソッド
+template <class T>
+int BasicVectorView<T>::stride(void) const { return stride_; }
+
+// 要素が連続して並んでいるかを返すメソッド
+template <class T>
+bool BasicVectorView<T>::contiguous(void) const { return stride_ == 1 || size_ <= 1; }
+
+// 先頭の要素へのポインタを取得するメソッド
+template <class T>
+T* BasicVectorView<T>::data(void) const { return values_; }
+
+// [begin, end) の要素を指すビューを返すメソッド
+template <class T>
+BasicVectorView<T> BasicVectorView<T>::range(int begin, int end) const {
+    if (begin < 0 || end > size_ || begin > end) {
+        std::cerr << "VectorView::range(int, int): Index out of range" << std::endl;
+        exit(1);
+    }
+    return BasicVectorView(values_ + begin * stride_, end - begin, stride_);
+}
+
+// 倍精度と単精度で実体化する
+template class BasicVectorView<double>;
+template class BasicVectorView<float>;
@@ -0,0 +1,98 @@
+#include <cstdlib>   // 一般的な目的の関数の標準ライブラリ
+#include <iostream>  // 入出力ストリームの標準ライブラリ
+
+#include "vector_expression.h"
+
+#ifndef __VECTOR_VIEW__
+#define __VECTOR_VIEW__
+
+// 値を所有しないストライド付きのベクトル（行列の行・列や、ベクトルの一部を指す）
+// コピーしてもビューが複製されるだけで、代入演算子は参照先の要素に値を書き込む
+// const な Vector から作ったビューは読み出し専用として使う
+template <class T>
+class BasicVectorView : public VectorExpression<BasicVectorView<T> > {
+   private:
+    T* values_;       // 先頭の要素へのポインタ
+    int size_;        // 要素数
+    int stride_;      // 隣り合う要素の間隔
+
+   public:
+    BasicVectorView(T* values, int size, int stride = 1);  // 先頭のポインタ、要素数、間隔を指定するコンストラクタ
+    BasicVectorView(const BasicVector<T>& arg);            // ベクトル全体を指すコンストラクタ
+    BasicVectorView(const BasicVectorView& arg) = default; // ビューを複製するコピーコンストラクタ
+    BasicVectorView& operator=(const BasicVectorView& rhs); // 参照先に要素をコピーする代入演算子
+    template <class E>
+    BasicVectorView& operator=(const VectorExpression<E>& rhs); // 式を評価して参照先に書き込む演算子
+    template <class E>
+    BasicVectorView& operator+=(const VectorExpression<E>& rhs); // 式の加算代入演算子
+    template <class E>
+    BasicVectorView& operator-=(const VectorExpression<E>& rhs); // 式の減算代入演算子
+
+    int size(void) const;                       // 要素数を取得するメソッド
+    int stride(void) const;                     // 要素の間隔を取得するメソッド
+    bool contiguous(void) const;                // 要素が連続して並んでいるかを返すメソッド
+    T* data(void) const;                        // 先頭の要素へのポインタを取得するメソッド
+    T& operator[](int index) const { return values_[index * stride_]; }  // インデックスで要素にアクセスするメソッド
+    double eval(int index) const { return values_[index * stride_]; }   // 式テンプレートから要素を読み出すメソッド
+    BasicVectorView range(int begin, int end) const; // [begin, end) の要素を指すビューを返すメソッド
+};
+
+typedef BasicVectorView<double> VectorView;
+typedef BasicVectorView<float> FloatVectorView;
+
+// Vector への変換は明示的に書かせる
+template <class T>
+struct ExplicitVectorCopy<BasicVectorView<T> > {
+    static const bool value = true;
+};
+
+// 式を評価して参照先に書き込む演算子
+// 右辺が参照先と重なる場合、要素ごとの演算でなければ結果は保証されない
+template <class T>
+template <class E>
+BasicVectorView<T>& BasicVectorView<T>::operator=(const VectorExpression<E>& rhs) {
+    const E& arg = rhs.self();
+    if (size_ != arg.size()) {
+        std::cerr << "VectorView::operator=: Size Unmatched" << std::endl;
+        exit(1);
+    }
+    int size = size_;
+    for (int i = 0; i < size; i++) {
+        values_[i * stride_] = arg.eval(i);
+    }
+    return *this;
+}
+
+// 式の加算代入演算子
+template <class T>
+template <class E>
+BasicVectorView<T>& BasicVectorView<T>::operator+=(const VectorExpression<E>& rhs) {
+    const E& arg = rhs.self();
+    if (size_ != arg.size()) {
+        std::cerr << "VectorView::operator+=: Size Unmatched" << std::endl;
+        exit(1);
+    }
+    int size = size_;
+    for (int i = 0; i < size; i++) {
+        values_[i * stride_] += arg.eval(i);
+    }
+    return *this;
+}
+
+// 式の減算代入演算子
+template <class T>
+template <class E>
+BasicVectorView<T>& BasicVectorView<T>::operator-=(const VectorExpression<E>& rhs) {
+    const E& arg = rhs.self();
+    if (size_ != arg.size()) {
+        std::cerr << "VectorView::operator-=: Size Unmatched" << std::endl;
+        exit(1);
+    }
+    int size = size_;
+    for (int i = 0; i < size; i++) {
+        values_[i * stride_] -= arg.eval(i);
+    }
+    return *this;
+}
+
+#endif